@@ -0,0 +1,104 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STAdvancePartyCache.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STConnection.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Advance Party Cache
+ *  ~~~~~~~~~~~~~~~~~~~
+ *
+ *  Keeps received packages of connections which have no docker yet,
+ *  until the gate decides which docker to create.
+ *
+ *      1. each connection keeps at most 'maxPackets' packages in a ring,
+ *         the oldest package will be overwritten;
+ *      2. all connections share 'maxBytes', the oldest connection will be
+ *         evicted when exceeded;
+ *      3. at most 'maxParties' connections are cached, the oldest connection
+ *         will be evicted for a new one, so tiny packages from many remote
+ *         addresses cannot grow the cache without bound;
+ *      4. parties older than 'expires' seconds will be evicted.
+ *
+ *  Packages are kept as references, nothing will be copied.
+ */
+@interface STAdvancePartyCache : NSObject
+
+@property(nonatomic, readonly) NSUInteger maxPackets;      // per connection
+@property(nonatomic, readonly) NSUInteger maxBytes;        // all connections
+@property(nonatomic, readonly) NSUInteger maxParties;      // connections
+@property(nonatomic, readonly) NSTimeInterval expires;     // seconds
+
+@property(nonatomic, readonly) NSUInteger count;           // connections cached
+@property(nonatomic, readonly) NSUInteger length;          // bytes cached
+
+- (instancetype)initWithMaxPackets:(NSUInteger)packets
+                          maxBytes:(NSUInteger)bytes
+                        maxParties:(NSUInteger)count
+                           expires:(NSTimeInterval)seconds
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Append received data to the party of this connection
+ *
+ * @param data - received data
+ * @param conn - current connection
+ * @param now  - current time
+ * @return all cached packages of this connection (including the data)
+ */
+- (NSArray<NSData *> *)cacheData:(NSData *)data
+                   forConnection:(id<STConnection>)conn
+                            time:(NSTimeInterval)now;
+
+/**
+ *  Remove the party of this connection
+ *
+ * @param conn - current connection
+ */
+- (void)clearForConnection:(id<STConnection>)conn;
+
+/**
+ *  Evict expired parties
+ *
+ * @param now - current time
+ * @return number of parties evicted
+ */
+- (NSUInteger)purgeWithTime:(NSTimeInterval)now;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,251 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STAdvancePartyCache.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <ObjectKey/ObjectKey.h>
+
+#import "STAddressPairMap.h"
+
+#import "STAdvancePartyCache.h"
+
+static const NSUInteger ADVANCE_PARTY_MAX_PACKETS = 8;
+static const NSUInteger ADVANCE_PARTY_MAX_BYTES = 1024 * 1024;
+static const NSUInteger ADVANCE_PARTY_MAX_PARTIES = 4096;
+static const NSTimeInterval ADVANCE_PARTY_EXPIRES = 16;
+
+/**
+ *  Packages of one connection in a fixed-size ring
+ */
+@interface __AdvanceParty : NSObject {
+
+    NSMutableArray<NSData *> *_slots;
+    NSUInteger _head;  // oldest package
+    NSUInteger _count;
+}
+
+@property(nonatomic, strong) id<NIOSocketAddress> remoteAddress;
+@property(nonatomic, strong, nullable) id<NIOSocketAddress> localAddress;
+
+@property(nonatomic, assign) NSTimeInterval time;  // first arrived
+@property(nonatomic, assign) NSUInteger length;    // bytes
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+@end
+
+@implementation __AdvanceParty
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity {
+    if (self = [super init]) {
+        _slots = [[NSMutableArray alloc] initWithCapacity:capacity];
+        for (NSUInteger index = 0; index < capacity; ++index) {
+            [_slots addObject:[NSData data]];
+        }
+        _head = 0;
+        _count = 0;
+        _length = 0;
+    }
+    return self;
+}
+
+// return bytes released by the overwritten package
+- (NSUInteger)pushData:(NSData *)data {
+    NSUInteger capacity = [_slots count];
+    NSUInteger released = 0;
+    if (_count < capacity) {
+        [_slots replaceObjectAtIndex:((_head + _count) % capacity) withObject:data];
+        ++_count;
+    } else {
+        // full, overwrite the oldest one
+        released = [[_slots objectAtIndex:_head] length];
+        [_slots replaceObjectAtIndex:_head withObject:data];
+        _head = (_head + 1) % capacity;
+    }
+    _length = _length + [data length] - released;
+    return released;
+}
+
+// return bytes released by the removed package
+- (NSUInteger)popData {
+    if (_count == 0) {
+        return 0;
+    }
+    NSUInteger released = [[_slots objectAtIndex:_head] length];
+    [_slots replaceObjectAtIndex:_head withObject:[NSData data]];
+    _head = (_head + 1) % [_slots count];
+    --_count;
+    _length -= released;
+    return released;
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (NSArray<NSData *> *)packages {
+    NSUInteger capacity = [_slots count];
+    NSMutableArray<NSData *> *array = [[NSMutableArray alloc] initWithCapacity:_count];
+    for (NSUInteger index = 0; index < _count; ++index) {
+        [array addObject:[_slots objectAtIndex:((_head + index) % capacity)]];
+    }
+    return array;
+}
+
+@end
+
+#pragma mark -
+
+@interface STAdvancePartyCache ()
+
+@property(nonatomic, strong) STAddressPairMap<__AdvanceParty *> *parties;
+
+// parties in arrival order, the first one is the oldest
+@property(nonatomic, strong) NSMutableOrderedSet<__AdvanceParty *> *queue;
+
+@property(nonatomic, assign) NSUInteger length;
+
+@end
+
+@implementation STAdvancePartyCache
+
+- (instancetype)init {
+    return [self initWithMaxPackets:ADVANCE_PARTY_MAX_PACKETS
+                           maxBytes:ADVANCE_PARTY_MAX_BYTES
+                         maxParties:ADVANCE_PARTY_MAX_PARTIES
+                            expires:ADVANCE_PARTY_EXPIRES];
+}
+
+/* designated initializer */
+- (instancetype)initWithMaxPackets:(NSUInteger)packets
+                          maxBytes:(NSUInteger)bytes
+                        maxParties:(NSUInteger)count
+                           expires:(NSTimeInterval)seconds {
+    if (self = [super init]) {
+        _maxPackets = MAX(packets, 1);
+        _maxBytes = bytes;
+        _maxParties = MAX(count, 1);
+        _expires = seconds;
+        self.parties = [STAddressPairMap map];
+        self.queue = [[NSMutableOrderedSet alloc] init];
+        self.length = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    @synchronized (self) {
+        return [_queue count];
+    }
+}
+
+// private
+- (void)removeParty:(__AdvanceParty *)party {
+    [_parties removeObject:party forRemote:party.remoteAddress local:party.localAddress];
+    [_queue removeObject:party];
+    _length -= party.length;
+}
+
+// private
+- (NSUInteger)evictExpired:(NSTimeInterval)now {
+    NSUInteger count = 0;
+    __AdvanceParty *party;
+    while ((party = [_queue firstObject])) {
+        if (party.time + _expires > now) {
+            // the others are newer
+            break;
+        }
+        [self removeParty:party];
+        ++count;
+    }
+    return count;
+}
+
+- (NSArray<NSData *> *)cacheData:(NSData *)data
+                   forConnection:(id<STConnection>)conn
+                            time:(NSTimeInterval)now {
+    NSUInteger size = [data length];
+    if (size > _maxBytes) {
+        // too big to be cached, let the gate check it alone
+        return @[data];
+    }
+    @synchronized (self) {
+        [self evictExpired:now];
+        id<NIOSocketAddress> remote = [conn remoteAddress];
+        id<NIOSocketAddress> local = [conn localAddress];
+        __AdvanceParty *party = [_parties objectForRemote:remote local:local];
+        if (!party) {
+            // evict the oldest parties for the new one
+            while ([_queue count] >= _maxParties) {
+                [self removeParty:[_queue firstObject]];
+            }
+            party = [[__AdvanceParty alloc] initWithCapacity:_maxPackets];
+            party.remoteAddress = remote;
+            party.localAddress = local;
+            party.time = now;
+            [_parties setObject:party forRemote:remote local:local];
+            [_queue addObject:party];
+        }
+        _length -= [party pushData:data];
+        _length += size;
+        // evict the oldest parties when bytes exceeded
+        __AdvanceParty *oldest;
+        while (_length > _maxBytes && (oldest = [_queue firstObject]) != party) {
+            [self removeParty:oldest];
+        }
+        // still exceeded, drop the oldest packages of this party
+        while (_length > _maxBytes && [party count] > 1) {
+            _length -= [party popData];
+        }
+        return [party packages];
+    }
+}
+
+- (void)clearForConnection:(id<STConnection>)conn {
+    @synchronized (self) {
+        __AdvanceParty *party = [_parties objectForRemote:[conn remoteAddress]
+                                                    local:[conn localAddress]];
+        if (party) {
+            [self removeParty:party];
+        }
+    }
+}
+
+- (NSUInteger)purgeWithTime:(NSTimeInterval)now {
+    @synchronized (self) {
+        return [self evictExpired:now];
+    }
+}
+
+@end
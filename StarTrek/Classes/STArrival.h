@@ -35,6 +35,7 @@
 //
 
 #import <StarTrek/STShip.h>
+#import <StarTrek/STPurge.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -61,10 +62,28 @@ NS_DESIGNATED_INITIALIZER;
 - (id<STArrival>)assembleArrival:(id<STArrival>)income;
 
 /**
- *  Clear all expired tasks
+ *  Check received ship for completed package
+ *
+ * @param income - received ship carrying data package (fragment)
+ * @param now    - current time
+ * @return ship carrying completed data package
+ */
+- (id<STArrival>)assembleArrival:(id<STArrival>)income time:(NSTimeInterval)now;
+
+/**
+ *  Clear expired tasks with the default budget
  */
 - (void)purge;
 
+/**
+ *  Clear expired tasks, resume from where last call stopped
+ *
+ * @param now    - current time
+ * @param budget - max entries/time for this call
+ * @return true when nothing due left
+ */
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -46,6 +46,9 @@
  */
 static const NSTimeInterval ARRIVAL_EXPIRES = 300.0;  // seconds
 
+// finished SN will be forgot after 1 hour
+static const NSTimeInterval ARRIVAL_FINISHED_EXPIRES = 3600.0;
+
 @interface STArrival () {
     
     // expired time (seconds from Jan 1, 1970 UTC)
@@ -109,6 +112,11 @@ static const NSTimeInterval ARRIVAL_EXPIRES = 300.0;  // seconds
 // SN => timestamp
 @property(nonatomic, strong) OKHashMap<id<STShipID>, NSNumber *> *arrivalFinished;
 
+// expiry indexes: cached ships in order of caching time (weak),
+//                 finished SNs in order of finished time
+@property(nonatomic, strong) STExpiryQueue<id<STArrival>> *arrivalQueue;
+@property(nonatomic, strong) STExpiryQueue<id<STShipID>> *finishedQueue;
+
 @end
 
 @implementation STArrivalHall
@@ -118,11 +126,17 @@ static const NSTimeInterval ARRIVAL_EXPIRES = 300.0;  // seconds
         self.arrivals        = [OKHashSet set];
         self.arrivalMap      = [OKWeakMap map];
         self.arrivalFinished = [OKHashMap dictionary];
+        self.arrivalQueue    = [[STExpiryQueue alloc] initWithWeakObjects:YES];
+        self.finishedQueue   = [[STExpiryQueue alloc] initWithWeakObjects:NO];
     }
     return self;
 }
 
 - (id<STArrival>)assembleArrival:(id<STArrival>)income {
+    return [self assembleArrival:income time:OKGetCurrentTimeInterval()];
+}
+
+- (id<STArrival>)assembleArrival:(id<STArrival>)income time:(NSTimeInterval)now {
     // 1. check ship ID (SN)
     id<STShipID> sn = [income sn];
     if (!sn) {
@@ -146,7 +160,8 @@ static const NSTimeInterval ARRIVAL_EXPIRES = 300.0;  // seconds
             // it's a fragment, waiting for more fragments
             [_arrivals addObject:income];
             [_arrivalMap setObject:income forKey:sn];
-            //[income touch:OKGetCurrentTimeInterval()];
+            [_arrivalQueue addObject:income time:now];
+            //[income touch:now];
         }
         // else, it's a completed package
     } else {
@@ -158,47 +173,57 @@ static const NSTimeInterval ARRIVAL_EXPIRES = 300.0;  // seconds
             [_arrivals removeObject:cached];
             [_arrivalMap removeObjectForKey:sn];
             // mark finished time
-            [_arrivalFinished setObject:@(OKGetCurrentTimeInterval()) forKey:sn];
+            [_arrivalFinished setObject:@(now) forKey:sn];
+            [_finishedQueue addObject:sn time:now];
         }
     }
     return completed;
 }
 
 - (void)purge {
-    NSTimeInterval now = OKGetCurrentTimeInterval();
-    // 1. seeking expired tasks
-    OKHashSet<id<STArrival>> *expired = [[OKHashSet alloc] init];
-    [_arrivals enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                usingBlock:^(id<STArrival> ship, BOOL *stop) {
-        if ([ship status:now] == STShipStatusExpired) {
-            // task expired
-            [expired addObject:ship];
-            // remove mapping with SN
-            id<STShipID> sn = [ship sn];
-            if (sn) {
-                [_arrivalMap removeObjectForKey:sn];
-                // TODO: callback?
-            }
+    [self purgeWithTime:OKGetCurrentTimeInterval() budget:[STPurgeBudget budget]];
+}
+
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget {
+    // 1. check ships cached long enough
+    id<STArrival> ship;
+    id<STShipID> sn;
+    while ([budget consume]) {
+        if (![_arrivalQueue popObject:&ship time:NULL before:(now - ARRIVAL_EXPIRES)]) {
+            break;
         }
-    }];
-    [expired enumerateObjectsWithOptions:NSEnumerationConcurrent
-                              usingBlock:^(id<STArrival> ship, BOOL *stop) {
+        if (!ship || ![_arrivals containsObject:ship]) {
+            // released or completed
+            continue;
+        } else if ([ship status:now] != STShipStatusExpired) {
+            // touched, check it again later
+            [_arrivalQueue addObject:ship time:now];
+            continue;
+        }
+        // task expired
         [_arrivals removeObject:ship];
-    }];
-    // 2. seeking neglected finished times
-    OKArrayList<id<STShipID>> *neglected = [[OKArrayList alloc] init];
-    NSTimeInterval ago = now - 3600.0;
-    [_arrivalFinished enumerateKeysAndObjectsWithOptions:NSEnumerationConcurrent
-                                              usingBlock:^(id<STShipID> sn, NSNumber *when, BOOL *stop) {
-        if ([when doubleValue] < ago) {
-            // long time ago
-            [neglected addObject:sn];
+        // remove mapping with SN
+        sn = [ship sn];
+        if (sn) {
+            [_arrivalMap removeObjectForKey:sn];
+            // TODO: callback?
+        }
+    }
+    // 2. forget neglected finished times
+    NSTimeInterval time;
+    NSNumber *when;
+    while ([budget consume]) {
+        if (![_finishedQueue popObject:&sn time:&time before:(now - ARRIVAL_FINISHED_EXPIRES)]) {
+            // nothing due
+            return YES;
+        }
+        when = [_arrivalFinished objectForKey:sn];
+        if (when && [when doubleValue] <= time) {
+            // not finished again after that
+            [_arrivalFinished removeObjectForKey:sn];
         }
-    }];
-    [neglected enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                usingBlock:^(id<STShipID> sn, NSUInteger idx, BOOL *stop) {
-        [_arrivalFinished removeObjectForKey:sn];
-    }];
+    }
+    return NO;
 }
 
 @end
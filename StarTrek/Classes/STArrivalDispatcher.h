@@ -0,0 +1,96 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STArrivalDispatcher.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STShip.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Arrival Dispatcher
+ *  ~~~~~~~~~~~~~~~~~~
+ *
+ *  Hands completed arrivals of one docker to a shared worker pool,
+ *  so a slow handler will not stall reading of other connections.
+ *
+ *  Each dispatcher owns a serial queue targeting the pool,
+ *  arrivals from the same connection are delivered in order;
+ *  when the queue is full, new arrivals will be dropped and counted.
+ *
+ *  NOTICE: the docker processes responses before dispatching, and an
+ *          income ship may be responded already when it is dropped here,
+ *          so a handler should not be much slower than the connection.
+ */
+@interface STArrivalDispatcher : NSObject
+
+@property(nonatomic, readonly) NSUInteger capacity;  // max waiting arrivals
+
+@property(nonatomic, readonly, getter=isFull) BOOL full;
+
+// statistics
+@property(nonatomic, readonly) NSUInteger depth;      // arrivals waiting now
+@property(nonatomic, readonly) NSUInteger peakDepth;
+@property(nonatomic, readonly) NSUInteger delivered;
+@property(nonatomic, readonly) NSUInteger dropped;
+
+@property(nonatomic, readonly) NSTimeInterval totalLatency;  // waiting time
+@property(nonatomic, readonly) NSTimeInterval maxLatency;
+@property(nonatomic, readonly) NSTimeInterval averageLatency;
+
+- (instancetype)initWithCapacity:(NSUInteger)size
+                           queue:(nullable dispatch_queue_t)pool
+NS_DESIGNATED_INITIALIZER;
+
+- (instancetype)initWithCapacity:(NSUInteger)size;
+
+/**
+ *  Append arrival to the queue, the handler will be called on the pool
+ *
+ * @param ship    - completed arrival
+ * @param handler - callback for processing the arrival
+ * @return false on queue full (dropped)
+ */
+- (BOOL)dispatchArrival:(id<STArrival>)ship handler:(void (^)(id<STArrival> ship))handler;
+
+- (void)resetStatistics;
+
+/**
+ *  Shared worker pool for all dispatchers (concurrent queue)
+ */
++ (dispatch_queue_t)sharedPool;
+
+@end
+
+NS_ASSUME_NONNULL_END
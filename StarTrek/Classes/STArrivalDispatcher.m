@@ -0,0 +1,188 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STArrivalDispatcher.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <ObjectKey/ObjectKey.h>
+
+#import "STArrivalDispatcher.h"
+
+// max arrivals waiting in one docker
+static const NSUInteger DISPATCHER_CAPACITY = 1024;
+
+@interface STArrivalDispatcher () {
+    
+    dispatch_queue_t _queue;  // serial, targeting the pool
+    
+    NSUInteger _depth;
+    NSUInteger _peakDepth;
+    NSUInteger _delivered;
+    NSUInteger _dropped;
+    
+    NSTimeInterval _totalLatency;
+    NSTimeInterval _maxLatency;
+}
+
+@end
+
+@implementation STArrivalDispatcher
+
++ (dispatch_queue_t)sharedPool {
+    static dispatch_queue_t _pool;
+    OKSingletonDispatchOnce(^{
+        _pool = dispatch_queue_create("chat.dim.StarTrek.arrivals", DISPATCH_QUEUE_CONCURRENT);
+    });
+    return _pool;
+}
+
+- (instancetype)init {
+    return [self initWithCapacity:DISPATCHER_CAPACITY queue:nil];
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)size {
+    return [self initWithCapacity:size queue:nil];
+}
+
+/* designated initializer */
+- (instancetype)initWithCapacity:(NSUInteger)size queue:(nullable dispatch_queue_t)pool {
+    if (self = [super init]) {
+        _capacity = size;
+        if (!pool) {
+            pool = [STArrivalDispatcher sharedPool];
+        }
+        _queue = dispatch_queue_create("chat.dim.StarTrek.docker", DISPATCH_QUEUE_SERIAL);
+        dispatch_set_target_queue(_queue, pool);
+        _depth = 0;
+        _peakDepth = 0;
+        _delivered = 0;
+        _dropped = 0;
+        _totalLatency = 0;
+        _maxLatency = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)depth {
+    @synchronized (self) {
+        return _depth;
+    }
+}
+
+- (BOOL)isFull {
+    @synchronized (self) {
+        return _capacity > 0 && _depth >= _capacity;
+    }
+}
+
+- (NSUInteger)peakDepth {
+    @synchronized (self) {
+        return _peakDepth;
+    }
+}
+
+- (NSUInteger)delivered {
+    @synchronized (self) {
+        return _delivered;
+    }
+}
+
+- (NSUInteger)dropped {
+    @synchronized (self) {
+        return _dropped;
+    }
+}
+
+- (NSTimeInterval)totalLatency {
+    @synchronized (self) {
+        return _totalLatency;
+    }
+}
+
+- (NSTimeInterval)maxLatency {
+    @synchronized (self) {
+        return _maxLatency;
+    }
+}
+
+- (NSTimeInterval)averageLatency {
+    @synchronized (self) {
+        return _delivered > 0 ? _totalLatency / _delivered : 0;
+    }
+}
+
+- (BOOL)dispatchArrival:(id<STArrival>)ship handler:(void (^)(id<STArrival> ship))handler {
+    @synchronized (self) {
+        if (_capacity > 0 && _depth >= _capacity) {
+            // queue full
+            ++_dropped;
+            return NO;
+        }
+        ++_depth;
+        if (_peakDepth < _depth) {
+            _peakDepth = _depth;
+        }
+    }
+    NSTimeInterval queued = OKGetCurrentTimeInterval();
+    __weak __typeof(self) weakSelf = self;
+    dispatch_async(_queue, ^{
+        [weakSelf arrivalStartedWithTime:queued];
+        handler(ship);
+    });
+    return YES;
+}
+
+// private
+- (void)arrivalStartedWithTime:(NSTimeInterval)queued {
+    NSTimeInterval latency = OKGetCurrentTimeInterval() - queued;
+    @synchronized (self) {
+        --_depth;
+        ++_delivered;
+        _totalLatency += latency;
+        if (_maxLatency < latency) {
+            _maxLatency = latency;
+        }
+    }
+}
+
+- (void)resetStatistics {
+    @synchronized (self) {
+        _peakDepth = _depth;
+        _delivered = 0;
+        _dropped = 0;
+        _totalLatency = 0;
+        _maxLatency = 0;
+    }
+}
+
+@end
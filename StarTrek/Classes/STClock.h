@@ -0,0 +1,102 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STClock.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Clock
+ *  ~~~~~
+ *
+ *  Time source for hub, gate & dockers (seconds since 1970).
+ *
+ *  The base clock reads the system time on each call,
+ *  'tick' will be called once per loop iteration by the owner,
+ *  so a subclass can sample the time there and serve it cached.
+ */
+@interface STClock : NSObject
+
+@property(nonatomic, readonly) NSTimeInterval now;
+
+/**
+ *  Called at the beginning of each loop iteration
+ *
+ * @return current time
+ */
+- (NSTimeInterval)tick;
+
+@end
+
+@interface STClock (Creation)
+
+/**
+ *  Shared system clock
+ */
++ (STClock *)defaultClock;
+
+@end
+
+/**
+ *  Coarse Clock
+ *  ~~~~~~~~~~~~
+ *
+ *  Samples the coarse monotonic clock once per 'tick',
+ *  and returns the cached time until next tick; the monotonic time
+ *  is shifted to the system time when the clock created.
+ */
+@interface STCoarseClock : STClock
+
+@end
+
+/**
+ *  Virtual Clock
+ *  ~~~~~~~~~~~~~
+ *
+ *  Time moves only when told to, for deterministic simulations.
+ */
+@interface STVirtualClock : STClock
+
+- (instancetype)initWithTime:(NSTimeInterval)now
+NS_DESIGNATED_INITIALIZER;
+
+- (void)setTime:(NSTimeInterval)now;
+
+- (void)advance:(NSTimeInterval)delta;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,183 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STClock.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <time.h>
+
+#import <ObjectKey/ObjectKey.h>
+
+#import "STClock.h"
+
+#if defined(CLOCK_MONOTONIC_COARSE)
+#define ST_COARSE_CLOCK CLOCK_MONOTONIC_COARSE      // Linux
+#elif defined(CLOCK_MONOTONIC_RAW_APPROX)
+#define ST_COARSE_CLOCK CLOCK_MONOTONIC_RAW_APPROX  // Darwin
+#else
+#define ST_COARSE_CLOCK CLOCK_MONOTONIC
+#endif
+
+static inline NSTimeInterval coarse_time(void) {
+    struct timespec ts;
+    clock_gettime(ST_COARSE_CLOCK, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+// time is shared between threads as the bit pattern of a double
+static inline UInt64 time_bits(NSTimeInterval time) {
+    UInt64 bits;
+    memcpy(&bits, &time, sizeof(bits));
+    return bits;
+}
+
+static inline NSTimeInterval bits_time(UInt64 bits) {
+    NSTimeInterval time;
+    memcpy(&time, &bits, sizeof(time));
+    return time;
+}
+
+@implementation STClock
+
+- (NSTimeInterval)now {
+    return OKGetCurrentTimeInterval();
+}
+
+- (NSTimeInterval)tick {
+    return [self now];
+}
+
+@end
+
+@implementation STClock (Creation)
+
++ (STClock *)defaultClock {
+    static STClock *s_clock = nil;
+    OKSingletonDispatchOnce(^{
+        s_clock = [[STClock alloc] init];
+    });
+    return s_clock;
+}
+
+@end
+
+#pragma mark -
+
+@interface STCoarseClock () {
+
+    NSTimeInterval _offset;  // system time - monotonic time
+    UInt64 _now;             // sampled time, atomic bits
+}
+
+@end
+
+@implementation STCoarseClock
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _offset = OKGetCurrentTimeInterval() - coarse_time();
+        __atomic_store_n(&_now, time_bits(0), __ATOMIC_RELEASE);
+        [self tick];
+    }
+    return self;
+}
+
+// Override
+- (NSTimeInterval)now {
+    return bits_time(__atomic_load_n(&_now, __ATOMIC_ACQUIRE));
+}
+
+// Override
+- (NSTimeInterval)tick {
+    NSTimeInterval now = coarse_time() + _offset;
+    UInt64 old = __atomic_load_n(&_now, __ATOMIC_ACQUIRE);
+    // never go back, even when ticked by several threads
+    while (now > bits_time(old)) {
+        if (__atomic_compare_exchange_n(&_now, &old, time_bits(now), NO,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return now;
+        }
+    }
+    return bits_time(old);
+}
+
+@end
+
+#pragma mark -
+
+@interface STVirtualClock () {
+
+    NSTimeInterval _now;
+}
+
+@end
+
+@implementation STVirtualClock
+
+- (instancetype)init {
+    return [self initWithTime:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithTime:(NSTimeInterval)now {
+    if (self = [super init]) {
+        _now = now;
+    }
+    return self;
+}
+
+// Override
+- (NSTimeInterval)now {
+    @synchronized (self) {
+        return _now;
+    }
+}
+
+// Override
+- (NSTimeInterval)tick {
+    return [self now];
+}
+
+- (void)setTime:(NSTimeInterval)now {
+    @synchronized (self) {
+        _now = now;
+    }
+}
+
+- (void)advance:(NSTimeInterval)delta {
+    @synchronized (self) {
+        _now += delta;
+    }
+}
+
+@end
@@ -0,0 +1,161 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STCoalescer.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Small Packages Coalescer
+ *  ~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *  Packs fragments into one packet (up to MSS) before writing:
+ *
+ *      +--------+---------+--------+---------+-----
+ *      | length | payload | length | payload | ...
+ *      +--------+---------+--------+---------+-----
+ *
+ *  'length' is 2 bytes in network order, or 0xFFFF followed by
+ *  4 bytes for payload not less than 65535 bytes.
+ *
+ *  The packet is flushed when it is full, when the first fragment
+ *  has been waiting for 'delay' seconds, or immediately when an
+ *  urgent fragment comes.
+ *
+ *  NOTICE: both sides must enable it, the receiver splits packets
+ *          with the same framing before building arrivals.
+ *
+ *  Received payloads larger than 'maxFrameLength' are rejected, and the
+ *  buffered data is dropped; for datagram transports ('datagram' set),
+ *  each received data is a whole packet, incomplete bytes are dropped
+ *  instead of joined with the next packet.
+ */
+@interface STCoalescer : NSObject
+
+@property(nonatomic, assign) NSUInteger maxLength;   // packet size (default is MSS)
+@property(nonatomic, assign) NSTimeInterval delay;   // max waiting time (seconds)
+
+// fragments with priority not greater than this will be flushed immediately
+@property(nonatomic, assign) NSInteger urgentPriority;
+
+// max payload length accepted when splitting (default is 1 MB)
+@property(nonatomic, assign) NSUInteger maxFrameLength;
+
+// each received data is a whole packet (default is NO, for stream)
+@property(nonatomic, assign, getter=isDatagram) BOOL datagram;
+
+// bytes waiting to be written
+@property(nonatomic, readonly) NSUInteger length;
+
+// when the packet should be written (delay timeout of the first fragment),
+// 0 for nothing packed, or the packet is being written
+@property(nonatomic, readonly) NSTimeInterval flushTime;
+
+// received bytes dropped by 'maxFrameLength' or datagram boundaries
+@property(nonatomic, readonly) NSUInteger droppedLength;
+
+- (instancetype)initWithMaxLength:(NSUInteger)size delay:(NSTimeInterval)seconds
+NS_DESIGNATED_INITIALIZER;
+
+#pragma mark Sending
+
+/**
+ *  Check whether the fragment can be packed into current packet
+ *
+ * @param length - fragment length
+ * @return false when the packet should be flushed first
+ */
+- (BOOL)canAppendLength:(NSUInteger)length;
+
+/**
+ *  Pack fragment into current packet
+ *
+ * @param fragment - data to be sent
+ * @param prior    - priority of the departure
+ * @param now      - current time
+ */
+- (void)appendData:(NSData *)fragment priority:(NSInteger)prior time:(NSTimeInterval)now;
+
+/**
+ *  Check whether the packet should be written now
+ *
+ * @param now - current time
+ * @return true on full, delay timeout, urgent, or partially written
+ */
+- (BOOL)isReadyWithTime:(NSTimeInterval)now;
+
+/**
+ *  Close current packet for writing
+ *
+ * @return remaining bytes of the packet, nil on empty
+ */
+- (nullable NSData *)packet;
+
+/**
+ *  Close current packet for writing, without cutting the remaining bytes
+ *
+ * @param offset - output written bytes of the packet
+ * @return the whole packet, nil on empty
+ */
+- (nullable NSData *)packetWithOffset:(NSUInteger *)offset;
+
+/**
+ *  Called after the packet (or part of it) written
+ *
+ * @param length - written length
+ */
+- (void)sentLength:(NSUInteger)length;
+
+/**
+ *  Called after the connection failed to write the packet,
+ *  the remaining bytes of it will be discarded
+ */
+- (void)dropPacket;
+
+#pragma mark Receiving
+
+/**
+ *  Split received data into payloads,
+ *  incomplete payload will be kept for the next data (stream only)
+ *
+ * @param data - received data
+ * @return payloads
+ */
+- (NSArray<NSData *> *)splitData:(NSData *)data;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,254 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STCoalescer.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STShip.h"
+
+#import "STCoalescer.h"
+
+// max waiting time for the first fragment in packet
+static const NSTimeInterval COALESCER_DELAY = 0.005;  // seconds
+
+// max payload length accepted from the remote peer
+static const NSUInteger COALESCER_MAX_FRAME = 1024 * 1024;  // 1 MB
+
+static inline NSUInteger header_length(NSUInteger size) {
+    return size < 0xFFFF ? 2 : 6;
+}
+
+static inline void append_header(NSMutableData *buffer, NSUInteger size) {
+    UInt8 header[6];
+    if (size < 0xFFFF) {
+        header[0] = (size >> 8) & 0xFF;
+        header[1] = size & 0xFF;
+        [buffer appendBytes:header length:2];
+    } else {
+        header[0] = 0xFF;
+        header[1] = 0xFF;
+        header[2] = (size >> 24) & 0xFF;
+        header[3] = (size >> 16) & 0xFF;
+        header[4] = (size >> 8) & 0xFF;
+        header[5] = size & 0xFF;
+        [buffer appendBytes:header length:6];
+    }
+}
+
+// return bytes of header, 0 on data not enough
+static inline NSUInteger read_header(const UInt8 *bytes, NSUInteger length, NSUInteger *size) {
+    if (length < 2) {
+        return 0;
+    }
+    NSUInteger value = ((NSUInteger)bytes[0] << 8) | bytes[1];
+    if (value < 0xFFFF) {
+        *size = value;
+        return 2;
+    } else if (length < 6) {
+        return 0;
+    }
+    *size = ((NSUInteger)bytes[2] << 24) | ((NSUInteger)bytes[3] << 16)
+          | ((NSUInteger)bytes[4] << 8) | bytes[5];
+    return 6;
+}
+
+@interface STCoalescer () {
+    
+    NSMutableData *_buffer;     // packet being packed
+    NSTimeInterval _firstTime;  // packed time of the first fragment
+    BOOL _urgent;
+    
+    NSData *_sealed;            // packet being written
+    NSUInteger _offset;         // written bytes of the sealed packet
+    
+    NSMutableData *_incoming;   // received data not split yet
+}
+
+@end
+
+@implementation STCoalescer
+
+- (instancetype)init {
+    return [self initWithMaxLength:ST_MSS delay:COALESCER_DELAY];
+}
+
+/* designated initializer */
+- (instancetype)initWithMaxLength:(NSUInteger)size delay:(NSTimeInterval)seconds {
+    if (self = [super init]) {
+        _maxLength = size;
+        _delay = seconds;
+        _urgentPriority = STDeparturePriorityUrgent;
+        _buffer = [[NSMutableData alloc] initWithCapacity:size];
+        _firstTime = 0;
+        _urgent = NO;
+        _sealed = nil;
+        _offset = 0;
+        _incoming = [[NSMutableData alloc] init];
+        _maxFrameLength = COALESCER_MAX_FRAME;
+        _datagram = NO;
+        _droppedLength = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)length {
+    return [_buffer length] + [_sealed length] - _offset;
+}
+
+- (NSTimeInterval)flushTime {
+    if (_sealed || [_buffer length] == 0) {
+        return 0;
+    } else if (_urgent) {
+        return _firstTime;
+    }
+    return _firstTime + _delay;
+}
+
+- (BOOL)canAppendLength:(NSUInteger)length {
+    if (_sealed) {
+        // write the closed packet first
+        return NO;
+    }
+    NSUInteger packed = [_buffer length];
+    if (packed == 0) {
+        // a large fragment can go alone
+        return YES;
+    }
+    return packed + header_length(length) + length <= _maxLength;
+}
+
+- (void)appendData:(NSData *)fragment priority:(NSInteger)prior time:(NSTimeInterval)now {
+    if ([_buffer length] == 0) {
+        _firstTime = now;
+    }
+    NSUInteger size = [fragment length];
+    append_header(_buffer, size);
+    [_buffer appendData:fragment];
+    if (prior <= _urgentPriority) {
+        _urgent = YES;
+    }
+}
+
+- (BOOL)isReadyWithTime:(NSTimeInterval)now {
+    if (_sealed) {
+        // partially written
+        return YES;
+    }
+    NSUInteger packed = [_buffer length];
+    if (packed == 0) {
+        return NO;
+    } else if (_urgent) {
+        return YES;
+    } else if (packed + 3 > _maxLength) {
+        // no room for one more byte
+        return YES;
+    }
+    return now >= _firstTime + _delay;
+}
+
+- (nullable NSData *)packet {
+    NSUInteger offset;
+    NSData *packet = [self packetWithOffset:&offset];
+    if (offset == 0) {
+        return packet;
+    }
+    return [packet subdataWithRange:NSMakeRange(offset, [packet length] - offset)];
+}
+
+- (nullable NSData *)packetWithOffset:(NSUInteger *)offset {
+    if (!_sealed) {
+        if ([_buffer length] == 0) {
+            return nil;
+        }
+        // close current packet, and start a new one
+        _sealed = _buffer;
+        _offset = 0;
+        _buffer = [[NSMutableData alloc] initWithCapacity:_maxLength];
+        _urgent = NO;
+    }
+    *offset = _offset;
+    return _sealed;
+}
+
+- (void)sentLength:(NSUInteger)length {
+    _offset += length;
+    if (_offset >= [_sealed length]) {
+        // packet written
+        _sealed = nil;
+        _offset = 0;
+    }
+}
+
+- (void)dropPacket {
+    _sealed = nil;
+    _offset = 0;
+}
+
+- (NSArray<NSData *> *)splitData:(NSData *)data {
+    NSData *source = data;
+    if ([_incoming length] > 0) {
+        // join with the remaining data
+        [_incoming appendData:data];
+        source = _incoming;
+    }
+    NSMutableArray<NSData *> *payloads = [[NSMutableArray alloc] init];
+    const UInt8 *bytes = [source bytes];
+    NSUInteger total = [source length];
+    NSUInteger pos = 0, head, size;
+    while (pos < total) {
+        head = read_header(bytes + pos, total - pos, &size);
+        if (head > 0 && size > _maxFrameLength) {
+            // corrupted or hostile header, drop all buffered data
+            _droppedLength += total - pos;
+            [_incoming setLength:0];
+            return payloads;
+        } else if (head == 0 || pos + head + size > total) {
+            // waiting for more data
+            break;
+        }
+        [payloads addObject:[source subdataWithRange:NSMakeRange(pos + head, size)]];
+        pos += head + size;
+    }
+    if (_datagram) {
+        // packet boundary, never join with the next packet
+        _droppedLength += total - pos;
+    } else if (source == _incoming) {
+        // keep the remaining data
+        [_incoming replaceBytesInRange:NSMakeRange(0, pos) withBytes:NULL length:0];
+    } else if (pos < total) {
+        [_incoming appendBytes:(bytes + pos) length:(total - pos)];
+    }
+    return payloads;
+}
+
+@end
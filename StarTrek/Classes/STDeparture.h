@@ -35,11 +35,17 @@
 //
 
 #import <StarTrek/STShip.h>
+#import <StarTrek/STDepartureQuota.h>
+#import <StarTrek/STDepartureScheduler.h>
+#import <StarTrek/STPurge.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface STDeparture : NSObject <STDeparture>
 
+// absolute time after which the task is useless (0 for never expired)
+@property(nonatomic, assign) NSTimeInterval deadline;
+
 - (instancetype)initWithPriority:(NSInteger)prior maxTries:(NSInteger)count
 NS_DESIGNATED_INITIALIZER;
 
@@ -47,19 +53,67 @@ NS_DESIGNATED_INITIALIZER;
 
 #pragma mark -
 
+@class STDepartureHall;
+
+@protocol STDepartureHallDelegate <NSObject>
+
+/**
+ *  Callback when a waiting ship is dropped for the quota
+ *
+ * @param hall - departure hall
+ * @param ship - dropped departure task
+ */
+- (void)departureHall:(STDepartureHall *)hall droppedDeparture:(id<STDeparture>)ship;
+
+/**
+ *  Callback when a ship is dropped for its deadline passed
+ *
+ * @param hall - departure hall
+ * @param ship - expired departure task
+ */
+- (void)departureHall:(STDepartureHall *)hall expiredDeparture:(id<STDeparture>)ship;
+
+@end
+
 /**
  *  Memory cache for Departures
  */
 @interface STDepartureHall : NSObject
 
+// limits for waiting ships (unlimited by default)
+@property(nonatomic, strong) STDepartureQuota *quota;
+
+// what to do when the quota is full (default is reject)
+@property(nonatomic, assign) STQuotaPolicy policy;
+
+@property(nonatomic, weak, nullable) id<STDepartureHallDelegate> delegate;
+
+// decides which new ship goes first
+@property(nonatomic, strong, readonly) id<STDepartureScheduler> scheduler;
+
+// protected
+- (STDepartureQuota *)createQuota;
+
+// protected, override for user-customized scheduler (default is strict priority)
+- (id<STDepartureScheduler>)createScheduler;
+
 /**
  *  Add outgoing ship to the waiting queue
  *
  * @param outgo - departure task
- * @return false on duplicated
+ * @return false on duplicated, expired, or refused by the quota
  */
 - (BOOL)addDeparture:(id<STDeparture>)outgo;
 
+/**
+ *  Add outgoing ship to the waiting queue
+ *
+ * @param outgo - departure task
+ * @param now   - current time
+ * @return false on duplicated, expired, or refused by the quota
+ */
+- (BOOL)addDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now;
+
 /**
  *  Check response from incoming ship
  *
@@ -69,7 +123,35 @@ NS_DESIGNATED_INITIALIZER;
 - (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response;
 
 /**
- *  Get next new/timeout task
+ *  Check response from incoming ship
+ *
+ * @param response - incoming ship with SN
+ * @param now      - current time
+ * @return finished task
+ */
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response time:(NSTimeInterval)now;
+
+/**
+ *  Check responses from incoming ships (with cumulative acks)
+ *
+ * @param responses - incoming ships with SN
+ * @return finished tasks
+ */
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses;
+
+/**
+ *  Check responses from incoming ships (with cumulative acks)
+ *
+ * @param responses - incoming ships with SN
+ * @param now       - current time
+ * @return finished tasks
+ */
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses
+                                                  time:(NSTimeInterval)now;
+
+/**
+ *  Get next new/timeout task,
+ *  expired tasks will be dropped and reported to the delegate
  *
  * @param now - current time
  * @return departure task
@@ -77,10 +159,30 @@ NS_DESIGNATED_INITIALIZER;
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now;
 
 /**
- *  Clear all expired tasks
+ *  Get a new task with higher priority out of the scheduler's turn,
+ *  for preempting the sending ones
+ *
+ * @param prior - priority to be preempted
+ * @param now   - current time
+ * @return nil when no new task has higher priority
+ */
+- (nullable id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior
+                                                   time:(NSTimeInterval)now;
+
+/**
+ *  Clear finished tasks with the default budget
  */
 - (void)purge;
 
+/**
+ *  Clear finished tasks, resume from where last call stopped
+ *
+ * @param now    - current time
+ * @param budget - max entries/time for this call
+ * @return true when a whole round finished
+ */
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -52,6 +52,21 @@ static const NSTimeInterval DEPARTURE_EXPIRES = 120.0;  // seconds
  */
 static const NSInteger DEPARTURE_RETRIES = 2;
 
+// finished SN will be forgot after 1 hour
+static const NSTimeInterval DEPARTURE_FINISHED_EXPIRES = 3600.0;
+
+NSTimeInterval STDepartureDeadline(id<STDeparture> ship) {
+    if ([ship respondsToSelector:@selector(deadline)]) {
+        return [ship deadline];
+    }
+    return 0;
+}
+
+BOOL STDepartureIsExpired(id<STDeparture> ship, NSTimeInterval now) {
+    NSTimeInterval deadline = STDepartureDeadline(ship);
+    return deadline > 0 && now >= deadline;
+}
+
 @interface STDeparture () {
     
     NSTimeInterval _expired;  // expired time
@@ -74,6 +89,7 @@ static const NSInteger DEPARTURE_RETRIES = 2;
         _priority = prior;
         _tries = count;
         _expired = 0;
+        _deadline = 0;
     }
     return self;
 }
@@ -144,17 +160,27 @@ static const NSInteger DEPARTURE_RETRIES = 2;
 @property(nonatomic, strong) OKWeakSet<id<STDeparture>> *allDepartures;
 
 // new ships waiting to send out
-@property(nonatomic, strong) OKArrayList<id<STDeparture>> *virginDepartures;
+@property(nonatomic, strong) id<STDepartureScheduler> scheduler;
 
 // ships waiting for responses
 @property(nonatomic, strong) OKHashMap<NSNumber *, OKArrayList<id<STDeparture>> *> *fleets;
 @property(nonatomic, strong) OKArrayList<NSNumber *> *priorities;
 
+// ship => bytes taken from the quota
+@property(nonatomic, strong) NSMapTable<id<STDeparture>, NSNumber *> *departureSizes;
+
 // index
 @property(nonatomic, strong) OKWeakMap<id<STShipID>, id<STDeparture>> *departureMap;
 @property(nonatomic, strong) OKHashMap<id<STShipID>, NSNumber *> *departureFinished;
 @property(nonatomic, strong) OKWeakHashMap<id<STShipID>, NSNumber *> *departureLevel;
 
+// ships waiting for responses, swept in turn (weak)
+@property(nonatomic, strong) STExpiryQueue<id<STDeparture>> *sweepQueue;
+@property(nonatomic, assign) NSUInteger sweepRemaining;  // entries left in this round
+
+// finished SNs in order of finished time
+@property(nonatomic, strong) STExpiryQueue<id<STShipID>> *finishedQueue;
+
 @end
 
 @implementation STDepartureHall
@@ -162,41 +188,158 @@ static const NSInteger DEPARTURE_RETRIES = 2;
 - (instancetype)init {
     if (self = [super init]) {
         self.allDepartures     = [OKWeakSet set];
-        self.virginDepartures  = [OKArrayList array];
+        self.scheduler         = [self createScheduler];
         self.fleets            = [OKHashMap dictionary];
         self.priorities        = [OKArrayList array];
         self.departureMap      = [OKWeakMap map];
         self.departureFinished = [OKHashMap dictionary];
         self.departureLevel    = [OKWeakHashMap map];
+        self.sweepQueue        = [[STExpiryQueue alloc] initWithWeakObjects:YES];
+        self.sweepRemaining    = 0;
+        self.finishedQueue     = [[STExpiryQueue alloc] initWithWeakObjects:NO];
+        NSPointerFunctionsOptions keyOptions = NSPointerFunctionsStrongMemory
+                                             | NSPointerFunctionsObjectPointerPersonality;
+        self.departureSizes = [NSMapTable mapTableWithKeyOptions:keyOptions
+                                                    valueOptions:NSPointerFunctionsStrongMemory];
+        self.quota  = [self createQuota];
+        self.policy = STQuotaPolicyReject;
+        self.delegate = nil;
     }
     return self;
 }
 
+// override for user-customized quota
+- (STDepartureQuota *)createQuota {
+    // no limits
+    return [[STDepartureQuota alloc] init];
+}
+
+// override for user-customized scheduler
+- (id<STDepartureScheduler>)createScheduler {
+    return [[STPriorityScheduler alloc] init];
+}
+
 - (BOOL)addDeparture:(id<STDeparture>)outgo {
+    return [self addDeparture:outgo time:OKGetCurrentTimeInterval()];
+}
+
+- (BOOL)addDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now {
     // 1. check duplicated
     if ([_allDepartures containsObject:outgo]) {
         return NO;
-    } else {
-        [_allDepartures addObject:outgo];
     }
-    // 2. insert to the sorted queue
-    NSInteger priority = [outgo priority];
-    __block NSInteger index = 0;
-    [_virginDepartures enumerateObjectsUsingBlock:^(id<STDeparture> ship, NSUInteger idx, BOOL *stop) {
-        if ([ship priority] > priority) {
-            // take the place before first ship
-            // which priority is greater then this one.
-            index = idx;
-            *stop = YES;
+    if (STDepartureIsExpired(outgo, now)) {
+        // useless already
+        return NO;
+    }
+    // 2. check quota
+    NSUInteger size = 0;
+    for (NSData *fra in [outgo fragments]) {
+        size += [fra length];
+    }
+    if (![self admitDeparture:outgo size:size]) {
+        return NO;
+    }
+    [_allDepartures addObject:outgo];
+    @synchronized (_departureSizes) {
+        [_departureSizes setObject:@(size) forKey:outgo];
+    }
+    // 3. append to the class of its priority
+    [_scheduler enqueueDeparture:outgo size:size time:now];
+    return YES;
+}
+
+// private, take room from the quota
+- (BOOL)admitDeparture:(id<STDeparture>)outgo size:(NSUInteger)size {
+    id<STDeparture> victim;
+    while (![_quota tryAcquireShips:1 bytes:size]) {
+        // quota full, only new ships which not sent yet can be dropped
+        if (_policy == STQuotaPolicyDropLowestPriority) {
+            victim = [_scheduler lowestDeparture];
+            if ([victim priority] <= [outgo priority]) {
+                // the new one is the lowest
+                victim = nil;
+            }
+        } else if (_policy == STQuotaPolicyDropOldest) {
+            victim = [_scheduler oldestDeparture];
+        } else {
+            victim = nil;
         }
-    }];
-    [_virginDepartures insertObject:outgo atIndex:index];
+        if (!victim) {
+            // refused
+            return NO;
+        }
+        [_scheduler removeDeparture:victim];
+        [_allDepartures removeObject:victim];
+        [self releaseDeparture:victim];
+        [_delegate departureHall:self droppedDeparture:victim];
+    }
     return YES;
 }
 
+// private
+- (void)releaseDeparture:(id<STDeparture>)ship {
+    NSNumber *size;
+    @synchronized (_departureSizes) {
+        size = [_departureSizes objectForKey:ship];
+        [_departureSizes removeObjectForKey:ship];
+    }
+    if (size) {
+        [_quota releaseShips:1 bytes:[size unsignedIntegerValue]];
+    }
+}
+
 - (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response {
+    return [self checkResponseInArrival:response time:OKGetCurrentTimeInterval()];
+}
+
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response time:(NSTimeInterval)now {
     id<STShipID> sn = [response sn];
     NSAssert(sn, @"Ship SN not found: %@", response);
+    if (!sn) {
+        return nil;
+    }
+    return [self checkResponseInArrival:response withID:sn time:now];
+}
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses {
+    return [self checkResponsesInArrivals:responses time:OKGetCurrentTimeInterval()];
+}
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses
+                                                  time:(NSTimeInterval)now {
+    NSMutableArray<id<STDeparture>> *finished = [[NSMutableArray alloc] init];
+    NSArray<id<STShipID>> *acks;
+    id<STShipID> sn;
+    id<STDeparture> ship;
+    for (id<STArrival> response in responses) {
+        acks = nil;
+        if ([response respondsToSelector:@selector(respondedShipIDs)]) {
+            acks = [response respondedShipIDs];
+        }
+        if ([acks count] == 0) {
+            sn = [response sn];
+            if (!sn) {
+                // not a response
+                continue;
+            }
+            // response for the ship with same SN
+            acks = @[sn];
+        }
+        for (sn in acks) {
+            ship = [self checkResponseInArrival:response withID:sn time:now];
+            if (ship) {
+                [finished addObject:ship];
+            }
+        }
+    }
+    return finished;
+}
+
+// private
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response
+                                   withID:(id<STShipID>)sn
+                                     time:(NSTimeInterval)now {
     // check whether this task has already finished
     NSNumber *time = [_departureFinished objectForKey:sn];
     if ([time doubleValue] > 0) {
@@ -209,12 +352,18 @@ static const NSInteger DEPARTURE_RETRIES = 2;
         // remove it and clear mapping when SN exists
         [self removeDepartureShip:ship withID:sn];
         // mark finished time
-        [_departureFinished setObject:@(OKGetCurrentTimeInterval()) forKey:sn];
+        [self markFinishedWithID:sn time:now];
         return ship;
     }
     return nil;
 }
 
+// private
+- (void)markFinishedWithID:(id<STShipID>)sn time:(NSTimeInterval)now {
+    [_departureFinished setObject:@(now) forKey:sn];
+    [_finishedQueue addObject:sn time:now];
+}
+
 // private
 - (void)removeDepartureShip:(id<STDeparture>)ship withID:(id<STShipID>)sn {
     NSNumber *priority = [_departureLevel objectForKey:sn];
@@ -230,6 +379,7 @@ static const NSInteger DEPARTURE_RETRIES = 2;
     [_departureMap removeObjectForKey:sn];
     [_departureLevel removeObjectForKey:sn];
     [_allDepartures removeObject:ship];
+    [self releaseDeparture:ship];
 }
 
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now {
@@ -238,14 +388,37 @@ static const NSInteger DEPARTURE_RETRIES = 2;
     return next ? next : [self nextTimeoutDepartureWithTime:now];
 }
 
+- (id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior time:(NSTimeInterval)now {
+    id<STDeparture> outgo = [_scheduler dequeueDepartureBeforePriority:prior time:now];
+    while (outgo && STDepartureIsExpired(outgo, now)) {
+        // deadline passed, drop it
+        [self expireDeparture:outgo];
+        outgo = [_scheduler dequeueDepartureBeforePriority:prior time:now];
+    }
+    return outgo ? [self launchDeparture:outgo time:now] : nil;
+}
+
 // private
 - (id<STDeparture>)nextNewDepartureWithTime:(NSTimeInterval)now {
-    if ([_virginDepartures count] == 0) {
-        return nil;
+    // get next ship from the scheduler
+    id<STDeparture> outgo = [_scheduler dequeueDepartureWithTime:now];
+    while (outgo && STDepartureIsExpired(outgo, now)) {
+        // deadline passed, drop it
+        [self expireDeparture:outgo];
+        outgo = [_scheduler dequeueDepartureWithTime:now];
     }
-    // get first ship
-    id<STDeparture> outgo = [_virginDepartures firstObject];
-    [_virginDepartures removeObjectAtIndex:0];
+    return outgo ? [self launchDeparture:outgo time:now] : nil;
+}
+
+// private
+- (void)expireDeparture:(id<STDeparture>)outgo {
+    [_allDepartures removeObject:outgo];
+    [self releaseDeparture:outgo];
+    [_delegate departureHall:self expiredDeparture:outgo];
+}
+
+// private, new ship taken from the scheduler
+- (id<STDeparture>)launchDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now {
     id<STShipID> sn = [outgo sn];
     if ([outgo isImportant] && sn) {
         // this task needs response
@@ -254,10 +427,12 @@ static const NSInteger DEPARTURE_RETRIES = 2;
         [self insertDepartureShip:outgo withID:sn priority:priority];
         // build index for it
         [_departureMap setObject:outgo forKey:sn];
+        [_sweepQueue addObject:outgo time:now];
     } else {
         // disposable ship needs no response,
         // remove it immediately
         [_allDepartures removeObject:outgo];
+        [self releaseDeparture:outgo];
     }
     // update expired time
     [outgo touch:now];
@@ -304,6 +479,7 @@ static const NSInteger DEPARTURE_RETRIES = 2;
 // private
 - (id<STDeparture>)nextTimeoutDepartureWithTime:(NSTimeInterval)now {
     __block id<STDeparture> result = nil;
+    OKArrayList<id<STDeparture>> *expired = [[OKArrayList alloc] init];
     [_priorities enumerateObjectsUsingBlock:^(NSNumber *prior, NSUInteger idx, BOOL *stop) {
         NSInteger priority = [prior integerValue];
         // 1. get tasks with priority
@@ -314,7 +490,10 @@ static const NSInteger DEPARTURE_RETRIES = 2;
                 id<STShipID> sn = [ship sn];
                 NSAssert(sn, @"Ship ID should not be empty here");
                 STShipStatus status = [ship status:now];
-                if (status == STShipStatusTimeout) {
+                if (status == STShipStatusTimeout && STDepartureIsExpired(ship, now)) {
+                    // deadline passed, no need to retry
+                    [expired addObject:ship];
+                } else if (status == STShipStatusTimeout) {
                     // response timeout, needs retry now.
                     // move to next priority
                     [array removeObject:ship];
@@ -331,6 +510,7 @@ static const NSInteger DEPARTURE_RETRIES = 2;
                     [_departureMap removeObjectForKey:sn];
                     [_departureLevel removeObjectForKey:sn];
                     [_allDepartures removeObject:ship];
+                    [self releaseDeparture:ship];
                     result = ship;
                     *stop2 = YES;
                 }
@@ -341,64 +521,74 @@ static const NSInteger DEPARTURE_RETRIES = 2;
             }
         }
     }];
+    // drop expired tasks
+    for (id<STDeparture> ship in expired) {
+        [self removeDepartureShip:ship withID:[ship sn]];
+        [_delegate departureHall:self expiredDeparture:ship];
+    }
     return result;
 }
 
 - (void)purge {
-    NSTimeInterval now = OKGetCurrentTimeInterval();
-    // 1. seeking finished tasks
-    OKArrayList<NSNumber *> *emptyPositions = [[OKArrayList alloc] init];
-    [_priorities enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                  usingBlock:^(NSNumber *prior, NSUInteger idx, BOOL *stop) {
-        OKArrayList<id<STDeparture>> *array = [_fleets objectForKey:prior];
-        if (array) {
-            OKArrayList<id<STDeparture>> *finished = [[OKArrayList alloc] init];
-            [array enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                    usingBlock:^(id<STDeparture> ship, NSUInteger idx2, BOOL *stop2) {
-                if ([ship status:now] == STShipStatusDone) {
-                    // task done
-                    [finished addObject:ship];
-                    id<STShipID> sn = [ship sn];
-                    NSAssert(sn, @"Ship SN should not be empty here");
-                    [_departureMap removeObjectForKey:sn];
-                    [_departureLevel removeObjectForKey:sn];
-                    // mark finished time
-                    [_departureFinished setObject:@(OKGetCurrentTimeInterval()) forKey:sn];
-                }
-            }];
-            // remove finished tasks
-            [finished enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                       usingBlock:^(id<STDeparture> ship, NSUInteger idx3, BOOL *stop3) {
-                [array removeObject:ship];
-            }];
-            // remove array when empty
-            if ([array count] == 0) {
-                [_fleets removeObjectForKey:prior];
-                [emptyPositions addObject:@(idx)];
-            }
-        } else {
-            // this priority is empty
-            [emptyPositions addObject:@(idx)];
+    [self purgeWithTime:OKGetCurrentTimeInterval() budget:[STPurgeBudget budget]];
+}
+
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget {
+    // 0. remove empty priorities (only a few levels)
+    NSUInteger index = [_priorities count];
+    while (index > 0) {
+        --index;
+        if (![_fleets objectForKey:[_priorities objectAtIndex:index]]) {
+            [_priorities removeObjectAtIndex:index];
         }
-    }];
-    [emptyPositions enumerateObjectsWithOptions:NSEnumerationReverse
-                                     usingBlock:^(NSNumber *pos, NSUInteger idx, BOOL *stop) {
-        [_priorities removeObjectAtIndex:[pos integerValue]];
-    }];
-    // 2. seeking neglected finished times
-    OKArrayList<id<STShipID>> *neglected = [[OKArrayList alloc] init];
-    NSTimeInterval ago = now - 3600.0;
-    [_departureFinished enumerateKeysAndObjectsWithOptions:NSEnumerationConcurrent
-                                                usingBlock:^(id<STShipID> sn, NSNumber *when, BOOL *stop) {
-        if ([when doubleValue] < ago) {
-            // long time ago
-            [neglected addObject:sn];
+    }
+    // 1. sweep ships waiting for responses in turn
+    if (_sweepRemaining == 0) {
+        // start a new round
+        _sweepRemaining = [_sweepQueue count];
+    }
+    id<STDeparture> ship;
+    id<STShipID> sn;
+    while (_sweepRemaining > 0 && [budget consume]) {
+        --_sweepRemaining;
+        // NOTICE: every entry is due, the limit is only for taking the head
+        if (![_sweepQueue popObject:&ship time:NULL before:INFINITY]) {
+            _sweepRemaining = 0;
+            break;
         }
-    }];
-    [neglected enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                usingBlock:^(id<STShipID> sn, NSUInteger idx, BOOL *stop) {
-        [_departureFinished removeObjectForKey:sn];
-    }];
+        sn = [ship sn];
+        if (!ship || [_departureMap objectForKey:sn] != ship) {
+            // released, responded or failed
+            continue;
+        } else if ([ship status:now] != STShipStatusDone) {
+            // still waiting, check it in next round
+            [_sweepQueue addObject:ship time:now];
+            continue;
+        }
+        // task done
+        [self removeDepartureShip:ship withID:sn];
+        // mark finished time
+        [self markFinishedWithID:sn time:now];
+    }
+    if (_sweepRemaining > 0) {
+        // budget exhausted
+        return NO;
+    }
+    // 2. forget neglected finished times
+    NSTimeInterval time;
+    NSNumber *when;
+    while ([budget consume]) {
+        if (![_finishedQueue popObject:&sn time:&time before:(now - DEPARTURE_FINISHED_EXPIRES)]) {
+            // nothing due
+            return YES;
+        }
+        when = [_departureFinished objectForKey:sn];
+        if (when && [when doubleValue] <= time) {
+            // not finished again after that
+            [_departureFinished removeObjectForKey:sn];
+        }
+    }
+    return NO;
 }
 
 @end
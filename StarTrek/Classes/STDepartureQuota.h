@@ -0,0 +1,145 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STDepartureQuota.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+typedef NS_ENUM(NSInteger, STQuotaPolicy) {
+    STQuotaPolicyReject = 0,           // refuse the new ship
+    STQuotaPolicyDropLowestPriority,   // drop the waiting ship with lowest priority
+    STQuotaPolicyDropOldest,           // drop the ship waiting for the longest time
+};
+
+@class STDepartureQuota;
+
+@protocol STDepartureQuotaDelegate <NSObject>
+
+/**
+ *  Callback when the quota crossed the high/low watermark
+ *
+ * @param quota    - departure quota
+ * @param writable - false on high watermark reached, true on low watermark
+ */
+- (void)quota:(STDepartureQuota *)quota changedWritable:(BOOL)writable;
+
+@end
+
+/**
+ *  Departure Quota
+ *  ~~~~~~~~~~~~~~~
+ *
+ *  Limits ships (and bytes) waiting in the departure hall,
+ *  a quota can be chained to a parent (e.g.: docker -> gate),
+ *  ships acquired here will be counted by the parent too.
+ *
+ *  The 'writable' flag (KVO-observable) is cleared when the usage
+ *  reached the high watermark, and set again when it drops down
+ *  to the low watermark, so producers can throttle themselves.
+ *
+ *  The delegate is notified after the quota is unlocked, once for each
+ *  change; the caller holding its own lock should wrap the updates with
+ *  'beginUpdates' & 'endUpdates' to notify after that lock released too.
+ */
+@interface STDepartureQuota : NSObject
+
+@property(nonatomic, assign) NSUInteger maxShips;  // 0 means unlimited
+@property(nonatomic, assign) NSUInteger maxBytes;  // 0 means unlimited
+
+@property(nonatomic, assign) double highWatermark;  // ratio of max, default 1.0
+@property(nonatomic, assign) double lowWatermark;   // ratio of max, default 0.5
+
+@property(nonatomic, readonly) NSUInteger ships;
+@property(nonatomic, readonly) NSUInteger bytes;
+
+@property(nonatomic, readonly, getter=isWritable) BOOL writable;
+
+// usages in this quota will be moved to the new parent
+@property(nonatomic, strong, nullable) STDepartureQuota *parent;
+
+@property(nonatomic, weak, nullable) id<STDepartureQuotaDelegate> delegate;
+
+- (instancetype)initWithMaxShips:(NSUInteger)ships
+                        maxBytes:(NSUInteger)bytes
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Check whether there is room for new ships (parents included)
+ *
+ * @param count - ships count
+ * @param size  - total bytes
+ * @return false on quota exceeded
+ */
+- (BOOL)canAcquireShips:(NSUInteger)count bytes:(NSUInteger)size;
+
+/**
+ *  Take room for new ships if there is enough (parents included),
+ *  checked and taken at once, so concurrent senders never overshoot
+ *
+ * @param count - ships count
+ * @param size  - total bytes
+ * @return false on quota exceeded, nothing taken
+ */
+- (BOOL)tryAcquireShips:(NSUInteger)count bytes:(NSUInteger)size;
+
+/**
+ *  Take room for new ships without checking (parents included)
+ *
+ * @param count - ships count
+ * @param size  - total bytes
+ */
+- (void)acquireShips:(NSUInteger)count bytes:(NSUInteger)size;
+
+/**
+ *  Give back room of finished/failed/dropped ships (parents included)
+ *
+ * @param count - ships count
+ * @param size  - total bytes
+ */
+- (void)releaseShips:(NSUInteger)count bytes:(NSUInteger)size;
+
+/**
+ *  Hold the 'writable' notifications (parents included) until the
+ *  paired 'endUpdates', calls can be nested
+ */
+- (void)beginUpdates;
+
+// deliver the 'writable' changes held since 'beginUpdates'
+- (void)endUpdates;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,270 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STDepartureQuota.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STDepartureQuota.h"
+
+@interface STDepartureQuota () {
+    
+    NSUInteger _ships;
+    NSUInteger _bytes;
+    
+    BOOL _accepting;  // watermark state
+    BOOL _notified;   // watermark state published as 'writable'
+    
+    NSUInteger _updating;  // nested 'beginUpdates'
+    
+    STDepartureQuota *_parent;
+}
+
+@property(nonatomic, assign, getter=isWritable) BOOL writable;
+
+@end
+
+@implementation STDepartureQuota
+
+- (instancetype)init {
+    return [self initWithMaxShips:0 maxBytes:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithMaxShips:(NSUInteger)ships maxBytes:(NSUInteger)bytes {
+    if (self = [super init]) {
+        _maxShips = ships;
+        _maxBytes = bytes;
+        _highWatermark = 1.0;
+        _lowWatermark = 0.5;
+        _ships = 0;
+        _bytes = 0;
+        _accepting = YES;
+        _notified = YES;
+        _updating = 0;
+        _writable = YES;
+        _parent = nil;
+        _delegate = nil;
+    }
+    return self;
+}
+
+- (NSUInteger)ships {
+    @synchronized (self) {
+        return _ships;
+    }
+}
+
+- (NSUInteger)bytes {
+    @synchronized (self) {
+        return _bytes;
+    }
+}
+
+- (STDepartureQuota *)parent {
+    @synchronized (self) {
+        return _parent;
+    }
+}
+
+- (void)setParent:(STDepartureQuota *)parent {
+    STDepartureQuota *old;
+    @synchronized (self) {
+        if (_parent == parent) {
+            return;
+        }
+        old = _parent;
+        // move usages & held updates to the new parent
+        [old releaseShips:_ships bytes:_bytes];
+        [parent acquireShips:_ships bytes:_bytes];
+        for (NSUInteger i = 0; i < _updating; ++i) {
+            [old leaveUpdates];
+            [parent beginUpdates];
+        }
+        _parent = parent;
+    }
+    [old notifyWritable];
+}
+
+- (BOOL)canAcquireShips:(NSUInteger)count bytes:(NSUInteger)size {
+    STDepartureQuota *parent;
+    @synchronized (self) {
+        if (![self hasRoomForShips:count bytes:size]) {
+            return NO;
+        }
+        parent = _parent;
+    }
+    return !parent || [parent canAcquireShips:count bytes:size];
+}
+
+- (BOOL)tryAcquireShips:(NSUInteger)count bytes:(NSUInteger)size {
+    if (![self takeRoomForShips:count bytes:size]) {
+        return NO;
+    }
+    // notify outside the locks
+    [self notifyWritableChain];
+    return YES;
+}
+
+- (void)acquireShips:(NSUInteger)count bytes:(NSUInteger)size {
+    STDepartureQuota *parent;
+    @synchronized (self) {
+        [self takeShips:count bytes:size];
+        parent = _parent;
+    }
+    [parent acquireShips:count bytes:size];
+    [self notifyWritable];
+}
+
+- (void)releaseShips:(NSUInteger)count bytes:(NSUInteger)size {
+    STDepartureQuota *parent;
+    @synchronized (self) {
+        _ships = _ships > count ? _ships - count : 0;
+        _bytes = _bytes > size ? _bytes - size : 0;
+        if (!_accepting && [self reachedLowWatermark]) {
+            _accepting = YES;
+        }
+        parent = _parent;
+    }
+    [parent releaseShips:count bytes:size];
+    [self notifyWritable];
+}
+
+- (void)beginUpdates {
+    @synchronized (self) {
+        ++_updating;
+        [_parent beginUpdates];
+    }
+}
+
+- (void)endUpdates {
+    [self leaveUpdates];
+    // notify outside the locks
+    [self notifyWritableChain];
+}
+
+// private
+- (void)leaveUpdates {
+    @synchronized (self) {
+        NSAssert(_updating > 0, @"quota updates not began");
+        if (_updating > 0) {
+            --_updating;
+        }
+        [_parent leaveUpdates];
+    }
+}
+
+// private
+- (BOOL)takeRoomForShips:(NSUInteger)count bytes:(NSUInteger)size {
+    @synchronized (self) {
+        if (![self hasRoomForShips:count bytes:size]) {
+            return NO;
+        }
+        // the parent is locked inside the child, always in this order
+        if (_parent && ![_parent takeRoomForShips:count bytes:size]) {
+            return NO;
+        }
+        [self takeShips:count bytes:size];
+        return YES;
+    }
+}
+
+// private
+- (BOOL)hasRoomForShips:(NSUInteger)count bytes:(NSUInteger)size {
+    if (_maxShips > 0 && _ships + count > _maxShips) {
+        return NO;
+    }
+    // a ship larger than the limit can still go when the hall is empty
+    if (_maxBytes > 0 && _bytes > 0 && _bytes + size > _maxBytes) {
+        return NO;
+    }
+    return YES;
+}
+
+// private
+- (void)takeShips:(NSUInteger)count bytes:(NSUInteger)size {
+    _ships += count;
+    _bytes += size;
+    if (_accepting && [self reachedHighWatermark]) {
+        _accepting = NO;
+    }
+}
+
+// private
+- (BOOL)reachedHighWatermark {
+    if (_maxShips > 0 && _ships >= _maxShips * _highWatermark) {
+        return YES;
+    }
+    if (_maxBytes > 0 && _bytes >= _maxBytes * _highWatermark) {
+        return YES;
+    }
+    return NO;
+}
+
+// private
+- (BOOL)reachedLowWatermark {
+    if (_maxShips > 0 && _ships > _maxShips * _lowWatermark) {
+        return NO;
+    }
+    if (_maxBytes > 0 && _bytes > _maxBytes * _lowWatermark) {
+        return NO;
+    }
+    return YES;
+}
+
+// private
+- (void)notifyWritable {
+    BOOL accepting;
+    @synchronized (self) {
+        if (_updating > 0 || _notified == _accepting) {
+            // held, or nothing changed since last notified
+            return;
+        }
+        // the transition is taken by this caller only
+        _notified = _accepting;
+        accepting = _accepting;
+    }
+    // notify outside the lock
+    self.writable = accepting;  // KVO
+    [_delegate quota:self changedWritable:accepting];
+}
+
+// private
+- (void)notifyWritableChain {
+    STDepartureQuota *quota = self;
+    while (quota) {
+        [quota notifyWritable];
+        quota = [quota parent];
+    }
+}
+
+@end
@@ -0,0 +1,190 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STDepartureScheduler.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STShip.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Statistics for departures in one priority class
+ */
+@interface STDepartureStatistics : NSObject <NSCopying>
+
+@property(nonatomic, readonly) NSInteger priority;
+
+@property(nonatomic, assign) NSUInteger depth;       // ships waiting now
+@property(nonatomic, assign) NSUInteger maxDepth;
+
+@property(nonatomic, assign) NSUInteger enqueued;    // ships count
+@property(nonatomic, assign) NSUInteger dequeued;    // ships count
+@property(nonatomic, assign) NSUInteger bytes;       // dequeued bytes
+
+@property(nonatomic, assign) NSTimeInterval totalWait;
+@property(nonatomic, assign) NSTimeInterval maxWait;
+
+@property(nonatomic, readonly) NSTimeInterval averageWait;
+
+- (instancetype)initWithPriority:(NSInteger)prior
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+/**
+ *  Departure Scheduler
+ *  ~~~~~~~~~~~~~~~~~~~
+ *
+ *  Decides which new ship in the departure hall goes first
+ */
+@protocol STDepartureScheduler <NSObject>
+
+@property(nonatomic, readonly) NSUInteger count;
+
+/**
+ *  Append a new ship to the class of its priority
+ *
+ * @param ship - departure task
+ * @param size - total bytes of the ship
+ * @param now  - current time
+ */
+- (void)enqueueDeparture:(id<STDeparture>)ship size:(NSUInteger)size time:(NSTimeInterval)now;
+
+/**
+ *  Take the next ship to send out
+ *
+ * @param now - current time
+ * @return nil when empty
+ */
+- (nullable id<STDeparture>)dequeueDepartureWithTime:(NSTimeInterval)now;
+
+/**
+ *  Take the first ship of the highest class out of turn,
+ *  only when that class has higher priority (smaller value)
+ *
+ * @param prior - priority to be preempted
+ * @param now   - current time
+ * @return nil when no ship has higher priority
+ */
+- (nullable id<STDeparture>)dequeueDepartureBeforePriority:(NSInteger)prior
+                                                      time:(NSTimeInterval)now;
+
+/**
+ *  Remove a waiting ship
+ *
+ * @param ship - departure task
+ * @return false when not found
+ */
+- (BOOL)removeDeparture:(id<STDeparture>)ship;
+
+// the last ship in the lowest priority class
+- (nullable id<STDeparture>)lowestDeparture;
+
+// the ship waiting for the longest time
+- (nullable id<STDeparture>)oldestDeparture;
+
+/**
+ *  Get statistics of all priority classes
+ *
+ * @return snapshots sorted by priority
+ */
+- (NSArray<STDepartureStatistics *> *)statistics;
+
+- (void)resetStatistics;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Strict Priority Scheduler
+ *  ~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *  Always serves the class with smallest priority value first,
+ *  ships in the same class are served in order of arrival,
+ *  or by earliest deadline first when 'earliestDeadlineFirst' is set.
+ */
+@interface STPriorityScheduler : NSObject <STDepartureScheduler>
+
+// EDF ordering within a class, ships without deadline go last (default is NO)
+@property(nonatomic, assign) BOOL earliestDeadlineFirst;
+
+@end
+
+// protected
+@interface STPriorityScheduler (Queue)
+
+// sorted priorities of all classes ever seen
+@property(nonatomic, readonly) NSArray<NSNumber *> *priorities;
+
+- (NSUInteger)depthForPriority:(NSInteger)prior;
+
+// size of the first ship in the class
+- (NSUInteger)headSizeForPriority:(NSInteger)prior;
+
+/**
+ *  Choose the class to be served (called when not empty)
+ *
+ * @param now - current time
+ * @return priority of a non-empty class
+ */
+- (NSInteger)nextPriorityWithTime:(NSTimeInterval)now;
+
+@end
+
+/**
+ *  Deficit Round Robin Scheduler
+ *  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *  Serves all classes in turn, each visit gives the class
+ *  'quantum * weight' bytes of credit, the ships are sent
+ *  while the credit is enough, the rest is kept for next round;
+ *  so no class starves, and bandwidth is shared by weights.
+ */
+@interface STDeficitRoundRobinScheduler : STPriorityScheduler
+
+@property(nonatomic, readonly) NSUInteger quantum;  // bytes per round
+
+// weight for classes not set (default is 1)
+@property(nonatomic, assign) NSUInteger defaultWeight;
+
+- (instancetype)initWithQuantum:(NSUInteger)bytes;
+
+- (NSUInteger)weightForPriority:(NSInteger)prior;
+
+- (void)setWeight:(NSUInteger)weight forPriority:(NSInteger)prior;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,467 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STDepartureScheduler.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STDepartureScheduler.h"
+
+@implementation STDepartureStatistics
+
+- (instancetype)init {
+    return [self initWithPriority:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithPriority:(NSInteger)prior {
+    if (self = [super init]) {
+        _priority = prior;
+        _depth = 0;
+        _maxDepth = 0;
+        _enqueued = 0;
+        _dequeued = 0;
+        _bytes = 0;
+        _totalWait = 0;
+        _maxWait = 0;
+    }
+    return self;
+}
+
+- (NSTimeInterval)averageWait {
+    return _dequeued > 0 ? _totalWait / _dequeued : 0;
+}
+
+// Override
+- (id)copyWithZone:(nullable NSZone *)zone {
+    STDepartureStatistics *stat = [[self class] allocWithZone:zone];
+    stat = [stat initWithPriority:_priority];
+    if (stat) {
+        stat.depth = _depth;
+        stat.maxDepth = _maxDepth;
+        stat.enqueued = _enqueued;
+        stat.dequeued = _dequeued;
+        stat.bytes = _bytes;
+        stat.totalWait = _totalWait;
+        stat.maxWait = _maxWait;
+    }
+    return stat;
+}
+
+// Override
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@ priority=%ld depth=%lu/%lu in=%lu out=%lu bytes=%lu wait=%.3f/%.3f />",
+            [self class], _priority, _depth, _maxDepth, _enqueued, _dequeued, _bytes,
+            [self averageWait], _maxWait];
+}
+
+@end
+
+#pragma mark -
+
+@interface __ScheduledShip : NSObject
+
+@property(nonatomic, strong) id<STDeparture> ship;
+@property(nonatomic, assign) NSUInteger size;
+@property(nonatomic, assign) NSTimeInterval time;  // enqueue time
+@property(nonatomic, assign) NSTimeInterval deadline;
+@property(nonatomic, assign) NSUInteger sequence;  // arrival order
+
+@end
+
+@implementation __ScheduledShip
+
+@end
+
+@interface STPriorityScheduler () {
+    
+    NSUInteger _count;
+    NSUInteger _sequence;
+}
+
+// priority => ships in arrival order
+@property(nonatomic, strong) NSMutableDictionary<NSNumber *, NSMutableArray<__ScheduledShip *> *> *queues;
+@property(nonatomic, strong) NSMutableArray<NSNumber *> *sortedPriorities;
+
+// priority => statistics
+@property(nonatomic, strong) NSMutableDictionary<NSNumber *, STDepartureStatistics *> *stats;
+
+// ship => scheduled entry
+@property(nonatomic, strong) NSMapTable<id<STDeparture>, __ScheduledShip *> *entries;
+
+@end
+
+@implementation STPriorityScheduler
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _count = 0;
+        _sequence = 0;
+        _earliestDeadlineFirst = NO;
+        self.queues = [[NSMutableDictionary alloc] init];
+        self.sortedPriorities = [[NSMutableArray alloc] init];
+        self.stats = [[NSMutableDictionary alloc] init];
+        NSPointerFunctionsOptions keyOptions = NSPointerFunctionsStrongMemory
+                                             | NSPointerFunctionsObjectPointerPersonality;
+        self.entries = [NSMapTable mapTableWithKeyOptions:keyOptions
+                                             valueOptions:NSPointerFunctionsStrongMemory];
+    }
+    return self;
+}
+
+// Override
+- (NSUInteger)count {
+    @synchronized (self) {
+        return _count;
+    }
+}
+
+// private
+- (NSMutableArray<__ScheduledShip *> *)queueForPriority:(NSInteger)prior {
+    NSNumber *key = @(prior);
+    NSMutableArray<__ScheduledShip *> *queue = [_queues objectForKey:key];
+    if (!queue) {
+        // create new class for this priority
+        queue = [[NSMutableArray alloc] init];
+        [_queues setObject:queue forKey:key];
+        [_stats setObject:[[STDepartureStatistics alloc] initWithPriority:prior] forKey:key];
+        // insert the priority in a sorted list
+        NSUInteger index = [_sortedPriorities indexOfObject:key
+                                              inSortedRange:NSMakeRange(0, [_sortedPriorities count])
+                                                    options:NSBinarySearchingInsertionIndex
+                                            usingComparator:^NSComparisonResult(NSNumber *a, NSNumber *b) {
+            return [a compare:b];
+        }];
+        [_sortedPriorities insertObject:key atIndex:index];
+    }
+    return queue;
+}
+
+// Override
+- (void)enqueueDeparture:(id<STDeparture>)ship size:(NSUInteger)size time:(NSTimeInterval)now {
+    @synchronized (self) {
+        NSAssert(![_entries objectForKey:ship], @"departure duplicated: %@", ship);
+        __ScheduledShip *entry = [[__ScheduledShip alloc] init];
+        entry.ship = ship;
+        entry.size = size;
+        entry.time = now;
+        entry.sequence = ++_sequence;
+        entry.deadline = STDepartureDeadline(ship);
+        NSInteger prior = [ship priority];
+        NSMutableArray<__ScheduledShip *> *queue = [self queueForPriority:prior];
+        if (_earliestDeadlineFirst && entry.deadline > 0) {
+            // insert after ships with earlier (or same) deadline
+            NSUInteger index = [queue indexOfObject:entry
+                                      inSortedRange:NSMakeRange(0, [queue count])
+                                            options:NSBinarySearchingInsertionIndex|NSBinarySearchingLastEqual
+                                    usingComparator:^NSComparisonResult(__ScheduledShip *a, __ScheduledShip *b) {
+                NSTimeInterval d1 = a.deadline > 0 ? a.deadline : DBL_MAX;
+                NSTimeInterval d2 = b.deadline > 0 ? b.deadline : DBL_MAX;
+                return d1 < d2 ? NSOrderedAscending : (d1 > d2 ? NSOrderedDescending : NSOrderedSame);
+            }];
+            [queue insertObject:entry atIndex:index];
+        } else {
+            [queue addObject:entry];
+        }
+        [_entries setObject:entry forKey:ship];
+        ++_count;
+        // statistics
+        STDepartureStatistics *stat = [_stats objectForKey:@(prior)];
+        stat.enqueued += 1;
+        stat.depth = [queue count];
+        if (stat.maxDepth < stat.depth) {
+            stat.maxDepth = stat.depth;
+        }
+    }
+}
+
+// Override
+- (nullable id<STDeparture>)dequeueDepartureWithTime:(NSTimeInterval)now {
+    @synchronized (self) {
+        if (_count == 0) {
+            return nil;
+        }
+        return [self dequeueFromPriority:[self nextPriorityWithTime:now] time:now];
+    }
+}
+
+// Override
+- (nullable id<STDeparture>)dequeueDepartureBeforePriority:(NSInteger)prior
+                                                      time:(NSTimeInterval)now {
+    @synchronized (self) {
+        for (NSNumber *key in _sortedPriorities) {
+            if ([key integerValue] >= prior) {
+                break;
+            }
+            if ([[_queues objectForKey:key] count] > 0) {
+                return [self dequeueFromPriority:[key integerValue] time:now];
+            }
+        }
+        return nil;
+    }
+}
+
+// private
+- (id<STDeparture>)dequeueFromPriority:(NSInteger)prior time:(NSTimeInterval)now {
+    // called inside the lock
+    NSMutableArray<__ScheduledShip *> *queue = [_queues objectForKey:@(prior)];
+    __ScheduledShip *entry = [queue firstObject];
+    NSAssert(entry, @"priority class empty: %ld", prior);
+    [queue removeObjectAtIndex:0];
+    [_entries removeObjectForKey:entry.ship];
+    --_count;
+    // statistics
+    STDepartureStatistics *stat = [_stats objectForKey:@(prior)];
+    NSTimeInterval wait = now > entry.time ? now - entry.time : 0;
+    stat.depth = [queue count];
+    stat.dequeued += 1;
+    stat.bytes += entry.size;
+    stat.totalWait += wait;
+    if (stat.maxWait < wait) {
+        stat.maxWait = wait;
+    }
+    return entry.ship;
+}
+
+// Override
+- (BOOL)removeDeparture:(id<STDeparture>)ship {
+    @synchronized (self) {
+        __ScheduledShip *entry = [_entries objectForKey:ship];
+        if (!entry) {
+            return NO;
+        }
+        NSInteger prior = [ship priority];
+        NSMutableArray<__ScheduledShip *> *queue = [_queues objectForKey:@(prior)];
+        [queue removeObjectIdenticalTo:entry];
+        [_entries removeObjectForKey:ship];
+        --_count;
+        STDepartureStatistics *stat = [_stats objectForKey:@(prior)];
+        stat.depth = [queue count];
+        return YES;
+    }
+}
+
+// Override
+- (nullable id<STDeparture>)lowestDeparture {
+    @synchronized (self) {
+        NSMutableArray<__ScheduledShip *> *queue;
+        for (NSNumber *prior in [_sortedPriorities reverseObjectEnumerator]) {
+            queue = [_queues objectForKey:prior];
+            if ([queue count] > 0) {
+                return [[queue lastObject] ship];
+            }
+        }
+        return nil;
+    }
+}
+
+// Override
+- (nullable id<STDeparture>)oldestDeparture {
+    @synchronized (self) {
+        __ScheduledShip *oldest = nil;
+        __ScheduledShip *head;
+        for (NSMutableArray<__ScheduledShip *> *queue in [_queues allValues]) {
+            if (_earliestDeadlineFirst) {
+                // not in arrival order, check all
+                for (head in queue) {
+                    if (!oldest || head.sequence < oldest.sequence) {
+                        oldest = head;
+                    }
+                }
+                continue;
+            }
+            // ships in each class are in arrival order,
+            // so the oldest one must be one of the heads
+            head = [queue firstObject];
+            if (head && (!oldest || head.sequence < oldest.sequence)) {
+                oldest = head;
+            }
+        }
+        return [oldest ship];
+    }
+}
+
+// Override
+- (NSArray<STDepartureStatistics *> *)statistics {
+    @synchronized (self) {
+        NSMutableArray<STDepartureStatistics *> *array;
+        array = [[NSMutableArray alloc] initWithCapacity:[_sortedPriorities count]];
+        for (NSNumber *prior in _sortedPriorities) {
+            [array addObject:[[_stats objectForKey:prior] copy]];
+        }
+        return array;
+    }
+}
+
+// Override
+- (void)resetStatistics {
+    @synchronized (self) {
+        // replace on a copy, mutating while enumerating is not allowed
+        NSDictionary<NSNumber *, STDepartureStatistics *> *stats = [_stats copy];
+        [stats enumerateKeysAndObjectsUsingBlock:^(NSNumber *prior, STDepartureStatistics *old, BOOL *stop) {
+            STDepartureStatistics *stat = [[STDepartureStatistics alloc] initWithPriority:[prior integerValue]];
+            stat.depth = old.depth;
+            stat.maxDepth = old.depth;
+            [self->_stats setObject:stat forKey:prior];
+        }];
+    }
+}
+
+@end
+
+@implementation STPriorityScheduler (Queue)
+
+- (NSArray<NSNumber *> *)priorities {
+    return _sortedPriorities;
+}
+
+- (NSUInteger)depthForPriority:(NSInteger)prior {
+    return [[_queues objectForKey:@(prior)] count];
+}
+
+- (NSUInteger)headSizeForPriority:(NSInteger)prior {
+    return [[[_queues objectForKey:@(prior)] firstObject] size];
+}
+
+- (NSInteger)nextPriorityWithTime:(NSTimeInterval)now {
+    // strict priority: first non-empty class
+    for (NSNumber *prior in _sortedPriorities) {
+        if ([[_queues objectForKey:prior] count] > 0) {
+            return [prior integerValue];
+        }
+    }
+    NSAssert(false, @"scheduler empty");
+    return 0;
+}
+
+@end
+
+#pragma mark -
+
+@interface STDeficitRoundRobinScheduler () {
+    
+    NSUInteger _cursor;  // index of current class in priorities
+    BOOL _visiting;      // whether credit granted for current class
+}
+
+// priority => weight
+@property(nonatomic, strong) NSMutableDictionary<NSNumber *, NSNumber *> *weights;
+
+// priority => remaining credit (bytes)
+@property(nonatomic, strong) NSMutableDictionary<NSNumber *, NSNumber *> *deficits;
+
+@end
+
+@implementation STDeficitRoundRobinScheduler
+
+- (instancetype)init {
+    return [self initWithQuantum:ST_MSS];
+}
+
+- (instancetype)initWithQuantum:(NSUInteger)bytes {
+    if (self = [super init]) {
+        _quantum = MAX(bytes, 1);
+        _defaultWeight = 1;
+        _cursor = 0;
+        _visiting = NO;
+        // urgent : normal : slower = 4 : 2 : 1
+        self.weights = [@{
+            @(STDeparturePriorityUrgent): @4,
+            @(STDeparturePriorityNormal): @2,
+            @(STDeparturePrioritySlower): @1,
+        } mutableCopy];
+        self.deficits = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (NSUInteger)weightForPriority:(NSInteger)prior {
+    @synchronized (self) {
+        NSNumber *weight = [_weights objectForKey:@(prior)];
+        return weight ? [weight unsignedIntegerValue] : _defaultWeight;
+    }
+}
+
+- (void)setWeight:(NSUInteger)weight forPriority:(NSInteger)prior {
+    @synchronized (self) {
+        [_weights setObject:@(MAX(weight, 1)) forKey:@(prior)];
+    }
+}
+
+// Override
+- (NSInteger)nextPriorityWithTime:(NSTimeInterval)now {
+    NSArray<NSNumber *> *priorities = [self priorities];
+    NSUInteger total = [priorities count];
+    NSAssert(total > 0, @"scheduler empty");
+    NSNumber *prior;
+    NSInteger value;
+    NSUInteger deficit, size;
+    while (YES) {
+        if (_cursor >= total) {
+            _cursor = 0;
+        }
+        prior = [priorities objectAtIndex:_cursor];
+        value = [prior integerValue];
+        if ([self depthForPriority:value] == 0) {
+            // idle class keeps no credit
+            [_deficits removeObjectForKey:prior];
+            _visiting = NO;
+            ++_cursor;
+            continue;
+        }
+        deficit = [[_deficits objectForKey:prior] unsignedIntegerValue];
+        if (!_visiting) {
+            // new round for this class
+            deficit += _quantum * [self weightForPriority:value];
+            _visiting = YES;
+        }
+        size = [self headSizeForPriority:value];
+        if (size <= deficit) {
+            deficit -= size;
+            if ([self depthForPriority:value] > 1) {
+                [_deficits setObject:@(deficit) forKey:prior];
+            } else {
+                // class will be empty, move on
+                [_deficits removeObjectForKey:prior];
+                _visiting = NO;
+                ++_cursor;
+            }
+            return value;
+        }
+        // not enough credit, keep it for next round
+        [_deficits setObject:@(deficit) forKey:prior];
+        _visiting = NO;
+        ++_cursor;
+    }
+}
+
+@end
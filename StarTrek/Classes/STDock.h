@@ -41,6 +41,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface STDock : NSObject
 
+@property(nonatomic, strong, readonly) STArrivalHall *arrivalHall;
+@property(nonatomic, strong, readonly) STDepartureHall *departureHall;
+
 // protected
 - (STArrivalHall *)createArrivalHall;
 
@@ -55,6 +58,8 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (id<STArrival>)assembleArrival:(id<STArrival>)income;
 
+- (id<STArrival>)assembleArrival:(id<STArrival>)income time:(NSTimeInterval)now;
+
 /**
  *  Add outgoing ship to the waiting queue
  *
@@ -63,6 +68,8 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)addDeparture:(id<STDeparture>)outgo;
 
+- (BOOL)addDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now;
+
 /**
  *  Check response from incoming ship
  *
@@ -71,6 +78,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response;
 
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response time:(NSTimeInterval)now;
+
+/**
+ *  Check responses from incoming ships
+ *
+ * @param responses - incoming ships with SN (or cumulative acks)
+ * @return finished tasks
+ */
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses;
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses
+                                                  time:(NSTimeInterval)now;
+
 /**
  *  Get next new/timeout task
  *
@@ -80,12 +100,36 @@ NS_ASSUME_NONNULL_BEGIN
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now;
 
 /**
- * Clear all expired tasks
+ *  Get new task with higher priority for preempting
+ *
+ * @param prior - priority to be preempted
+ * @param now   - current time
+ * @return nil when no new task has higher priority
+ */
+- (nullable id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior
+                                                   time:(NSTimeInterval)now;
+
+/**
+ * Clear expired tasks with the default budget
  */
 - (void)purge;
 
+/**
+ *  Clear expired tasks, resume from where last call stopped
+ *
+ * @param now    - current time
+ * @param budget - max entries/time shared by both halls
+ * @return true when a whole round finished
+ */
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget;
+
 @end
 
+/**
+ *  Thread-safe dock, a new purge round starts
+ *  at most every 30 seconds after the last one finished,
+ *  quota delegates are notified after the dock unlocked
+ */
 @interface STLockedDock : STDock
 
 @end
@@ -34,6 +34,8 @@
 //  Created by Albert Moky on 2023/3/9.
 //
 
+#import <ObjectKey/ObjectKey.h>
+
 #import "STDock.h"
 
 @interface STDock ()
@@ -64,19 +66,40 @@
 }
 
 - (id<STArrival>)assembleArrival:(id<STArrival>)income {
+    return [self assembleArrival:income time:OKGetCurrentTimeInterval()];
+}
+
+- (id<STArrival>)assembleArrival:(id<STArrival>)income time:(NSTimeInterval)now {
     // check fragment from income ship,
     // return a ship with completed package if all fragments received
-    return [_arrivalHall assembleArrival:income];
+    return [_arrivalHall assembleArrival:income time:now];
 }
 
 - (BOOL)addDeparture:(id<STDeparture>)outgo {
-    return [_departureHall addDeparture:outgo];
+    return [self addDeparture:outgo time:OKGetCurrentTimeInterval()];
+}
+
+- (BOOL)addDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now {
+    return [_departureHall addDeparture:outgo time:now];
 }
 
 - (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response {
+    return [self checkResponseInArrival:response time:OKGetCurrentTimeInterval()];
+}
+
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response time:(NSTimeInterval)now {
     // check departure tasks with SN
     // remove package/fragment if matched (check page index for fragments too)
-    return [_departureHall checkResponseInArrival:response];
+    return [_departureHall checkResponseInArrival:response time:now];
+}
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses {
+    return [self checkResponsesInArrivals:responses time:OKGetCurrentTimeInterval()];
+}
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses
+                                                  time:(NSTimeInterval)now {
+    return [_departureHall checkResponsesInArrivals:responses time:now];
 }
 
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now {
@@ -85,45 +108,124 @@
     return [_departureHall nextDepartureWithTime:now];
 }
 
+- (id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior time:(NSTimeInterval)now {
+    return [_departureHall nextDepartureBeforePriority:prior time:now];
+}
+
 - (void)purge {
-    [_arrivalHall purge];
-    [_departureHall purge];
+    [self purgeWithTime:OKGetCurrentTimeInterval() budget:[STPurgeBudget budget]];
+}
+
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget {
+    BOOL done = [_arrivalHall purgeWithTime:now budget:budget];
+    if ([_departureHall purgeWithTime:now budget:budget]) {
+        return done;
+    }
+    return NO;
 }
 
 @end
 
 #pragma mark -
 
+static const NSTimeInterval DOCK_PURGE_INTERVAL = 30.0;
+
+@interface STLockedDock () {
+
+    NSTimeInterval _nextPurgeTime;  // when to start next round
+}
+
+@end
+
 @implementation STLockedDock
 
-- (id<STArrival>)assembleArrival:(id<STArrival>)income {
+- (instancetype)init {
+    if (self = [super init]) {
+        _nextPurgeTime = 0;
+    }
+    return self;
+}
+
+- (id<STArrival>)assembleArrival:(id<STArrival>)income time:(NSTimeInterval)now {
     @synchronized (self) {
-        return [super assembleArrival:income];
+        return [super assembleArrival:income time:now];
     }
 }
 
-- (BOOL)addDeparture:(id<STDeparture>)outgo {
+// quota delegates will be notified after the dock unlocked
+- (BOOL)addDeparture:(id<STDeparture>)outgo time:(NSTimeInterval)now {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    BOOL ok;
+    [quota beginUpdates];
     @synchronized (self) {
-        return [super addDeparture:outgo];
+        ok = [super addDeparture:outgo time:now];
     }
+    [quota endUpdates];
+    return ok;
 }
 
-- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response {
+- (id<STDeparture>)checkResponseInArrival:(id<STArrival>)response time:(NSTimeInterval)now {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    id<STDeparture> finished;
+    [quota beginUpdates];
+    @synchronized (self) {
+        finished = [super checkResponseInArrival:response time:now];
+    }
+    [quota endUpdates];
+    return finished;
+}
+
+- (NSArray<id<STDeparture>> *)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses
+                                                  time:(NSTimeInterval)now {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    NSArray<id<STDeparture>> *finished;
+    [quota beginUpdates];
     @synchronized (self) {
-        return [super checkResponseInArrival:response];
+        finished = [super checkResponsesInArrivals:responses time:now];
     }
+    [quota endUpdates];
+    return finished;
 }
 
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    id<STDeparture> outgo;
+    [quota beginUpdates];
     @synchronized (self) {
-        return [super nextDepartureWithTime:now];
+        outgo = [super nextDepartureWithTime:now];
     }
+    [quota endUpdates];
+    return outgo;
 }
 
-- (void)purge {
+- (id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior time:(NSTimeInterval)now {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    id<STDeparture> outgo;
+    [quota beginUpdates];
+    @synchronized (self) {
+        outgo = [super nextDepartureBeforePriority:prior time:now];
+    }
+    [quota endUpdates];
+    return outgo;
+}
+
+- (BOOL)purgeWithTime:(NSTimeInterval)now budget:(STPurgeBudget *)budget {
+    STDepartureQuota *quota = [[self departureHall] quota];
+    BOOL done;
+    [quota beginUpdates];
     @synchronized (self) {
-        [super purge];
+        if (now < _nextPurgeTime) {
+            // last round finished not long ago
+            done = YES;
+        } else {
+            done = [super purgeWithTime:now budget:budget];
+            if (done) {
+                _nextPurgeTime = now + DOCK_PURGE_INTERVAL;
+            }
+        }
     }
+    [quota endUpdates];
+    return done;
 }
 
 @end
@@ -0,0 +1,157 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STFrameDecoder.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Stream Frame Decoder
+ *  ~~~~~~~~~~~~~~~~~~~~
+ *
+ *  Keeps received bytes of a connection and cuts them into frames,
+ *  all complete frames in one read will be returned at once,
+ *  the leftover bytes are kept for the next read.
+ */
+@protocol STFrameDecoder <NSObject>
+
+// bytes waiting for more data
+@property(nonatomic, readonly) NSUInteger bufferedLength;
+
+/**
+ *  Append received data and get all complete frames
+ *
+ * @param data - received data
+ * @return complete frames, empty when waiting for more data
+ */
+- (NSArray<NSData *> *)decodeData:(NSData *)data;
+
+/**
+ *  Drop all buffered bytes
+ */
+- (void)reset;
+
+@end
+
+/**
+ *  Base decoder with a reassembly buffer,
+ *  subclass only needs to find the frame boundary
+ */
+@interface STFrameDecoder : NSObject <STFrameDecoder>
+
+// frames longer than this will be dropped with the buffer (default is 16 MB),
+// 0 means unlimited, which lets a hostile peer make the buffer grow
+@property(nonatomic, assign) NSUInteger maxFrameLength;
+
+// frames dropped for too large or corrupted
+@property(nonatomic, readonly) NSUInteger droppedFrames;
+
+// set when the stream cannot be framed anymore (until reset),
+// received data will be dropped, the connection should be closed then
+@property(nonatomic, readonly, getter=isCorrupted) BOOL corrupted;
+
+- (instancetype)initWithMaxFrameLength:(NSUInteger)max
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+// protected
+@interface STFrameDecoder (Boundary)
+
+/**
+ *  Find the first frame in the buffered bytes
+ *
+ * @param bytes    - buffered bytes
+ * @param length   - buffered length
+ * @param frame    - range of the frame content
+ * @param consumed - bytes consumed by the frame (headers/delimiters included)
+ * @return false on waiting for more data
+ */
+- (BOOL)findFrameInBytes:(const UInt8 *)bytes length:(NSUInteger)length
+                   range:(NSRange *)frame consumed:(NSUInteger *)consumed;
+
+// called when a frame is dropped
+- (void)frameDropped;
+
+// called when the stream is corrupted
+- (void)streamCorrupted;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Length-Field Frame Decoder
+ *
+ *      +------------+--------+---------------------+
+ *      |   offset   | length |       payload       |
+ *      +------------+--------+---------------------+
+ *
+ *  total = lengthOffset + fieldLength + value(length) + lengthAdjustment
+ */
+@interface STLengthFieldFrameDecoder : STFrameDecoder
+
+@property(nonatomic, readonly) NSUInteger fieldLength;  // 1, 2, 4 or 8 bytes (network order)
+
+@property(nonatomic, assign) NSUInteger lengthOffset;   // default is 0
+@property(nonatomic, assign) NSInteger lengthAdjustment;  // default is 0
+
+// return payload only (default is YES)
+@property(nonatomic, assign) BOOL stripsHeader;
+
+- (instancetype)initWithFieldLength:(NSUInteger)size
+                     maxFrameLength:(NSUInteger)max;
+
+@end
+
+/**
+ *  Delimiter Frame Decoder
+ *
+ *      'line 1' CR LF 'line 2' CR LF ...
+ */
+@interface STDelimiterFrameDecoder : STFrameDecoder
+
+@property(nonatomic, readonly) NSData *delimiter;
+
+// remove the delimiter from frames (default is YES)
+@property(nonatomic, assign) BOOL stripsDelimiter;
+
+- (instancetype)initWithDelimiter:(NSData *)delimiter
+                   maxFrameLength:(NSUInteger)max;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,431 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STFrameDecoder.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STFrameDecoder.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DELIMITER_SEARCH_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define DELIMITER_SEARCH_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DELIMITER_SEARCH_NEON 1
+#endif
+
+// byte by byte, for short input and the tail
+static inline const UInt8 *scalar_search(const UInt8 *bytes, NSUInteger length,
+                                         const UInt8 *pattern, NSUInteger size) {
+    if (length < size) {
+        return NULL;
+    }
+    const UInt8 *end = bytes + length - size + 1;
+    const UInt8 *p = bytes;
+    while (p < end) {
+        p = memchr(p, pattern[0], end - p);
+        if (!p) {
+            return NULL;
+        } else if (memcmp(p, pattern, size) == 0) {
+            return p;
+        }
+        ++p;
+    }
+    return NULL;
+}
+
+/**
+ *  Find the first position of pattern in the bytes,
+ *  compares the first and last bytes of pattern for 16/32 positions at once
+ *  (SSE2/AVX2/NEON), then confirms the middle bytes.
+ */
+static inline const UInt8 *delimiter_search(const UInt8 *bytes, NSUInteger length,
+                                            const UInt8 *pattern, NSUInteger size) {
+    if (size == 0 || length < size) {
+        return NULL;
+    } else if (size == 1) {
+        // libc memchr is vectorised already
+        return memchr(bytes, pattern[0], length);
+    }
+    NSUInteger last = size - 1;
+    NSUInteger count = length - last;  // candidate positions
+    NSUInteger i = 0;
+#if DELIMITER_SEARCH_AVX2
+    __m256i head = _mm256_set1_epi8((char)pattern[0]);
+    __m256i tail = _mm256_set1_epi8((char)pattern[last]);
+    for (; i + 32 <= count; i += 32) {
+        __m256i b0 = _mm256_loadu_si256((const __m256i *)(bytes + i));
+        __m256i b1 = _mm256_loadu_si256((const __m256i *)(bytes + i + last));
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(b0, head), _mm256_cmpeq_epi8(b1, tail));
+        UInt32 mask = (UInt32)_mm256_movemask_epi8(eq);
+        while (mask) {
+            const UInt8 *p = bytes + i + __builtin_ctz(mask);
+            if (size <= 2 || memcmp(p + 1, pattern + 1, size - 2) == 0) {
+                return p;
+            }
+            mask &= mask - 1;
+        }
+    }
+#elif DELIMITER_SEARCH_SSE2
+    __m128i head = _mm_set1_epi8((char)pattern[0]);
+    __m128i tail = _mm_set1_epi8((char)pattern[last]);
+    for (; i + 16 <= count; i += 16) {
+        __m128i b0 = _mm_loadu_si128((const __m128i *)(bytes + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i *)(bytes + i + last));
+        __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(b0, head), _mm_cmpeq_epi8(b1, tail));
+        UInt32 mask = (UInt32)_mm_movemask_epi8(eq);
+        while (mask) {
+            const UInt8 *p = bytes + i + __builtin_ctz(mask);
+            if (size <= 2 || memcmp(p + 1, pattern + 1, size - 2) == 0) {
+                return p;
+            }
+            mask &= mask - 1;
+        }
+    }
+#elif DELIMITER_SEARCH_NEON
+    uint8x16_t head = vdupq_n_u8(pattern[0]);
+    uint8x16_t tail = vdupq_n_u8(pattern[last]);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(bytes + i), head),
+                                 vceqq_u8(vld1q_u8(bytes + i + last), tail));
+        // 4 bits for each byte
+        UInt64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            unsigned bit = __builtin_ctzll(mask);
+            const UInt8 *p = bytes + i + (bit >> 2);
+            if (size <= 2 || memcmp(p + 1, pattern + 1, size - 2) == 0) {
+                return p;
+            }
+            mask &= ~(0xFULL << (bit & ~3U));
+        }
+    }
+#endif
+    // the rest
+    return scalar_search(bytes + i, length - i, pattern, size);
+}
+
+// max frame length by default
+static const NSUInteger FRAME_DECODER_MAX_LENGTH = 16 * 1024 * 1024;  // 16 MB
+
+@interface STFrameDecoder () {
+    
+    NSMutableData *_buffer;  // leftover bytes
+    NSUInteger _skipping;    // bytes of dropped frame still to come
+}
+
+@end
+
+@implementation STFrameDecoder
+
+- (instancetype)init {
+    return [self initWithMaxFrameLength:FRAME_DECODER_MAX_LENGTH];
+}
+
+/* designated initializer */
+- (instancetype)initWithMaxFrameLength:(NSUInteger)max {
+    if (self = [super init]) {
+        _maxFrameLength = max;
+        _buffer = [[NSMutableData alloc] init];
+        _skipping = 0;
+        _droppedFrames = 0;
+        _corrupted = NO;
+    }
+    return self;
+}
+
+- (NSUInteger)droppedFrames {
+    @synchronized (self) {
+        return _droppedFrames;
+    }
+}
+
+- (BOOL)isCorrupted {
+    @synchronized (self) {
+        return _corrupted;
+    }
+}
+
+// Override
+- (NSUInteger)bufferedLength {
+    @synchronized (self) {
+        return [_buffer length];
+    }
+}
+
+// Override
+- (void)reset {
+    @synchronized (self) {
+        [_buffer setLength:0];
+        _skipping = 0;
+        _corrupted = NO;
+    }
+}
+
+// Override
+- (NSArray<NSData *> *)decodeData:(NSData *)data {
+    NSMutableArray<NSData *> *frames = [[NSMutableArray alloc] init];
+    @synchronized (self) {
+        if (_corrupted) {
+            // cannot find frame boundary anymore
+            return @[];
+        }
+        NSData *source = data;
+        NSUInteger pos = 0;
+        if ([_buffer length] > 0) {
+            // join with the leftover bytes
+            [_buffer appendData:data];
+            source = _buffer;
+        } else if (_skipping > 0) {
+            // drop the rest of a large frame
+            pos = MIN(_skipping, [data length]);
+            _skipping -= pos;
+        }
+        const UInt8 *bytes = [source bytes];
+        NSUInteger total = [source length];
+        NSRange frame;
+        NSUInteger consumed;
+        while (pos < total) {
+            frame = NSMakeRange(NSNotFound, 0);
+            consumed = 0;
+            if (![self findFrameInBytes:(bytes + pos) length:(total - pos)
+                                  range:&frame consumed:&consumed]) {
+                // waiting for more data
+                break;
+            }
+            NSAssert(consumed > 0, @"frame decoder error: %@", self);
+            if (frame.location != NSNotFound) {
+                frame.location += pos;
+                [frames addObject:[source subdataWithRange:frame]];
+            }
+            if (consumed > total - pos) {
+                // frame dropped, but not all bytes arrived
+                _skipping = consumed - (total - pos);
+                pos = total;
+                break;
+            }
+            pos += consumed;
+            if (_corrupted) {
+                // drop the rest
+                pos = total;
+                break;
+            }
+        }
+        // keep leftover bytes
+        if (source == _buffer) {
+            [_buffer replaceBytesInRange:NSMakeRange(0, pos) withBytes:NULL length:0];
+        } else if (pos < total) {
+            [_buffer appendBytes:(bytes + pos) length:(total - pos)];
+        }
+    }
+    return frames;
+}
+
+@end
+
+@implementation STFrameDecoder (Boundary)
+
+- (BOOL)findFrameInBytes:(const UInt8 *)bytes length:(NSUInteger)length
+                   range:(NSRange *)frame consumed:(NSUInteger *)consumed {
+    NSAssert(false, @"override me!");
+    return NO;
+}
+
+- (void)frameDropped {
+    ++_droppedFrames;
+}
+
+- (void)streamCorrupted {
+    ++_droppedFrames;
+    _corrupted = YES;
+}
+
+@end
+
+#pragma mark -
+
+@implementation STLengthFieldFrameDecoder
+
+- (instancetype)initWithMaxFrameLength:(NSUInteger)max {
+    return [self initWithFieldLength:4 maxFrameLength:max];
+}
+
+- (instancetype)initWithFieldLength:(NSUInteger)size
+                     maxFrameLength:(NSUInteger)max {
+    NSAssert(size == 1 || size == 2 || size == 4 || size == 8, @"length field error: %lu", size);
+    if (self = [super initWithMaxFrameLength:max]) {
+        _fieldLength = size;
+        _lengthOffset = 0;
+        _lengthAdjustment = 0;
+        _stripsHeader = YES;
+    }
+    return self;
+}
+
+// Override
+- (BOOL)findFrameInBytes:(const UInt8 *)bytes length:(NSUInteger)length
+                   range:(NSRange *)frame consumed:(NSUInteger *)consumed {
+    NSUInteger header = _lengthOffset + _fieldLength;
+    if (length < header) {
+        // waiting for header
+        return NO;
+    }
+    // read length in network order
+    UInt64 value = 0;
+    const UInt8 *field = bytes + _lengthOffset;
+    for (NSUInteger i = 0; i < _fieldLength; ++i) {
+        value = (value << 8) | field[i];
+    }
+    SInt64 body;
+    if (value > INT64_MAX ||
+        (_lengthAdjustment > 0 && (SInt64)value > INT64_MAX - _lengthAdjustment)) {
+        // overflow
+        body = -1;
+    } else {
+        body = (SInt64)value + _lengthAdjustment;
+    }
+    if (body < 0 || (UInt64)body > NSUIntegerMax - header) {
+        // corrupted stream, drop all
+        [self streamCorrupted];
+        *consumed = length;
+        return YES;
+    }
+    NSUInteger size = header + (NSUInteger)body;
+    NSUInteger max = [self maxFrameLength];
+    if (max > 0 && (UInt64)body > max) {
+        // too large, drop it
+        [self frameDropped];
+        *consumed = size;
+        return YES;
+    } else if (length < size) {
+        // waiting for payload
+        return NO;
+    }
+    if (_stripsHeader) {
+        *frame = NSMakeRange(header, (NSUInteger)body);
+    } else {
+        *frame = NSMakeRange(0, size);
+    }
+    *consumed = size;
+    return YES;
+}
+
+@end
+
+#pragma mark -
+
+@interface STDelimiterFrameDecoder () {
+    
+    BOOL _discarding;    // dropping a frame too large
+    NSUInteger _scanned; // bytes of pending frame searched already
+}
+
+@end
+
+@implementation STDelimiterFrameDecoder
+
+- (instancetype)initWithMaxFrameLength:(NSUInteger)max {
+    UInt8 lf = '\n';
+    NSData *delimiter = [[NSData alloc] initWithBytes:&lf length:1];
+    return [self initWithDelimiter:delimiter maxFrameLength:max];
+}
+
+- (instancetype)initWithDelimiter:(NSData *)delimiter
+                   maxFrameLength:(NSUInteger)max {
+    NSAssert([delimiter length] > 0, @"delimiter empty");
+    if (self = [super initWithMaxFrameLength:max]) {
+        _delimiter = [delimiter copy];
+        _stripsDelimiter = YES;
+        _discarding = NO;
+        _scanned = 0;
+    }
+    return self;
+}
+
+// Override
+- (void)reset {
+    @synchronized (self) {
+        [super reset];
+        _discarding = NO;
+        _scanned = 0;
+    }
+}
+
+// Override
+- (BOOL)findFrameInBytes:(const UInt8 *)bytes length:(NSUInteger)length
+                   range:(NSRange *)frame consumed:(NSUInteger *)consumed {
+    NSUInteger size = [_delimiter length];
+    NSUInteger max = [self maxFrameLength];
+    // the pending frame starts at 'bytes', continue from last scanned position,
+    // so each byte is inspected only once across partial reads
+    NSUInteger from = MIN(_scanned, length);
+    const UInt8 *found = delimiter_search(bytes + from, length - from, [_delimiter bytes], size);
+    if (!found) {
+        if (length < size) {
+            // waiting for more data
+            return NO;
+        }
+        // positions before this have no delimiter
+        _scanned = length - size + 1;
+        if (_discarding || (max > 0 && length > max + size)) {
+            // too large, drop it until the next delimiter,
+            // keep the tail which may be a part of delimiter
+            if (!_discarding) {
+                [self frameDropped];
+            }
+            _discarding = YES;
+            *consumed = _scanned;
+            _scanned = 0;
+            return YES;
+        }
+        return NO;
+    }
+    // next frame starts after this delimiter
+    _scanned = 0;
+    NSUInteger end = found - bytes;
+    *consumed = end + size;
+    if (_discarding) {
+        // end of the dropped frame
+        _discarding = NO;
+    } else if (max > 0 && end > max) {
+        // too large, drop it
+        [self frameDropped];
+    } else {
+        *frame = NSMakeRange(0, _stripsDelimiter ? end : end + size);
+    }
+    return YES;
+}
+
+@end
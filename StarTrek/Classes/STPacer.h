@@ -0,0 +1,252 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPacer.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STShip.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Token Bucket
+ *  ~~~~~~~~~~~~
+ *
+ *  Limits the sending rate to 'rate' bytes per second,
+ *  bursts are allowed up to 'capacity' bytes.
+ */
+@interface STTokenBucket : NSObject
+
+@property(nonatomic, assign) double rate;      // bytes per second
+@property(nonatomic, assign) double capacity;  // max burst (bytes)
+
+@property(nonatomic, readonly) double tokens;  // available bytes
+
+- (instancetype)initWithRate:(double)bytesPerSecond
+                    capacity:(double)burst
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Check tokens for sending data
+ *
+ * @param length - data length
+ * @param now    - current time
+ * @return false when no enough tokens now
+ */
+- (BOOL)hasTokensForLength:(NSUInteger)length time:(NSTimeInterval)now;
+
+/**
+ *  Take tokens for data sent (the tokens may be in debt after that)
+ *
+ * @param length - sent length
+ * @param now    - current time
+ */
+- (void)takeTokensForLength:(NSUInteger)length time:(NSTimeInterval)now;
+
+/**
+ *  Take tokens for sending data
+ *
+ * @param length - data length
+ * @param now    - current time
+ * @return false when no enough tokens now
+ */
+- (BOOL)consumeLength:(NSUInteger)length time:(NSTimeInterval)now;
+
+/**
+ *  Give back tokens taken for data not written
+ *
+ * @param length - data length
+ */
+- (void)returnTokensForLength:(NSUInteger)length;
+
+@end
+
+/**
+ *  Congestion Window
+ *  ~~~~~~~~~~~~~~~~~
+ *
+ *  Limits bytes sent but not responded yet:
+ *      1. slow start: window grows by the acked length until 'threshold';
+ *      2. congestion avoidance: window grows by one segment per window acked;
+ *      3. on loss: threshold = window / 2, and window shrinks to threshold.
+ */
+@interface STCongestionWindow : NSObject
+
+@property(nonatomic, readonly) NSUInteger window;     // bytes
+@property(nonatomic, readonly) NSUInteger threshold;  // slow start threshold
+@property(nonatomic, readonly) NSUInteger inflight;   // bytes waiting for responses
+
+@property(nonatomic, assign) NSUInteger segmentSize;  // MSS
+@property(nonatomic, assign) NSUInteger minWindow;
+@property(nonatomic, assign) NSUInteger maxWindow;
+
+- (instancetype)initWithWindow:(NSUInteger)initial
+                   segmentSize:(NSUInteger)mss
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Check whether the window has space for sending data
+ *  (always true when nothing in flight)
+ *
+ * @param length - data length
+ * @return false on window full
+ */
+- (BOOL)canSendLength:(NSUInteger)length;
+
+- (void)sentLength:(NSUInteger)length;
+
+- (void)ackedLength:(NSUInteger)length;
+
+- (void)lostLength:(NSUInteger)length;
+
+// release bytes without adjusting the window (task failed)
+- (void)releaseLength:(NSUInteger)length;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Departure Pacer
+ *  ~~~~~~~~~~~~~~~
+ *
+ *  Sits between the dock and the connection of a docker,
+ *  decides whether the next fragment can be sent now.
+ *
+ *  The token bucket limits the sending rate of all fragments,
+ *  the congestion window limits fragments of important ships only,
+ *  because disposable ships will never be responded.
+ *
+ *  Bytes of a fragment are released from the window when the fragment
+ *  is responded, that is, when it is no longer in the departure's
+ *  'fragments' (so departures should keep the same data objects for
+ *  fragments remaining); the whole ship is released when finished.
+ */
+@interface STPacer : NSObject
+
+@property(nonatomic, strong, readonly, nullable) STTokenBucket *bucket;
+@property(nonatomic, strong, readonly, nullable) STCongestionWindow *congestionWindow;
+
+- (instancetype)initWithTokenBucket:(nullable STTokenBucket *)bucket
+                   congestionWindow:(nullable STCongestionWindow *)cwnd
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Called when the departure task is taken from the dock,
+ *  if it was sent before (timeout), means the fragments lost.
+ *
+ * @param ship - departure task
+ * @param now  - current time
+ */
+- (void)startDeparture:(id<STDeparture>)ship time:(NSTimeInterval)now;
+
+/**
+ *  Check whether the fragment of departure can be sent now
+ *
+ * @param length - fragment length
+ * @param ship   - departure task
+ * @param now    - current time
+ * @return false to wait for next turn
+ */
+- (BOOL)allowsLength:(NSUInteger)length departure:(id<STDeparture>)ship time:(NSTimeInterval)now;
+
+/**
+ *  Called after fragment (or part of it) sent
+ *
+ * @param length - sent length
+ * @param fra    - fragment (the data object from the departure)
+ * @param ship   - departure task
+ * @param now    - current time
+ */
+- (void)sentLength:(NSUInteger)length
+          fragment:(NSData *)fra
+         departure:(id<STDeparture>)ship
+              time:(NSTimeInterval)now;
+
+/**
+ *  Called when fragment counted by 'sentLength:' failed to be written
+ *  (e.g.: packed, but the packet dropped), to give back its bytes
+ *
+ * @param length - counted length
+ * @param fra    - fragment (the data object from the departure)
+ * @param ship   - departure task
+ */
+- (void)unsentLength:(NSUInteger)length
+            fragment:(NSData *)fra
+           departure:(id<STDeparture>)ship;
+
+/**
+ *  Called after responses checked by the departures,
+ *  to release bytes of fragments responded
+ *
+ * @param responses - income ships with SN (or cumulative acks)
+ */
+- (void)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses;
+
+/**
+ *  Called when all fragments of the departure responded
+ *
+ * @param ship - departure task
+ */
+- (void)finishDeparture:(id<STDeparture>)ship;
+
+/**
+ *  Called when the departure failed
+ *
+ * @param ship - departure task
+ */
+- (void)abortDeparture:(id<STDeparture>)ship;
+
+/**
+ *  Release bytes of finished tasks which were not responded via docker
+ *
+ * @param now - current time
+ */
+- (void)purgeWithTime:(NSTimeInterval)now;
+
+@end
+
+@interface STPacer (Creation)
+
+/**
+ *  Create pacer with rate and window
+ *
+ * @param bytesPerSecond - sending rate, 0 means unlimited
+ * @param window         - initial congestion window in bytes, 0 means unlimited
+ * @return pacer
+ */
++ (instancetype)pacerWithRate:(double)bytesPerSecond window:(NSUInteger)window;
+
+@end
+
+NS_ASSUME_NONNULL_END
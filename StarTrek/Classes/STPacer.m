@@ -0,0 +1,463 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPacer.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STPacer.h"
+
+@interface STTokenBucket () {
+
+    double _tokens;
+    NSTimeInterval _lastTime;  // last refill time
+}
+
+@end
+
+@implementation STTokenBucket
+
+- (instancetype)init {
+    return [self initWithRate:0 capacity:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithRate:(double)bytesPerSecond capacity:(double)burst {
+    if (self = [super init]) {
+        _rate = bytesPerSecond;
+        _capacity = burst;
+        _tokens = burst;
+        _lastTime = 0;
+    }
+    return self;
+}
+
+- (double)tokens {
+    return _tokens;
+}
+
+// private
+- (void)refillWithTime:(NSTimeInterval)now {
+    if (_lastTime > 0 && now > _lastTime) {
+        _tokens += (now - _lastTime) * _rate;
+        if (_tokens > _capacity) {
+            _tokens = _capacity;
+        }
+    }
+    _lastTime = now;
+}
+
+- (BOOL)hasTokensForLength:(NSUInteger)length time:(NSTimeInterval)now {
+    if (_rate <= 0) {
+        // unlimited
+        return YES;
+    }
+    [self refillWithTime:now];
+    // a package larger than the bucket can be sent when the bucket is full,
+    // the tokens will be in debt after that.
+    double need = MIN((double)length, _capacity);
+    return _tokens >= need;
+}
+
+- (void)takeTokensForLength:(NSUInteger)length time:(NSTimeInterval)now {
+    if (_rate <= 0) {
+        // unlimited
+        return;
+    }
+    [self refillWithTime:now];
+    _tokens -= length;
+}
+
+- (BOOL)consumeLength:(NSUInteger)length time:(NSTimeInterval)now {
+    if (![self hasTokensForLength:length time:now]) {
+        return NO;
+    }
+    [self takeTokensForLength:length time:now];
+    return YES;
+}
+
+- (void)returnTokensForLength:(NSUInteger)length {
+    if (_rate <= 0) {
+        // unlimited
+        return;
+    }
+    _tokens += length;
+    if (_tokens > _capacity) {
+        _tokens = _capacity;
+    }
+}
+
+@end
+
+#pragma mark -
+
+@interface STCongestionWindow () {
+
+    NSUInteger _window;
+    NSUInteger _threshold;
+    NSUInteger _inflight;
+
+    NSUInteger _acked;  // acked bytes in congestion avoidance
+}
+
+@end
+
+@implementation STCongestionWindow
+
+- (instancetype)init {
+    return [self initWithWindow:(ST_MSS * 10) segmentSize:ST_MSS];
+}
+
+/* designated initializer */
+- (instancetype)initWithWindow:(NSUInteger)initial segmentSize:(NSUInteger)mss {
+    if (self = [super init]) {
+        _segmentSize = mss;
+        _minWindow = mss * 2;
+        _maxWindow = mss * 4096;
+        _window = MAX(initial, _minWindow);
+        _threshold = _maxWindow;
+        _inflight = 0;
+        _acked = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)window {
+    return _window;
+}
+
+- (NSUInteger)threshold {
+    return _threshold;
+}
+
+- (NSUInteger)inflight {
+    return _inflight;
+}
+
+- (BOOL)canSendLength:(NSUInteger)length {
+    if (_inflight == 0) {
+        // always let one package go,
+        // even if it's larger than the window
+        return YES;
+    }
+    return _inflight + length <= _window;
+}
+
+- (void)sentLength:(NSUInteger)length {
+    _inflight += length;
+}
+
+- (void)ackedLength:(NSUInteger)length {
+    [self releaseLength:length];
+    if (_window < _threshold) {
+        // slow start
+        _window += length;
+    } else {
+        // congestion avoidance
+        _acked += length;
+        if (_acked >= _window) {
+            _acked -= _window;
+            _window += _segmentSize;
+        }
+    }
+    if (_window > _maxWindow) {
+        _window = _maxWindow;
+    }
+}
+
+- (void)lostLength:(NSUInteger)length {
+    [self releaseLength:length];
+    // multiplicative decrease
+    _threshold = MAX(_window / 2, _minWindow);
+    _window = _threshold;
+    _acked = 0;
+}
+
+- (void)releaseLength:(NSUInteger)length {
+    _inflight = _inflight > length ? _inflight - length : 0;
+}
+
+@end
+
+#pragma mark -
+
+@interface __PacerFlight : NSObject
+
+@property(nonatomic, weak) id<STDeparture> ship;
+
+// fragment => bytes in flight
+@property(nonatomic, strong) NSMapTable<NSData *, NSNumber *> *fragments;
+
+@property(nonatomic, assign) NSUInteger bytes;  // total bytes in flight
+
+@end
+
+@implementation __PacerFlight
+
+- (instancetype)init {
+    if (self = [super init]) {
+        NSPointerFunctionsOptions keyOptions = NSPointerFunctionsStrongMemory
+                                             | NSPointerFunctionsObjectPointerPersonality;
+        self.fragments = [NSMapTable mapTableWithKeyOptions:keyOptions
+                                               valueOptions:NSPointerFunctionsStrongMemory];
+        self.bytes = 0;
+    }
+    return self;
+}
+
+@end
+
+@interface STPacer ()
+
+@property(nonatomic, strong, nullable) STTokenBucket *bucket;
+@property(nonatomic, strong, nullable) STCongestionWindow *congestionWindow;
+
+// SN => fragments in flight
+@property(nonatomic, strong) NSMutableDictionary<id<STShipID>, __PacerFlight *> *flights;
+
+@end
+
+@implementation STPacer
+
+- (instancetype)init {
+    return [self initWithTokenBucket:nil congestionWindow:nil];
+}
+
+/* designated initializer */
+- (instancetype)initWithTokenBucket:(nullable STTokenBucket *)bucket
+                   congestionWindow:(nullable STCongestionWindow *)cwnd {
+    if (self = [super init]) {
+        self.bucket = bucket;
+        self.congestionWindow = cwnd;
+        self.flights = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+// private
+- (BOOL)isCounting:(id<STDeparture>)ship {
+    // only important tasks will be responded
+    return _congestionWindow && [ship isImportant] && [ship sn];
+}
+
+// private
+- (nullable __PacerFlight *)flightForDeparture:(id<STDeparture>)ship {
+    id<STShipID> sn = [ship sn];
+    __PacerFlight *flight = sn ? [_flights objectForKey:sn] : nil;
+    if (flight && flight.ship != ship) {
+        // another task with same SN
+        return nil;
+    }
+    return flight;
+}
+
+- (void)startDeparture:(id<STDeparture>)ship time:(NSTimeInterval)now {
+    @synchronized (self) {
+        __PacerFlight *flight = [self flightForDeparture:ship];
+        if (flight) {
+            // sent before but no response, fragments lost
+            [_congestionWindow lostLength:flight.bytes];
+            [_flights removeObjectForKey:[ship sn]];
+        }
+    }
+}
+
+- (BOOL)allowsLength:(NSUInteger)length departure:(id<STDeparture>)ship time:(NSTimeInterval)now {
+    @synchronized (self) {
+        if ([self isCounting:ship] && ![_congestionWindow canSendLength:length]) {
+            // window full, waiting for responses
+            return NO;
+        }
+        if (!_bucket) {
+            // unlimited
+            return YES;
+        }
+        // tokens will be taken for the bytes actually written
+        return [_bucket hasTokensForLength:length time:now];
+    }
+}
+
+- (void)sentLength:(NSUInteger)length
+          fragment:(NSData *)fra
+         departure:(id<STDeparture>)ship
+              time:(NSTimeInterval)now {
+    @synchronized (self) {
+        [_bucket takeTokensForLength:length time:now];
+        if (![self isCounting:ship]) {
+            return;
+        }
+        __PacerFlight *flight = [self flightForDeparture:ship];
+        if (!flight) {
+            flight = [[__PacerFlight alloc] init];
+            flight.ship = ship;
+            [_flights setObject:flight forKey:[ship sn]];
+        }
+        NSNumber *bytes = [flight.fragments objectForKey:fra];
+        [flight.fragments setObject:@([bytes unsignedIntegerValue] + length) forKey:fra];
+        flight.bytes += length;
+        [_congestionWindow sentLength:length];
+    }
+}
+
+- (void)unsentLength:(NSUInteger)length
+            fragment:(NSData *)fra
+           departure:(id<STDeparture>)ship {
+    @synchronized (self) {
+        [_bucket returnTokensForLength:length];
+        __PacerFlight *flight = [self isCounting:ship] ? [self flightForDeparture:ship] : nil;
+        NSNumber *bytes = [flight.fragments objectForKey:fra];
+        if (!bytes) {
+            // not in flight
+            return;
+        }
+        NSUInteger counted = MIN([bytes unsignedIntegerValue], length);
+        if (counted < [bytes unsignedIntegerValue]) {
+            [flight.fragments setObject:@([bytes unsignedIntegerValue] - counted) forKey:fra];
+        } else {
+            [flight.fragments removeObjectForKey:fra];
+        }
+        flight.bytes -= counted;
+        // not sent, so not lost either
+        [_congestionWindow releaseLength:counted];
+    }
+}
+
+// private
+- (void)ackFlight:(__PacerFlight *)flight {
+    id<STDeparture> ship = flight.ship;
+    if (!ship) {
+        return;
+    }
+    // fragments not remaining in the task were responded
+    NSHashTable<NSData *> *remaining = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory |
+                                                                          NSPointerFunctionsObjectPointerPersonality)];
+    for (NSData *fra in [ship fragments]) {
+        [remaining addObject:fra];
+    }
+    NSMutableArray<NSData *> *responded = [[NSMutableArray alloc] init];
+    for (NSData *fra in flight.fragments) {
+        if (![remaining containsObject:fra]) {
+            [responded addObject:fra];
+        }
+    }
+    NSUInteger bytes;
+    for (NSData *fra in responded) {
+        bytes = [[flight.fragments objectForKey:fra] unsignedIntegerValue];
+        [flight.fragments removeObjectForKey:fra];
+        flight.bytes -= bytes;
+        [_congestionWindow ackedLength:bytes];
+    }
+}
+
+- (void)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses {
+    if (!_congestionWindow) {
+        return;
+    }
+    @synchronized (self) {
+        NSArray<id<STShipID>> *acks;
+        __PacerFlight *flight;
+        for (id<STArrival> response in responses) {
+            acks = nil;
+            if ([response respondsToSelector:@selector(respondedShipIDs)]) {
+                acks = [response respondedShipIDs];
+            }
+            if ([acks count] == 0 && [response sn]) {
+                // response for the ship with same SN
+                acks = @[[response sn]];
+            }
+            for (id<STShipID> sn in acks) {
+                flight = [_flights objectForKey:sn];
+                if (flight) {
+                    [self ackFlight:flight];
+                }
+            }
+        }
+    }
+}
+
+- (void)finishDeparture:(id<STDeparture>)ship {
+    @synchronized (self) {
+        __PacerFlight *flight = [self flightForDeparture:ship];
+        if (flight) {
+            [_congestionWindow ackedLength:flight.bytes];
+            [_flights removeObjectForKey:[ship sn]];
+        }
+    }
+}
+
+- (void)abortDeparture:(id<STDeparture>)ship {
+    @synchronized (self) {
+        __PacerFlight *flight = [self flightForDeparture:ship];
+        if (flight) {
+            [_congestionWindow releaseLength:flight.bytes];
+            [_flights removeObjectForKey:[ship sn]];
+        }
+    }
+}
+
+- (void)purgeWithTime:(NSTimeInterval)now {
+    @synchronized (self) {
+        NSMutableArray<id<STShipID>> *finished = [[NSMutableArray alloc] init];
+        [_flights enumerateKeysAndObjectsUsingBlock:^(id<STShipID> sn, __PacerFlight *flight, BOOL *stop) {
+            id<STDeparture> ship = flight.ship;
+            if (!ship) {
+                // task gone
+                [self->_congestionWindow releaseLength:flight.bytes];
+                [finished addObject:sn];
+            } else if ([ship status:now] == STShipStatusDone) {
+                [self->_congestionWindow ackedLength:flight.bytes];
+                [finished addObject:sn];
+            }
+        }];
+        [_flights removeObjectsForKeys:finished];
+    }
+}
+
+@end
+
+@implementation STPacer (Creation)
+
++ (instancetype)pacerWithRate:(double)bytesPerSecond window:(NSUInteger)window {
+    STTokenBucket *bucket = nil;
+    if (bytesPerSecond > 0) {
+        // allow bursting for 1/10 second
+        double burst = MAX(bytesPerSecond / 10, ST_MSS);
+        bucket = [[STTokenBucket alloc] initWithRate:bytesPerSecond capacity:burst];
+    }
+    STCongestionWindow *cwnd = nil;
+    if (window > 0) {
+        cwnd = [[STCongestionWindow alloc] initWithWindow:window segmentSize:ST_MSS];
+    }
+    return [[self alloc] initWithTokenBucket:bucket congestionWindow:cwnd];
+}
+
+@end
@@ -0,0 +1,163 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPayloadCodec.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/NIOByteBuffer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Payload Codec
+ *  ~~~~~~~~~~~~~
+ *
+ *  One stage of the codec chain (compression, encryption, ...)
+ */
+@protocol STPayloadCodec <NSObject>
+
+@property(nonatomic, readonly) NSString *name;
+
+/**
+ *  Encode the remaining bytes of source buffer
+ *
+ * @param src - input view (position to limit)
+ * @param dst - output, encoded bytes should be appended
+ * @return false on error
+ */
+- (BOOL)encodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst;
+
+/**
+ *  Decode the remaining bytes of source buffer
+ *
+ * @param src - input view (position to limit)
+ * @param dst - output, decoded bytes should be appended
+ * @return false on error
+ */
+- (BOOL)decodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst;
+
+@end
+
+/**
+ *  Counters for one stage
+ */
+@interface STCodecStatistics : NSObject <NSCopying>
+
+@property(nonatomic, readonly) NSString *name;
+
+@property(nonatomic, assign) NSUInteger encodeCount;
+@property(nonatomic, assign) NSUInteger encodeBytesIn;
+@property(nonatomic, assign) NSUInteger encodeBytesOut;
+@property(nonatomic, assign) NSTimeInterval encodeTime;  // CPU time (seconds)
+
+@property(nonatomic, assign) NSUInteger decodeCount;
+@property(nonatomic, assign) NSUInteger decodeBytesIn;
+@property(nonatomic, assign) NSUInteger decodeBytesOut;
+@property(nonatomic, assign) NSTimeInterval decodeTime;  // CPU time (seconds)
+
+@property(nonatomic, assign) NSUInteger errors;
+
+- (instancetype)initWithName:(NSString *)name
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Codec Chain
+ *  ~~~~~~~~~~~
+ *
+ *  Encodes payload with stages in order, and decodes in reverse order;
+ *  each stage reads a buffer view of the previous output, the outputs
+ *  are written into two reused buffers, so only the final result is copied.
+ */
+@interface STCodecChain : NSObject
+
+@property(nonatomic, readonly) NSArray<id<STPayloadCodec>> *codecs;
+
+- (instancetype)initWithCodecs:(NSArray<id<STPayloadCodec>> *)stages
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Encode payload before fragmenting
+ *
+ * @param payload - data to be sent
+ * @return nil on error
+ */
+- (nullable NSData *)encodeData:(NSData *)payload;
+
+/**
+ *  Decode payload after assembling
+ *
+ * @param payload - received data
+ * @return nil on error
+ */
+- (nullable NSData *)decodeData:(NSData *)payload;
+
+/**
+ *  Get counters of all stages
+ *
+ * @return snapshots in chain order
+ */
+- (NSArray<STCodecStatistics *> *)statistics;
+
+- (void)resetStatistics;
+
+@end
+
+#pragma mark -
+
+/**
+ *  LZ Codec
+ *  ~~~~~~~~
+ *
+ *  Fast LZ77 compression (LZ4 style sequences, no dependency)
+ *
+ *      +--------+----------------+---------------------+
+ *      | method | length (4 BE)  |     compressed      |   method = 1
+ *      +--------+----------------+---------------------+
+ *      | method |             original data            |   method = 0
+ *      +--------+--------------------------------------+
+ */
+@interface STLZCodec : NSObject <STPayloadCodec>
+
+// payloads shorter than this will not be compressed (default is 64)
+@property(nonatomic, assign) NSUInteger minLength;
+
+// max decompressed length accepted (default is 16 MB)
+@property(nonatomic, assign) NSUInteger maxLength;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,499 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPayloadCodec.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <time.h>
+
+#import "STPayloadCodec.h"
+
+// CPU time of current thread
+static inline NSTimeInterval thread_cpu_time(void) {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+@implementation STCodecStatistics
+
+- (instancetype)init {
+    return [self initWithName:@""];
+}
+
+/* designated initializer */
+- (instancetype)initWithName:(NSString *)name {
+    if (self = [super init]) {
+        _name = name;
+    }
+    return self;
+}
+
+// Override
+- (id)copyWithZone:(nullable NSZone *)zone {
+    STCodecStatistics *stat = [[[self class] allocWithZone:zone] initWithName:_name];
+    if (stat) {
+        stat.encodeCount = _encodeCount;
+        stat.encodeBytesIn = _encodeBytesIn;
+        stat.encodeBytesOut = _encodeBytesOut;
+        stat.encodeTime = _encodeTime;
+        stat.decodeCount = _decodeCount;
+        stat.decodeBytesIn = _decodeBytesIn;
+        stat.decodeBytesOut = _decodeBytesOut;
+        stat.decodeTime = _decodeTime;
+        stat.errors = _errors;
+    }
+    return stat;
+}
+
+// Override
+- (NSString *)description {
+    return [NSString stringWithFormat:@"<%@ name=\"%@\" encode=%lu(%lu->%lu, %.6fs) decode=%lu(%lu->%lu, %.6fs) errors=%lu />",
+            [self class], _name,
+            _encodeCount, _encodeBytesIn, _encodeBytesOut, _encodeTime,
+            _decodeCount, _decodeBytesIn, _decodeBytesOut, _decodeTime,
+            _errors];
+}
+
+@end
+
+#pragma mark -
+
+/**
+ *  Two output buffers used in turn by the stages,
+ *  the input of each stage is the output of the previous one.
+ */
+@interface __CodecPipe : NSObject
+
+@property(nonatomic, strong) NSMutableData *ping;
+@property(nonatomic, strong) NSMutableData *pong;
+
+@end
+
+@implementation __CodecPipe
+
+- (instancetype)init {
+    if (self = [super init]) {
+        self.ping = [[NSMutableData alloc] init];
+        self.pong = [[NSMutableData alloc] init];
+    }
+    return self;
+}
+
+- (NSMutableData *)outputForStage:(NSUInteger)index {
+    NSMutableData *output = (index & 1) ? _pong : _ping;
+    [output setLength:0];
+    return output;
+}
+
+@end
+
+@interface STCodecChain ()
+
+@property(nonatomic, strong) NSArray<id<STPayloadCodec>> *codecs;
+// created once, never replaced
+@property(nonatomic, strong) NSArray<STCodecStatistics *> *counters;
+
+@property(nonatomic, strong) __CodecPipe *encodePipe;
+@property(nonatomic, strong) __CodecPipe *decodePipe;
+
+@end
+
+@implementation STCodecChain
+
+- (instancetype)init {
+    return [self initWithCodecs:@[]];
+}
+
+/* designated initializer */
+- (instancetype)initWithCodecs:(NSArray<id<STPayloadCodec>> *)stages {
+    if (self = [super init]) {
+        self.codecs = [stages copy];
+        NSMutableArray *counters = [[NSMutableArray alloc] initWithCapacity:stages.count];
+        for (id<STPayloadCodec> codec in stages) {
+            [counters addObject:[[STCodecStatistics alloc] initWithName:codec.name]];
+        }
+        self.counters = counters;
+        self.encodePipe = [[__CodecPipe alloc] init];
+        self.decodePipe = [[__CodecPipe alloc] init];
+    }
+    return self;
+}
+
+- (nullable NSData *)encodeData:(NSData *)payload {
+    NSUInteger count = _codecs.count;
+    if (count == 0) {
+        return payload;
+    }
+    @synchronized (_encodePipe) {
+        NSData *input = payload;
+        NSMutableData *output;
+        id<STPayloadCodec> codec;
+        STCodecStatistics *stat;
+        NSTimeInterval start;
+        BOOL ok;
+        for (NSUInteger index = 0; index < count; ++index) {
+            codec = [_codecs objectAtIndex:index];
+            stat = [_counters objectAtIndex:index];
+            output = [_encodePipe outputForStage:index];
+            start = thread_cpu_time();
+            // read the previous output through a buffer view, no copy
+            ok = [codec encodeBuffer:[NIOByteBuffer bufferWithData:input] output:output];
+            @synchronized (stat) {
+                stat.encodeTime += thread_cpu_time() - start;
+                if (!ok) {
+                    stat.errors += 1;
+                    return nil;
+                }
+                stat.encodeCount += 1;
+                stat.encodeBytesIn += input.length;
+                stat.encodeBytesOut += output.length;
+            }
+            input = output;
+        }
+        // the pipe buffers will be reused, copy the final result out
+        return [input copy];
+    }
+}
+
+- (nullable NSData *)decodeData:(NSData *)payload {
+    NSUInteger count = _codecs.count;
+    if (count == 0) {
+        return payload;
+    }
+    @synchronized (_decodePipe) {
+        NSData *input = payload;
+        NSMutableData *output;
+        id<STPayloadCodec> codec;
+        STCodecStatistics *stat;
+        NSTimeInterval start;
+        BOOL ok;
+        for (NSUInteger index = 0; index < count; ++index) {
+            // decode in reverse order
+            codec = [_codecs objectAtIndex:(count - 1 - index)];
+            stat = [_counters objectAtIndex:(count - 1 - index)];
+            output = [_decodePipe outputForStage:index];
+            start = thread_cpu_time();
+            ok = [codec decodeBuffer:[NIOByteBuffer bufferWithData:input] output:output];
+            @synchronized (stat) {
+                stat.decodeTime += thread_cpu_time() - start;
+                if (!ok) {
+                    stat.errors += 1;
+                    return nil;
+                }
+                stat.decodeCount += 1;
+                stat.decodeBytesIn += input.length;
+                stat.decodeBytesOut += output.length;
+            }
+            input = output;
+        }
+        return [input copy];
+    }
+}
+
+- (NSArray<STCodecStatistics *> *)statistics {
+    NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:_counters.count];
+    for (STCodecStatistics *stat in _counters) {
+        @synchronized (stat) {
+            [array addObject:[stat copy]];
+        }
+    }
+    return array;
+}
+
+- (void)resetStatistics {
+    // reset in place, the counters are being used by other threads
+    for (STCodecStatistics *stat in _counters) {
+        @synchronized (stat) {
+            stat.encodeCount = 0;
+            stat.encodeBytesIn = 0;
+            stat.encodeBytesOut = 0;
+            stat.encodeTime = 0;
+            stat.decodeCount = 0;
+            stat.decodeBytesIn = 0;
+            stat.decodeBytesOut = 0;
+            stat.decodeTime = 0;
+            stat.errors = 0;
+        }
+    }
+}
+
+@end
+
+#pragma mark - LZ77
+
+/*
+ *  LZ77 block format (LZ4 compatible sequences):
+ *
+ *      token: [literals length : 4][match length - 4 : 4]
+ *      (extra literals length bytes) (literals) [offset : 2, little endian]
+ *      (extra match length bytes)
+ *
+ *  the last sequence has literals only, and the last 5 bytes are always literals.
+ */
+#define LZ_HASH_BITS  12
+#define LZ_MIN_MATCH  4
+#define LZ_LAST_LITERALS 5
+#define LZ_MAX_OFFSET 65535
+
+static inline UInt32 lz_read32(const UInt8 *p) {
+    UInt32 v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static inline UInt32 lz_hash(UInt32 v) {
+    return (v * 2654435761U) >> (32 - LZ_HASH_BITS);
+}
+
+// worst case output size
+static inline NSUInteger lz_bound(NSUInteger length) {
+    return length + length / 255 + 16;
+}
+
+static inline UInt8 *lz_put_length(UInt8 *op, NSUInteger len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (UInt8)len;
+    return op;
+}
+
+// return compressed length, output must have 'lz_bound(length)' bytes
+static NSUInteger lz_compress(const UInt8 *src, NSUInteger length, UInt8 *dst) {
+    UInt32 table[1 << LZ_HASH_BITS];
+    memset(table, 0, sizeof(table));
+    const UInt8 *ip = src;
+    const UInt8 *anchor = src;           // start of pending literals
+    const UInt8 *end = src + length;
+    const UInt8 *limit = length > LZ_LAST_LITERALS + LZ_MIN_MATCH
+                       ? end - LZ_LAST_LITERALS - LZ_MIN_MATCH : src;
+    UInt8 *op = dst;
+    while (ip < limit) {
+        UInt32 seq = lz_read32(ip);
+        UInt32 h = lz_hash(seq);
+        const UInt8 *ref = src + table[h];
+        table[h] = (UInt32)(ip - src);
+        if (ref >= ip || ip - ref > LZ_MAX_OFFSET || lz_read32(ref) != seq) {
+            ++ip;
+            continue;
+        }
+        // extend the match
+        const UInt8 *mp = ip + LZ_MIN_MATCH;
+        const UInt8 *rp = ref + LZ_MIN_MATCH;
+        const UInt8 *mlimit = end - LZ_LAST_LITERALS;
+        while (mp < mlimit && *mp == *rp) {
+            ++mp;
+            ++rp;
+        }
+        NSUInteger literals = ip - anchor;
+        NSUInteger match = (mp - ip) - LZ_MIN_MATCH;
+        UInt8 *token = op++;
+        *token = (UInt8)((literals >= 15 ? 15 : literals) << 4);
+        if (literals >= 15) {
+            op = lz_put_length(op, literals - 15);
+        }
+        memcpy(op, anchor, literals);
+        op += literals;
+        UInt16 offset = (UInt16)(ip - ref);
+        *op++ = offset & 0xFF;
+        *op++ = offset >> 8;
+        *token |= (UInt8)(match >= 15 ? 15 : match);
+        if (match >= 15) {
+            op = lz_put_length(op, match - 15);
+        }
+        ip = mp;
+        anchor = ip;
+    }
+    // last literals
+    NSUInteger literals = end - anchor;
+    UInt8 *token = op++;
+    *token = (UInt8)((literals >= 15 ? 15 : literals) << 4);
+    if (literals >= 15) {
+        op = lz_put_length(op, literals - 15);
+    }
+    memcpy(op, anchor, literals);
+    op += literals;
+    return op - dst;
+}
+
+// return decompressed length, or -1 on error
+static NSInteger lz_decompress(const UInt8 *src, NSUInteger length, UInt8 *dst, NSUInteger capacity) {
+    const UInt8 *ip = src;
+    const UInt8 *iend = src + length;
+    UInt8 *op = dst;
+    UInt8 *oend = dst + capacity;
+    NSUInteger len;
+    UInt8 b;
+    while (ip < iend) {
+        UInt8 token = *ip++;
+        // literals
+        len = token >> 4;
+        if (len == 15) {
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        if (len > (NSUInteger)(iend - ip) || len > (NSUInteger)(oend - op)) {
+            return -1;
+        }
+        memcpy(op, ip, len);
+        ip += len;
+        op += len;
+        if (ip >= iend) {
+            // last sequence
+            break;
+        }
+        // match
+        if (iend - ip < 2) {
+            return -1;
+        }
+        NSUInteger offset = ip[0] | ((NSUInteger)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (NSUInteger)(op - dst)) {
+            return -1;
+        }
+        len = token & 0x0F;
+        if (len == 15) {
+            do {
+                if (ip >= iend) {
+                    return -1;
+                }
+                b = *ip++;
+                len += b;
+            } while (b == 255);
+        }
+        len += LZ_MIN_MATCH;
+        if (len > (NSUInteger)(oend - op)) {
+            return -1;
+        }
+        const UInt8 *ref = op - offset;
+        if (offset >= len) {
+            memcpy(op, ref, len);
+            op += len;
+        } else {
+            // overlapped, copy byte by byte
+            while (len--) {
+                *op++ = *ref++;
+            }
+        }
+    }
+    return op - dst;
+}
+
+#pragma mark -
+
+// methods
+#define LZ_METHOD_RAW       0
+#define LZ_METHOD_COMPRESS  1
+
+@implementation STLZCodec
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _minLength = 64;
+        _maxLength = 16 * 1024 * 1024;
+    }
+    return self;
+}
+
+// Override
+- (NSString *)name {
+    return @"lz";
+}
+
+// Override
+- (BOOL)encodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst {
+    NSUInteger length = [src remaining];
+    const UInt8 *bytes = [src readableBytes];
+    NSUInteger start = dst.length;
+    if (length >= _minLength) {
+        // reserve space for header and the worst case
+        [dst setLength:(start + 5 + lz_bound(length))];
+        UInt8 *head = (UInt8 *)dst.mutableBytes + start;
+        NSUInteger size = lz_compress(bytes, length, head + 5);
+        if (size < length) {
+            head[0] = LZ_METHOD_COMPRESS;
+            head[1] = (length >> 24) & 0xFF;
+            head[2] = (length >> 16) & 0xFF;
+            head[3] = (length >> 8) & 0xFF;
+            head[4] = length & 0xFF;
+            [dst setLength:(start + 5 + size)];
+            return YES;
+        }
+        // not compressible, store raw data
+        [dst setLength:start];
+    }
+    UInt8 method = LZ_METHOD_RAW;
+    [dst appendBytes:&method length:1];
+    [dst appendBytes:bytes length:length];
+    return YES;
+}
+
+// Override
+- (BOOL)decodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst {
+    NSUInteger length = [src remaining];
+    if (length == 0) {
+        return NO;
+    }
+    const UInt8 *bytes = [src readableBytes];
+    if (bytes[0] == LZ_METHOD_RAW) {
+        [dst appendBytes:(bytes + 1) length:(length - 1)];
+        return YES;
+    } else if (bytes[0] != LZ_METHOD_COMPRESS || length < 5) {
+        return NO;
+    }
+    NSUInteger size = ((NSUInteger)bytes[1] << 24) | ((NSUInteger)bytes[2] << 16)
+                    | ((NSUInteger)bytes[3] << 8) | bytes[4];
+    if (size > _maxLength) {
+        return NO;
+    }
+    NSUInteger start = dst.length;
+    [dst setLength:(start + size)];
+    UInt8 *out = (UInt8 *)dst.mutableBytes + start;
+    NSInteger res = lz_decompress(bytes + 5, length - 5, out, size);
+    if (res != (NSInteger)size) {
+        [dst setLength:start];
+        return NO;
+    }
+    return YES;
+}
+
+@end
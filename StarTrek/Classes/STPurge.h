@@ -0,0 +1,131 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPurge.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STClock.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Purge Budget
+ *  ~~~~~~~~~~~~
+ *
+ *  Limits the work of one purge call: at most 'limit' entries,
+ *  or 'duration' seconds, whichever comes first.
+ *
+ *  The duration is measured with the owner's clock; a cached clock
+ *  (e.g.: STCoarseClock) won't move during a purge, so only the limit
+ *  works with it.
+ */
+@interface STPurgeBudget : NSObject
+
+@property(nonatomic, readonly) NSUInteger remaining;
+
+@property(nonatomic, readonly, getter=isExhausted) BOOL exhausted;
+
+- (instancetype)initWithLimit:(NSUInteger)count
+                     duration:(NSTimeInterval)seconds
+                        clock:(STClock *)clock
+NS_DESIGNATED_INITIALIZER;
+
+// measured with the default clock
+- (instancetype)initWithLimit:(NSUInteger)count
+                     duration:(NSTimeInterval)seconds;
+
+/**
+ *  Take one entry from the budget
+ *
+ * @return false when exhausted, stop purging
+ */
+- (BOOL)consume;
+
+@end
+
+@interface STPurgeBudget (Creation)
+
+// default budget: 256 entries or 1 millisecond
++ (instancetype)budget;
+
++ (instancetype)budgetWithClock:(STClock *)clock;
+
++ (instancetype)budgetWithLimit:(NSUInteger)count duration:(NSTimeInterval)seconds;
+
++ (instancetype)budgetWithLimit:(NSUInteger)count
+                       duration:(NSTimeInterval)seconds
+                          clock:(STClock *)clock;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Expiry Queue
+ *  ~~~~~~~~~~~~
+ *
+ *  Objects in order of time (FIFO), so the due ones can be taken
+ *  from the head without scanning the others; popped entries are
+ *  skipped by a head index, and compacted when they take half the array.
+ */
+@interface STExpiryQueue<__covariant ObjectType> : NSObject
+
+@property(nonatomic, readonly) NSUInteger count;
+
+// objects are held weakly if 'weak' is true
+- (instancetype)initWithWeakObjects:(BOOL)weak
+NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Append object to the tail
+ *
+ * @param obj  - object
+ * @param when - time, should not be earlier than the tail's
+ */
+- (void)addObject:(ObjectType)obj time:(NSTimeInterval)when;
+
+/**
+ *  Remove the head if it's due
+ *
+ * @param obj   - output object (nil when weak object released)
+ * @param when  - output time
+ * @param limit - entries with time before this are due
+ * @return false when nothing due
+ */
+- (BOOL)popObject:(ObjectType _Nullable * _Nonnull)obj
+             time:(nullable NSTimeInterval *)when
+           before:(NSTimeInterval)limit;
+
+@end
+
+NS_ASSUME_NONNULL_END
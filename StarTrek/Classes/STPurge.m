@@ -0,0 +1,209 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STPurge.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STPurge.h"
+
+static const NSUInteger PURGE_LIMIT = 256;
+static const NSTimeInterval PURGE_DURATION = 0.001;
+
+// check the clock every 16 entries
+static const NSUInteger PURGE_CLOCK_MASK = 0x0F;
+
+// popped entries kept before compacting the queue
+static const NSUInteger EXPIRY_COMPACT_MIN = 64;
+
+@interface STPurgeBudget () {
+
+    STClock *_clock;
+    NSTimeInterval _deadline;
+    NSUInteger _consumed;
+}
+
+@property(nonatomic, assign) NSUInteger remaining;
+
+@end
+
+@implementation STPurgeBudget
+
+- (instancetype)init {
+    return [self initWithLimit:PURGE_LIMIT duration:PURGE_DURATION];
+}
+
+- (instancetype)initWithLimit:(NSUInteger)count duration:(NSTimeInterval)seconds {
+    return [self initWithLimit:count duration:seconds clock:[STClock defaultClock]];
+}
+
+/* designated initializer */
+- (instancetype)initWithLimit:(NSUInteger)count
+                     duration:(NSTimeInterval)seconds
+                        clock:(STClock *)clock {
+    if (self = [super init]) {
+        _clock = clock;
+        _remaining = count;
+        _deadline = seconds > 0 ? [clock now] + seconds : 0;
+        _consumed = 0;
+    }
+    return self;
+}
+
+- (BOOL)isExhausted {
+    return _remaining == 0;
+}
+
+- (BOOL)consume {
+    if (_remaining == 0) {
+        return NO;
+    }
+    if (_deadline > 0 && (++_consumed & PURGE_CLOCK_MASK) == 0) {
+        if ([_clock now] > _deadline) {
+            // time's up
+            _remaining = 0;
+            return NO;
+        }
+    }
+    --_remaining;
+    return YES;
+}
+
+@end
+
+@implementation STPurgeBudget (Creation)
+
++ (instancetype)budget {
+    return [[self alloc] init];
+}
+
++ (instancetype)budgetWithClock:(STClock *)clock {
+    return [[self alloc] initWithLimit:PURGE_LIMIT duration:PURGE_DURATION clock:clock];
+}
+
++ (instancetype)budgetWithLimit:(NSUInteger)count duration:(NSTimeInterval)seconds {
+    return [[self alloc] initWithLimit:count duration:seconds];
+}
+
++ (instancetype)budgetWithLimit:(NSUInteger)count
+                       duration:(NSTimeInterval)seconds
+                          clock:(STClock *)clock {
+    return [[self alloc] initWithLimit:count duration:seconds clock:clock];
+}
+
+@end
+
+#pragma mark -
+
+@interface __ExpiryEntry : NSObject
+
+@property(nonatomic, strong) id strongObject;
+@property(nonatomic, weak) id weakObject;
+
+@property(nonatomic, assign) NSTimeInterval time;
+
+@end
+
+@implementation __ExpiryEntry
+
+@end
+
+@interface STExpiryQueue () {
+
+    BOOL _weak;
+    NSUInteger _head;  // index of the first entry not popped
+}
+
+@property(nonatomic, strong) NSMutableArray<__ExpiryEntry *> *entries;
+
+@end
+
+@implementation STExpiryQueue
+
+- (instancetype)init {
+    return [self initWithWeakObjects:NO];
+}
+
+/* designated initializer */
+- (instancetype)initWithWeakObjects:(BOOL)weak {
+    if (self = [super init]) {
+        _weak = weak;
+        _head = 0;
+        self.entries = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (NSUInteger)count {
+    return [_entries count] - _head;
+}
+
+- (void)addObject:(id)obj time:(NSTimeInterval)when {
+    __ExpiryEntry *entry = [[__ExpiryEntry alloc] init];
+    if (_weak) {
+        entry.weakObject = obj;
+    } else {
+        entry.strongObject = obj;
+    }
+    entry.time = when;
+    [_entries addObject:entry];
+}
+
+- (BOOL)popObject:(id _Nullable * _Nonnull)obj
+             time:(nullable NSTimeInterval *)when
+           before:(NSTimeInterval)limit {
+    NSUInteger count = [_entries count];
+    if (_head >= count) {
+        return NO;
+    }
+    __ExpiryEntry *entry = [_entries objectAtIndex:_head];
+    if (entry.time >= limit) {
+        return NO;
+    }
+    *obj = _weak ? entry.weakObject : entry.strongObject;
+    if (when) {
+        *when = entry.time;
+    }
+    entry.strongObject = nil;
+    ++_head;
+    // remove popped entries in one move, instead of shifting on every pop
+    if (_head == count) {
+        [_entries removeAllObjects];
+        _head = 0;
+    } else if (_head >= EXPIRY_COMPACT_MIN && _head * 2 >= count) {
+        [_entries removeObjectsInRange:NSMakeRange(0, _head)];
+        _head = 0;
+    }
+    return YES;
+}
+
+@end
@@ -35,32 +35,156 @@
 //
 
 #import <StarTrek/STAddressPairObject.h>
+#import <StarTrek/STClock.h>
 #import <StarTrek/STConnection.h>
 #import <StarTrek/STDocker.h>
 #import <StarTrek/STDock.h>
+#import <StarTrek/STPacer.h>
+#import <StarTrek/STCoalescer.h>
+#import <StarTrek/STFrameDecoder.h>
+#import <StarTrek/STArrivalDispatcher.h>
+#import <StarTrek/STPayloadCodec.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface STDocker : STAddressPairObject <STDocker>
+/**
+ *  Docker Ready Set
+ *  ~~~~~~~~~~~~~~~~
+ *
+ *  Collects dockers which have work to do,
+ *  so the gate drives only these dockers instead of all.
+ */
+@protocol STDockerReadySet <NSObject>
+
+/**
+ *  Called when ships queued or data received
+ *
+ * @param worker - docker to be driven in next turn
+ */
+- (void)dockerReady:(id<STDocker>)worker;
+
+/**
+ *  Called when the docker is waiting for pacing or retrying
+ *
+ * @param worker - docker to be driven later
+ * @param when   - due time
+ */
+- (void)docker:(id<STDocker>)worker readyAtTime:(NSTimeInterval)when;
+
+@end
+
+@interface STDocker : STAddressPairObject <STDocker, STDepartureHallDelegate, STDepartureQuotaDelegate>
 
 @property(nonatomic, weak) id<STDockerDelegate> delegate;
 
 @property(nonatomic, weak, readonly) id<STConnection> connection;
 
+// notified when this docker has work to do (set by the gate)
+@property(nonatomic, weak, nullable) id<STDockerReadySet> readySet;
+
+// time source (replaced by the gate's clock)
+@property(nonatomic, strong) STClock *clock;
+
+// pacing layer between the dock and the connection
+@property(nonatomic, strong, readonly, nullable) STPacer *pacer;
+
+// packing small fragments into one packet
+@property(nonatomic, strong, readonly, nullable) STCoalescer *coalescer;
+
+// cutting received stream into frames
+@property(nonatomic, strong, readonly, nullable) id<STFrameDecoder> frameDecoder;
+
+// delivering completed arrivals on the worker pool
+@property(nonatomic, strong, readonly, nullable) STArrivalDispatcher *dispatcher;
+
+// compression/encryption stages for payloads,
+// NOTICE: the docker does not apply it by itself, since the package format
+//         belongs to subclasses; see 'encodePayload:' & 'decodePayload:'
+@property(nonatomic, strong, readonly, nullable) STCodecChain *codecChain;
+
+// limits for the waiting queue of this docker
+@property(nonatomic, readonly, nullable) STDepartureQuota *quota;
+
+// cleared when the waiting queue reached the high watermark (KVO-observable)
+@property(nonatomic, readonly, getter=isWritable) BOOL writable;
+
+// how many departures can be sent at the same time (default is 4),
+// fragments of them are interleaved, higher priority goes first;
+// when all taken, a new departure with higher priority parks the
+// lowest one (not partially sent) until a flight finished
+@property(nonatomic, assign) NSUInteger maxFlights;
+
 - (instancetype)initWithConnection:(id<STConnection>)conn
 NS_DESIGNATED_INITIALIZER;
 
 // protected
 - (STDock *)createDock;
 
+// protected, override for sending with pacing (default is nil)
+- (nullable STPacer *)createPacer;
+
+// protected, override for packing small fragments (default is nil),
+// NOTICE: the remote docker must split packets in the same way,
+//         set 'datagram' on the coalescer for UDP connections
+- (nullable STCoalescer *)createCoalescer;
+
+// protected, override for decoding stream frames (default is nil,
+// means each received data is a complete package)
+- (nullable id<STFrameDecoder>)createFrameDecoder;
+
+// protected, override for delivering arrivals on worker threads (default is nil,
+// means 'docker:receivedShip:' is called on the receiving thread)
+- (nullable STArrivalDispatcher *)createDispatcher;
+
+// protected, override for encoding payloads (default is nil),
+// NOTICE: the remote docker must have the same stages,
+//         and the subclass must call 'encodePayload:' & 'decodePayload:'
+- (nullable STCodecChain *)createCodecChain;
+
 @end
 
 @interface STDocker (Shipping)  // protected
 
 /**
- *  Get income Ship from received data
+ *  Split received data into packages before building arrivals
+ *
+ * @param data - received data
+ * @return data packages (coalesced packets will be split)
+ */
+- (NSArray<NSData *> *)splitReceivedData:(NSData *)data;
+
+/**
+ *  Get all income Ships from received data,
+ *  leftover bytes will be kept by the frame decoder
  *
  * @param data - received data
+ * @return income ships carrying data packages/fragments
+ */
+- (NSArray<id<STArrival>> *)arrivalsWithData:(NSData *)data;
+
+/**
+ *  Encode payload with the codec chain before building departure,
+ *  subclass should call it in 'sendData:' (not called by the docker)
+ *
+ * @param payload - data to be sent
+ * @return encoded data, or the payload itself when no codec chain
+ */
+- (nullable NSData *)encodePayload:(NSData *)payload;
+
+/**
+ *  Decode payload with the codec chain after assembling,
+ *  subclass should call it when the arrival is completed
+ *  (in 'checkArrival:' after 'assembleArrival:', not called by the docker)
+ *
+ * @param payload - data of completed package
+ * @return decoded data, nil on error
+ */
+- (nullable NSData *)decodePayload:(NSData *)payload;
+
+/**
+ *  Get income Ship from received data
+ *
+ * @param data - received data (a complete frame when decoder exists)
  * @return income ship carrying data package/fragment
  */
 - (id<STArrival>)arrivalWithData:(NSData *)data;
@@ -88,6 +212,14 @@ NS_DESIGNATED_INITIALIZER;
  */
 - (void)checkResponseInArrival:(id<STArrival>)income;
 
+/**
+ *  Check and remove linked departure ships for a batch of responses,
+ *  the dock is locked only once for all of them
+ *
+ * @param responses - income ships with SN (or cumulative acks)
+ */
+- (void)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses;
+
 /**
  *  Get outgo ship from waiting queue
  *
@@ -96,6 +228,16 @@ NS_DESIGNATED_INITIALIZER;
  */
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now;
 
+/**
+ *  Get outgo ship with higher priority when all flights are taken
+ *
+ * @param prior - priority of the flight to be preempted
+ * @param now   - current time
+ * @return new task with higher priority, nil when none
+ */
+- (nullable id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior
+                                                   time:(NSTimeInterval)now;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -38,15 +38,84 @@
 
 #import "STStarDocker.h"
 
+/**
+ *  Departures can be sent out at the same time,
+ *  fragments of them will be interleaved.
+ */
+static const NSUInteger DOCKER_MAX_FLIGHTS = 4;
+
+/**
+ *  When to drive the docker again if it has nothing to do now:
+ *      1. sending blocked by pacing or socket buffer: soon;
+ *      2. waiting for responses: at the next retry check.
+ */
+static const NSTimeInterval DOCKER_BLOCKED_INTERVAL = 0.016;
+static const NSTimeInterval DOCKER_RETRY_INTERVAL = 1.0;
+
+/**
+ *  Resume state of a departure being sent
+ */
+@interface __DepartureFlight : NSObject
+
+@property(nonatomic, strong) id<STDeparture> outgo;
+@property(nonatomic, copy) NSArray<NSData *> *fragments;  // snapshot
+
+@property(nonatomic, assign) NSUInteger index;   // next fragment
+@property(nonatomic, assign) NSUInteger offset;  // sent bytes of next fragment
+
+@end
+
+@implementation __DepartureFlight
+
+@end
+
+/**
+ *  Fragment packed by the coalescer, charged to the pacer
+ */
+@interface __PackedFragment : NSObject
+
+@property(nonatomic, strong) id<STDeparture> outgo;
+@property(nonatomic, strong) NSData *fragment;
+
+@property(nonatomic, assign) NSUInteger length;  // packed bytes
+@property(nonatomic, assign) NSUInteger end;     // end position in the packet
+
+@end
+
+@implementation __PackedFragment
+
+@end
+
+#pragma mark -
+
 @interface STDocker ()
 
 @property(nonatomic, weak) id<STConnection> connection;
 
 @property(nonatomic, strong) STDock *dock;
 
-// remaining data to be sent
-@property(nonatomic, strong) id<STDeparture> lastOutgo;
-@property(nonatomic, strong) NSArray<NSData *> *lastFragments;
+@property(nonatomic, strong, nullable) STPacer *pacer;
+
+@property(nonatomic, strong, nullable) STCoalescer *coalescer;
+
+@property(nonatomic, strong, nullable) id<STFrameDecoder> frameDecoder;
+
+@property(nonatomic, strong, nullable) STArrivalDispatcher *dispatcher;
+
+@property(nonatomic, strong, nullable) STCodecChain *codecChain;
+
+@property(nonatomic, assign, getter=isWritable) BOOL writable;
+
+// departures being sent, in round-robin order
+@property(nonatomic, strong) NSMutableArray<__DepartureFlight *> *flights;
+
+// departures preempted by higher priority, resumed in order
+@property(nonatomic, strong) NSMutableArray<__DepartureFlight *> *parkedFlights;
+
+// fragments in the packet being packed, and the one being written
+@property(nonatomic, strong) NSMutableArray<__PackedFragment *> *packedFragments;
+@property(nonatomic, strong) NSMutableArray<__PackedFragment *> *sealedFragments;
+@property(nonatomic, assign) NSUInteger sealedOffset;  // written bytes
 
 @end
 
@@ -65,9 +134,24 @@
                                localAddress:conn.localAddress]) {
         self.connection = conn;
         self.delegate = nil;
+        self.clock = [STClock defaultClock];
         self.dock = [self createDock];
-        self.lastOutgo = nil;
-        self.lastFragments = nil;
+        self.pacer = [self createPacer];
+        self.coalescer = [self createCoalescer];
+        self.frameDecoder = [self createFrameDecoder];
+        self.dispatcher = [self createDispatcher];
+        self.codecChain = [self createCodecChain];
+        self.writable = YES;
+        // watching the waiting queue
+        STDepartureHall *hall = [_dock departureHall];
+        hall.delegate = self;
+        hall.quota.delegate = self;
+        self.maxFlights = DOCKER_MAX_FLIGHTS;
+        self.flights = [[NSMutableArray alloc] init];
+        self.parkedFlights = [[NSMutableArray alloc] init];
+        self.packedFragments = [[NSMutableArray alloc] init];
+        self.sealedFragments = [[NSMutableArray alloc] init];
+        self.sealedOffset = 0;
     }
     return self;
 }
@@ -84,6 +168,40 @@
     return [[STLockedDock alloc] init];
 }
 
+// override for user-customized pacer
+- (nullable STPacer *)createPacer {
+    // no pacing, send fragments as fast as the connection accepts them
+    return nil;
+}
+
+- (STDepartureQuota *)quota {
+    return [[_dock departureHall] quota];
+}
+
+// override for user-customized coalescer
+- (nullable STCoalescer *)createCoalescer {
+    // no packing, send fragments one by one
+    return nil;
+}
+
+// override for user-customized frame decoder
+- (nullable id<STFrameDecoder>)createFrameDecoder {
+    // no stream framing, each received data is a package
+    return nil;
+}
+
+// override for user-customized dispatcher
+- (nullable STArrivalDispatcher *)createDispatcher {
+    // deliver arrivals on the receiving thread
+    return nil;
+}
+
+// override for user-customized codec stages
+- (nullable STCodecChain *)createCodecChain {
+    // payloads are sent as they are
+    return nil;
+}
+
 // private
 - (void)removeConnection {
     // 1. clear connection reference
@@ -134,35 +252,103 @@
 
 // Override
 - (BOOL)sendShip:(id<STDeparture>)ship {
-    return [_dock addDeparture:ship];
+    BOOL ok = [_dock addDeparture:ship time:[_clock now]];
+    if (ok) {
+        [_readySet dockerReady:self];
+    }
+    return ok;
 }
 
 // Override
 - (void)processReceivedData:(NSData *)data {
-    // 1. get income ship from received data
-    id<STArrival> income = [self arrivalWithData:data];
-    if (!income) {
-        // waiting for more data
+    // 0. split coalesced packets
+    NSArray<NSData *> *packages = [self splitReceivedData:data];
+    NSArray<id<STArrival>> *arrivals;
+    for (NSData *pack in packages) {
+        // 1. get income ships from received data
+        arrivals = [self arrivalsWithData:pack];
+        for (id<STArrival> ship in arrivals) {
+            // 2. check income ship for respose
+            id<STArrival> income = [self checkArrival:ship];
+            if (!income) {
+                // waiting for more fragment
+                continue;
+            }
+            // 3. callback for processing income ship with completed data package
+            [self deliverArrival:income];
+        }
+    }
+    // responses may free the window, or tasks may be waiting for sending
+    [_readySet dockerReady:self];
+}
+
+// private
+- (void)deliverArrival:(id<STArrival>)income {
+    STArrivalDispatcher *dispatcher = [self dispatcher];
+    if (!dispatcher) {
+        [_delegate docker:self receivedShip:income];
         return;
     }
-    // 2. check income ship for respose
-    income = [self checkArrival:income];
-    if (!income) {
-        // waiting for more fragment
+    id<STDockerDelegate> delegate = [self delegate];
+    BOOL ok = [dispatcher dispatchArrival:income handler:^(id<STArrival> ship) {
+        [delegate docker:self receivedShip:ship];
+    }];
+    if (!ok) {
+        // queue full, the arrival is refused (counted as 'dropped')
+        NSLog(@"arrival dropped, dispatcher full: %@", [self remoteAddress]);
     }
-    // 3. callback for processing income ship with completed data package
-    [_delegate docker:self receivedShip:income];
 }
 
 // Override
 - (void)purge {
-    [_dock purge];
+    NSTimeInterval now = [_clock now];
+    [_dock purgeWithTime:now budget:[STPurgeBudget budgetWithClock:_clock]];
+    [_pacer purgeWithTime:now];
 }
 
 // Override
 - (void)close {
     [self removeConnection];
+    // give back the room taken from the gate
+    [[self quota] setParent:nil];
     self.dock = nil;
+    [_flights removeAllObjects];
+    [_parkedFlights removeAllObjects];
+    [_packedFragments removeAllObjects];
+    [_sealedFragments removeAllObjects];
+}
+
+//
+//  Departure Hall Delegate
+//
+
+// Override
+- (void)departureHall:(STDepartureHall *)hall droppedDeparture:(id<STDeparture>)ship {
+    // callback for mission failed
+    NIOException *exception = [[NIOBufferOverflowException alloc] init];  // Queue full
+    NIOError *error = [[NIOError alloc] initWithException:exception];
+    [_delegate docker:self failedToSendShip:ship error:error];
+}
+
+// Override
+- (void)departureHall:(STDepartureHall *)hall expiredDeparture:(id<STDeparture>)ship {
+    // callback for mission failed
+    NIOException *exception = [[NIOSocketException alloc] init];  // Deadline passed
+    NIOError *error = [[NIOError alloc] initWithException:exception];
+    [_delegate docker:self failedToSendShip:ship error:error];
+}
+
+//
+//  Departure Quota Delegate
+//
+
+// Override
+- (void)quota:(STDepartureQuota *)quota changedWritable:(BOOL)writable {
+    self.writable = writable;  // KVO
+    id<STDockerDelegate> delegate = [self delegate];
+    if ([delegate respondsToSelector:@selector(docker:changedWritable:)]) {
+        [delegate docker:self changedWritable:writable];
+    }
 }
 
 // Override
@@ -178,6 +364,35 @@
 
 // Override
 - (BOOL)process {
+    BOOL busy = [self processFlights];
+    [self scheduleNextTurn:busy];
+    return busy;
+}
+
+// private
+- (void)scheduleNextTurn:(BOOL)busy {
+    id<STDockerReadySet> readySet = [self readySet];
+    if (!readySet) {
+        // driven every turn
+    } else if (busy) {
+        [readySet dockerReady:self];
+    } else if ([_flights count] > 0 || [_coalescer length] > 0) {
+        // blocked by pacing or socket buffer, try again soon;
+        // or fragments packed, flush when the first one waited enough
+        NSTimeInterval when = [_clock now] + DOCKER_BLOCKED_INTERVAL;
+        NSTimeInterval flush = [_coalescer flushTime];
+        if (flush > 0 && ([_flights count] == 0 || flush < when)) {
+            when = flush;
+        }
+        [readySet docker:self readyAtTime:when];
+    } else if ([[self quota] ships] > 0) {
+        // waiting for responses, check again when it's time to retry
+        [readySet docker:self readyAtTime:([_clock now] + DOCKER_RETRY_INTERVAL)];
+    }
+}
+
+// private
+- (BOOL)processFlights {
     // 1. get connection which is ready for sending data
     id<STConnection> conn = [self connection];
     if (![conn isAlive]) {
@@ -185,101 +400,346 @@
         return NO;
     }
     NIOException *exception;
-    NIOError *error;
-    // 2. get data waiting to be sent out
+    NIOError *error = nil;
+    STPacer *pacer = [self pacer];
+    STCoalescer *coalescer = [self coalescer];
+    NSTimeInterval now = [_clock now];
+    if ([coalescer isReadyWithTime:now]) {
+        // packed fragments waiting to be written
+        return [self flushCoalescer:coalescer connection:conn];
+    }
+    // 2. take next outgo task when there is a free slot,
+    //    or a higher priority one to preempt
     id<STDeparture> outgo;
     NSArray<NSData *> *fragments;
-    if ([_lastFragments count] > 0) {
-        // get remaining fragments from last outgo task
-        outgo = self.lastOutgo;
-        fragments = self.lastFragments;
-        self.lastOutgo = nil;
-        self.lastFragments = nil;
-    } else {
-        // get next outgo task
-        NSTimeInterval now = OKGetCurrentTimeInterval();
+    if ([_flights count] < _maxFlights && [_parkedFlights count] > 0) {
+        // resume the preempted departure first
+        [_flights addObject:[_parkedFlights firstObject]];
+        [_parkedFlights removeObjectAtIndex:0];
+        outgo = nil;
+    } else if ([_flights count] < _maxFlights) {
         outgo = [self nextDepartureWithTime:now];
-        if (!outgo) {
-            // nothing to do now, return false to let the thread have a rest
-            return NO;
-        } else if ([outgo status:now] == STShipStatusFailed) {
-            id<STDockerDelegate> delegate = [self delegate];
-            if (delegate) {
-                // callback for mission failed
-                exception = [[NIOSocketException alloc] init];  // Request timeout
-                error = [[NIOError alloc] initWithException:exception];
-                [delegate docker:self failedToSendShip:outgo error:error];
-            }
-            // task timeout, return true to process next one
+    } else {
+        outgo = [self preemptFlightWithTime:now];
+    }
+    if (!outgo) {
+        // nothing new
+    } else if ([outgo status:now] == STShipStatusFailed) {
+        [self removeFlightForDeparture:outgo];
+        [pacer abortDeparture:outgo];
+        id<STDockerDelegate> delegate = [self delegate];
+        if (delegate) {
+            // callback for mission failed
+            exception = [[NIOSocketException alloc] init];  // Request timeout
+            error = [[NIOError alloc] initWithException:exception];
+            [delegate docker:self failedToSendShip:outgo error:error];
+        }
+        // task timeout, return true to process next one
+        return YES;
+    } else {
+        // get fragments from outgo task
+        fragments = [outgo fragments];
+        if ([fragments count] == 0) {
+            // all fragments of this task have been sent already
+            // return true to process next one
             return YES;
-        } else {
-            // get fragments from outgo task
-            fragments = [outgo fragments];
-            if ([fragments count] == 0) {
-                // all fragments of this task have been sent already
-                // return true to process next one
-                return YES;
-            }
         }
+        // new task or retry
+        [pacer startDeparture:outgo time:now];
+        [self addFlightForDeparture:outgo fragments:fragments];
+    }
+    // 3. choose the departure to be served
+    __DepartureFlight *flight = [self nextFlight];
+    if (!flight) {
+        // nothing to do now, return false to let the thread have a rest
+        return NO;
     }
-    // 3. process fragments of outgo task
-    NSInteger index = 0, sent = 0;
+    outgo = flight.outgo;
+    if (flight.offset == 0 && STDepartureIsExpired(outgo, now)) {
+        // deadline passed, drop the remaining fragments
+        [_flights removeObjectIdenticalTo:flight];
+        [pacer abortDeparture:outgo];
+        if (![outgo isImportant]) {
+            // important task is still waiting in the dock,
+            // it will be reported there when it's time to retry
+            exception = [[NIOSocketException alloc] init];  // Deadline passed
+            error = [[NIOError alloc] initWithException:exception];
+            [_delegate docker:self failedToSendShip:outgo error:error];
+        }
+        // return true to process next one
+        return YES;
+    }
+    // resume from the cursor (remaining bytes of partially sent fragment)
+    NSData *fragment = [flight.fragments objectAtIndex:flight.index];
+    NSUInteger remaining = fragment.length - flight.offset;
+    if (coalescer && ![coalescer canAppendLength:remaining]) {
+        // packet full, write it first
+        return [self flushCoalescer:coalescer connection:conn];
+    }
+    if (pacer && ![pacer allowsLength:remaining departure:outgo time:now]) {
+        // sending too fast, waiting for next turn
+        return NO;
+    }
+    if (coalescer) {
+        // pack the fragment, it will be written with others;
+        // packed fragments are never partially sent (offset is 0)
+        [coalescer appendData:fragment priority:[outgo priority] time:now];
+        [pacer sentLength:remaining fragment:fragment departure:outgo time:now];
+        __PackedFragment *packed = [[__PackedFragment alloc] init];
+        packed.outgo = outgo;
+        packed.fragment = fragment;
+        packed.length = remaining;
+        packed.end = [coalescer length];  // nothing sealed while packing
+        [_packedFragments addObject:packed];
+        [self moveFlightToNextFragment:flight];
+        if ([coalescer isReadyWithTime:now]) {
+            [self flushCoalescer:coalescer connection:conn];
+        }
+        return YES;
+    }
+    // 4. send one fragment
+    NSInteger sent = 0;
     @try {
-        for (NSData *fra in fragments) {
-            sent = [conn sendData:fra];
-            if (sent < fra.length) {
-                // buffer overflow?
-                break;
-            } else {
-                NSAssert(sent == fra.length, @"length of fragment sent error: %ld, %ld", sent, fra.length);
-                index += 1;
-                sent = 0;  // clear counter
-            }
+        sent = [conn sendData:fragment offset:flight.offset];
+        if (sent > 0) {
+            [pacer sentLength:sent fragment:fragment departure:outgo time:now];
         }
-        if (index < [fragments count]) {
-            // task failed
-            exception = [[NIOSocketException alloc] init];
-            error = [[NIOError alloc] initWithException:exception];
-        } else {
-            // task done
+        if (sent == remaining) {
+            // fragment sent, move to next one
+            [self moveFlightToNextFragment:flight];
+            // return true to process next one
             return YES;
         }
+        // buffer overflow?
+        exception = [[NIOSocketException alloc] init];
+        error = [[NIOError alloc] initWithException:exception];
     } @catch (NIOException *ex) {
         NSLog(@"docker connection error: %@", ex);
         error = [[NIOError alloc] initWithException:ex];
     } @finally {
     }
-    // 4. remove sent fragments
-    if (index > 0) {
-        NSUInteger len = [fragments count] - index;
-        fragments = [fragments subarrayWithRange:NSMakeRange(index, len)];
-    }
-    // remove partially sent data of next fragment
+    // 5. remember partially sent data
     if (sent > 0) {
-        NSData *next = [fragments firstObject];
-        NSUInteger len = [next length] - sent;
-        next = [next subdataWithRange:NSMakeRange(sent, len)];
-        NSMutableArray *mArray;
-        if ([fragments isKindOfClass:[NSMutableArray class]]) {
-            mArray = (NSMutableArray *)fragments;
-        } else {
-            mArray = [fragments mutableCopy];
-        }
-        [mArray replaceObjectAtIndex:0 withObject:next];
-        fragments = mArray;
+        flight.offset += sent;
     }
-    // 5. store remaining data
-    self.lastOutgo = outgo;
-    self.lastFragments = fragments;
     // 6. callback for error
-    [_delegate docker:self sendingShip:outgo error:error];
+    if (error) {
+        [_delegate docker:self sendingShip:outgo error:error];
+    }
+    return NO;
+}
+
+// private
+- (BOOL)flushCoalescer:(STCoalescer *)coalescer connection:(id<STConnection>)conn {
+    NSUInteger offset;
+    NSData *packet = [coalescer packetWithOffset:&offset];
+    if ([_sealedFragments count] == 0) {
+        // a new packet sealed, with the fragments packed
+        NSMutableArray<__PackedFragment *> *empty = _sealedFragments;
+        self.sealedFragments = _packedFragments;
+        self.packedFragments = empty;
+        self.sealedOffset = 0;
+    }
+    NIOException *exception;
+    NIOError *error = nil;
+    NSInteger sent = 0;
+    @try {
+        sent = [conn sendData:packet offset:offset];
+        if (sent > 0) {
+            [coalescer sentLength:sent];
+            _sealedOffset += sent;
+        }
+        if (sent == packet.length - offset) {
+            // packet written
+            [_sealedFragments removeAllObjects];
+            return YES;
+        } else if (sent >= 0) {
+            // buffer overflow? the rest will be written next time
+            return NO;
+        }
+        exception = [[NIOSocketException alloc] init];
+        error = [[NIOError alloc] initWithException:exception];
+    } @catch (NIOException *ex) {
+        NSLog(@"docker connection error: %@", ex);
+        error = [[NIOError alloc] initWithException:ex];
+    } @finally {
+    }
+    // connection failed, drop the packet
+    [self dropPacketWithCoalescer:coalescer error:error];
     return NO;
 }
 
+// private
+- (void)dropPacketWithCoalescer:(STCoalescer *)coalescer error:(NIOError *)error {
+    [coalescer dropPacket];
+    STPacer *pacer = [self pacer];
+    NSMutableArray<id<STDeparture>> *failed = [[NSMutableArray alloc] init];
+    for (__PackedFragment *packed in _sealedFragments) {
+        if (packed.end <= _sealedOffset) {
+            // written before
+            continue;
+        }
+        // give back the bytes charged when packing
+        [pacer unsentLength:packed.length fragment:packed.fragment departure:packed.outgo];
+        if ([failed indexOfObjectIdenticalTo:packed.outgo] == NSNotFound) {
+            [failed addObject:packed.outgo];
+        }
+    }
+    [_sealedFragments removeAllObjects];
+    // callback for error
+    for (id<STDeparture> outgo in failed) {
+        [_delegate docker:self sendingShip:outgo error:error];
+    }
+}
+
+// private
+- (nullable id<STDeparture>)preemptFlightWithTime:(NSTimeInterval)now {
+    // the flight with lowest priority, not partially sent
+    __DepartureFlight *lowest = nil;
+    for (__DepartureFlight *flight in _flights) {
+        if (flight.offset > 0) {
+            continue;
+        } else if (!lowest || [flight.outgo priority] >= [lowest.outgo priority]) {
+            lowest = flight;
+        }
+    }
+    if (!lowest) {
+        return nil;
+    }
+    id<STDeparture> outgo = [self nextDepartureBeforePriority:[lowest.outgo priority] time:now];
+    if (outgo) {
+        // park it, give the slot to the higher one
+        [_flights removeObjectIdenticalTo:lowest];
+        [_parkedFlights addObject:lowest];
+    }
+    return outgo;
+}
+
+// private
+- (void)moveFlightToNextFragment:(__DepartureFlight *)flight {
+    flight.index += 1;
+    flight.offset = 0;
+    [_flights removeObjectIdenticalTo:flight];
+    if (flight.index < [flight.fragments count]) {
+        // append to the tail for taking turns
+        [_flights addObject:flight];
+    }
+}
+
+// private
+- (nullable __DepartureFlight *)flightForDeparture:(id<STDeparture>)outgo {
+    for (__DepartureFlight *flight in _flights) {
+        if (flight.outgo == outgo) {
+            return flight;
+        }
+    }
+    for (__DepartureFlight *flight in _parkedFlights) {
+        if (flight.outgo == outgo) {
+            return flight;
+        }
+    }
+    return nil;
+}
+
+// private
+- (void)addFlightForDeparture:(id<STDeparture>)outgo fragments:(NSArray<NSData *> *)fragments {
+    __DepartureFlight *flight = [self flightForDeparture:outgo];
+    if (!flight) {
+        flight = [[__DepartureFlight alloc] init];
+        flight.outgo = outgo;
+        flight.fragments = fragments;
+        flight.index = 0;
+        flight.offset = 0;
+        [_flights addObject:flight];
+    } else if (flight.offset == 0) {
+        // a retried task starts again with its remaining fragments
+        flight.fragments = fragments;
+        flight.index = 0;
+    }
+    // else the partially sent fragment must be finished first,
+    // let this retry go, it will be timeout again.
+}
+
+// private
+- (void)removeFlightForDeparture:(id<STDeparture>)outgo {
+    __DepartureFlight *flight = [self flightForDeparture:outgo];
+    if (!flight) {
+        return;
+    } else if (flight.offset > 0) {
+        // finish the partially sent fragment only,
+        // the rest bytes still need to be written
+        flight.fragments = @[[flight.fragments objectAtIndex:flight.index]];
+        flight.index = 0;
+    } else {
+        [_flights removeObjectIdenticalTo:flight];
+        [_parkedFlights removeObjectIdenticalTo:flight];
+    }
+}
+
+// private
+- (nullable __DepartureFlight *)nextFlight {
+    __DepartureFlight *next = nil;
+    for (__DepartureFlight *flight in _flights) {
+        if (flight.offset > 0) {
+            // fragment partially sent, must not be interleaved
+            return flight;
+        } else if (!next || [flight.outgo priority] < [next.outgo priority]) {
+            // higher priority preempts,
+            // the same priority takes turns in order
+            next = flight;
+        }
+    }
+    return next;
+}
+
 @end
 
 @implementation STDocker (Shipping)
 
+- (NSArray<NSData *> *)splitReceivedData:(NSData *)data {
+    STCoalescer *coalescer = [self coalescer];
+    if (!coalescer) {
+        return @[data];
+    }
+    return [coalescer splitData:data];
+}
+
+- (NSArray<id<STArrival>> *)arrivalsWithData:(NSData *)data {
+    id<STFrameDecoder> decoder = [self frameDecoder];
+    if (!decoder) {
+        id<STArrival> income = [self arrivalWithData:data];
+        return income ? @[income] : @[];
+    }
+    // cut all complete frames
+    NSArray<NSData *> *frames = [decoder decodeData:data];
+    NSMutableArray<id<STArrival>> *arrivals;
+    arrivals = [[NSMutableArray alloc] initWithCapacity:[frames count]];
+    id<STArrival> income;
+    for (NSData *frame in frames) {
+        income = [self arrivalWithData:frame];
+        if (income) {
+            [arrivals addObject:income];
+        }
+    }
+    return arrivals;
+}
+
+- (nullable NSData *)encodePayload:(NSData *)payload {
+    STCodecChain *chain = [self codecChain];
+    if (!chain) {
+        return payload;
+    }
+    return [chain encodeData:payload];
+}
+
+- (nullable NSData *)decodePayload:(NSData *)payload {
+    STCodecChain *chain = [self codecChain];
+    if (!chain) {
+        return payload;
+    }
+    return [chain decodeData:payload];
+}
+
 - (id<STArrival>)arrivalWithData:(NSData *)data {
     NSAssert(false, @"override me!");
     return nil;
@@ -292,21 +752,42 @@
 
 - (void)checkResponseInArrival:(id<STArrival>)income {
     // check response for linked departure ship (same SN)
-    id<STDeparture> linked = [_dock checkResponseInArrival:income];
-    if (!linked) {
-        // linked departure task not found, or not finished yet
+    [self checkResponsesInArrivals:@[income]];
+}
+
+- (void)checkResponsesInArrivals:(NSArray<id<STArrival>> *)responses {
+    NSArray<id<STDeparture>> *finished = [_dock checkResponsesInArrivals:responses
+                                                                 time:[_clock now]];
+    // release bytes of fragments responded
+    [_pacer checkResponsesInArrivals:responses];
+    if ([finished count] == 0) {
+        // linked departure tasks not found, or not finished yet
+        return;
+    }
+    // all fragments responded, tasks finished
+    for (id<STDeparture> linked in finished) {
+        [_pacer finishDeparture:linked];
+    }
+    id<STDockerDelegate> delegate = [self delegate];
+    if ([delegate respondsToSelector:@selector(docker:sentShips:)]) {
+        [delegate docker:self sentShips:finished];
         return;
     }
-    // all fragments responded, task finished
-    [_delegate docker:self sentShip:linked];
+    for (id<STDeparture> linked in finished) {
+        [delegate docker:self sentShip:linked];
+    }
 }
 
 
 - (id<STArrival>)assembleArrival:(id<STArrival>)income {
-    return [_dock assembleArrival:income];
+    return [_dock assembleArrival:income time:[_clock now]];
 }
 - (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now {
     return [_dock nextDepartureWithTime:now];
 }
 
+- (nullable id<STDeparture>)nextDepartureBeforePriority:(NSInteger)prior time:(NSTimeInterval)now {
+    return [_dock nextDepartureBeforePriority:prior time:now];
+}
+
 @end
@@ -38,20 +38,49 @@
 #import <StarTrek/STConnection.h>
 #import <StarTrek/STDocker.h>
 #import <StarTrek/STGate.h>
+#import <StarTrek/STDepartureQuota.h>
+#import <StarTrek/STAdvancePartyCache.h>
+#import <StarTrek/STStarDocker.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface STGate : NSObject <STGate, STConnectionDelegate>
+@interface STGate : NSObject <STGate, STConnectionDelegate, STDepartureQuotaDelegate, STDockerReadySet>
 
 // delegate for handling docker events
 @property(nonatomic, weak, readonly) id<STDockerDelegate> delegate;
 
+// limits for waiting ships of all dockers
+@property(nonatomic, strong, readonly) STDepartureQuota *quota;
+
+// mirrors 'quota': cleared when waiting ships of all dockers reached
+// its high watermark, set again when drained to the low watermark (KVO-observable)
+@property(nonatomic, readonly, getter=isWritable) BOOL writable;
+
+// packages received before the docker created
+@property(nonatomic, strong, readonly) STAdvancePartyCache *advanceParties;
+
+// seconds between cleanups of all dockers (default is 1.0)
+@property(nonatomic, assign) NSTimeInterval purgeInterval;
+
+// time source, ticked once per 'process', shared with dockers
+// (set it before adding dockers)
+@property(nonatomic, strong) STClock *clock;
+
 - (instancetype)initWithDockerDelegate:(id<STDockerDelegate>)delegate
 NS_DESIGNATED_INITIALIZER;
 
 // protected
 - (STAddressPairMap<id<STDocker>> *)createDockerPool;
 
+// protected, override for limiting waiting ships (default is unlimited)
+- (STDepartureQuota *)createQuota;
+
+// protected, override for limiting cached packages of unknown connections
+- (STAdvancePartyCache *)createAdvancePartyCache;
+
+// protected, override for a coarse or virtual clock (default is system clock)
+- (STClock *)createClock;
+
 @end
 
 // protected
@@ -84,7 +113,16 @@ NS_DESIGNATED_INITIALIZER;
 // protected
 @interface STGate (Processor)
 
-- (NSInteger)driveDockers:(NSSet<id<STDocker>> *)workers;
+/**
+ *  Take dockers which have work to do now (queued ships, received data,
+ *  or due for pacing/retrying), other dockers will not be driven.
+ *
+ * @param now - current time
+ * @return dockers to be driven
+ */
+- (NSArray<id<STDocker>> *)readyDockersWithTime:(NSTimeInterval)now;
+
+- (NSInteger)driveDockers:(NSArray<id<STDocker>> *)workers;
 
 - (void)cleanupDockers:(NSSet<id<STDocker>> *)workers;
 
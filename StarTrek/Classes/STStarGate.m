@@ -34,9 +34,15 @@
 //  Created by Albert Moky on 2023/3/9.
 //
 
+#import <ObjectKey/ObjectKey.h>
+
+#import "STStarDocker.h"
+
+#import "STConcurrentAddressPairMap.h"
+#import "STReadySet.h"
 #import "STStarGate.h"
 
-@interface __DockerPool : STAddressPairMap<id<STDocker>>
+@interface __DockerPool : STConcurrentAddressPairMap<id<STDocker>>
 
 @end
 
@@ -66,12 +72,25 @@
 
 #pragma mark -
 
-@interface STGate ()
+static const NSTimeInterval GATE_PURGE_INTERVAL = 1.0;
+
+@interface STGate () {
+
+    NSTimeInterval _nextPurgeTime;
+}
 
 @property(nonatomic, strong) STAddressPairMap<id<STDocker>> *dockerPool;
 
 @property(nonatomic, weak) id<STDockerDelegate> delegate;
 
+@property(nonatomic, strong) STDepartureQuota *quota;
+
+@property(nonatomic, strong) STAdvancePartyCache *advanceParties;
+
+@property(nonatomic, assign, getter=isWritable) BOOL writable;
+
+@property(nonatomic, strong) STReadySet<id<STDocker>> *readySet;
+
 @end
 
 @implementation STGate
@@ -87,6 +106,14 @@
     if (self = [super init]) {
         self.delegate = delegate;
         self.dockerPool = [self createDockerPool];
+        self.quota = [self createQuota];
+        self.quota.delegate = self;
+        self.writable = YES;
+        self.advanceParties = [self createAdvancePartyCache];
+        self.readySet = [[STReadySet alloc] init];
+        self.purgeInterval = GATE_PURGE_INTERVAL;
+        self.clock = [self createClock];
+        _nextPurgeTime = 0;
     }
     return self;
 }
@@ -95,6 +122,25 @@
     return [[__DockerPool alloc] init];
 }
 
+- (STDepartureQuota *)createQuota {
+    // no limits
+    return [[STDepartureQuota alloc] init];
+}
+
+- (STAdvancePartyCache *)createAdvancePartyCache {
+    // 8 packages per connection, 1 MB in total, 16 seconds
+    return [[STAdvancePartyCache alloc] init];
+}
+
+- (STClock *)createClock {
+    return [STClock defaultClock];
+}
+
+// Override
+- (void)quota:(STDepartureQuota *)quota changedWritable:(BOOL)writable {
+    self.writable = writable;  // KVO
+}
+
 // Override
 - (BOOL)sendData:(NSData *)payload
    remoteAddress:(id<NIOSocketAddress>)remote
@@ -121,14 +167,33 @@
 
 // Override
 - (BOOL)process {
-    NSSet<id<STDocker>> *dockers = [self allDockers];
-    // 1. drive all dockers to process
-    NSInteger count = [self driveDockers:dockers];
-    // 2. cleanup dockers
-    [self cleanupDockers:dockers];
+    NSTimeInterval now = [_clock tick];
+    // 1. drive dockers which have work to do
+    NSArray<id<STDocker>> *dockers = [self readyDockersWithTime:now];
+    NSInteger count = [dockers count] > 0 ? [self driveDockers:dockers] : 0;
+    // 2. cleanup dockers & advance parties periodically
+    if (now >= _nextPurgeTime) {
+        _nextPurgeTime = now + _purgeInterval;
+        [self cleanupDockers:[self allDockers]];
+        [_advanceParties purgeWithTime:now];
+    }
     return count > 0;
 }
 
+//
+//  Docker Ready Set
+//
+
+// Override
+- (void)dockerReady:(id<STDocker>)worker {
+    [_readySet addObject:worker];
+}
+
+// Override
+- (void)docker:(id<STDocker>)worker readyAtTime:(NSTimeInterval)when {
+    [_readySet addObject:worker time:when];
+}
+
 //
 //  Connection Delegate
 //
@@ -184,7 +249,7 @@
         [self setDocker:worker
           remoteAddress:worker.remoteAddress
            localAddress:worker.localAddress];
-        // process advance parties one by one
+        // process advance parties one by one (cached references, no copies)
         for (NSData *part in advanceParty) {
             [worker processReceivedData:part];
         }
@@ -232,6 +297,16 @@
 - (void)setDocker:(id<STDocker>)worker
     remoteAddress:(id<NIOSocketAddress>)remote
      localAddress:(nullable id<NIOSocketAddress>)local {
+    if ([worker isKindOfClass:[STDocker class]]) {
+        // count waiting ships of this docker in the gate's quota
+        [[(STDocker *)worker quota] setParent:_quota];
+        // the docker will tell when it has work to do
+        [(STDocker *)worker setReadySet:self];
+        [(STDocker *)worker setClock:_clock];
+        [_readySet addObject:worker];
+    } else {
+        [_readySet addUnmanagedObject:worker];
+    }
     [_dockerPool setObject:worker forRemote:remote local:local];
 }
 
@@ -245,10 +320,14 @@
 
 @implementation STGate (Processor)
 
-- (NSInteger)driveDockers:(NSSet<id<STDocker>> *)workers {
+- (NSArray<id<STDocker>> *)readyDockersWithTime:(NSTimeInterval)now {
+    return [_readySet popObjectsWithTime:now];
+}
+
+- (NSInteger)driveDockers:(NSArray<id<STDocker>> *)workers {
     __block NSInteger count = 0;
     [workers enumerateObjectsWithOptions:NSEnumerationConcurrent
-                              usingBlock:^(id<STDocker> docker, BOOL *stop) {
+                              usingBlock:^(id<STDocker> docker, NSUInteger idx, BOOL *stop) {
         if ([docker process]) {
             ++count;  // it's buzy
         }
@@ -289,12 +368,13 @@
 // cache the advance party before decide which docker to use
 - (NSArray<NSData *> *)cacheAdvanceParty:(NSData *)data
                            forConnection:(id<STConnection>)conn {
-    NSAssert(false, @"override me!");
-    return nil;
+    return [_advanceParties cacheData:data
+                        forConnection:conn
+                                 time:[_clock now]];
 }
 
 - (void)clearAdvancePartyForConnection:(id<STConnection>)conn {
-    NSAssert(false, @"override me!");
+    [_advanceParties clearForConnection:conn];
 }
 
 @end
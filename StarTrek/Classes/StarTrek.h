@@ -60,7 +60,11 @@ FOUNDATION_EXPORT const unsigned char StarTrekVersionString[];
 // type
 #import <StarTrek/STKeyPairMap.h>
 #import <StarTrek/STHashKeyPairMap.h>
+#import <StarTrek/STFlatKeyPairMap.h>
 #import <StarTrek/STAddressPairMap.h>
+#import <StarTrek/STConcurrentAddressPairMap.h>
+#import <StarTrek/STReadySet.h>
+#import <StarTrek/STRingBuffer.h>
 #import <StarTrek/STAddressPairObject.h>
 
 // net
@@ -80,9 +84,22 @@ FOUNDATION_EXPORT const unsigned char StarTrekVersionString[];
 #import <StarTrek/STBaseChannel.h>
 #import <StarTrek/STBaseConnection.h>
 #import <StarTrek/STBaseHub.h>
+#import <StarTrek/STLoopbackChannel.h>
+#import <StarTrek/STImpairedChannel.h>
+#import <StarTrek/STLoopbackHub.h>
 
+#import <StarTrek/STClock.h>
+#import <StarTrek/STPurge.h>
 #import <StarTrek/STArrival.h>
+#import <StarTrek/STDepartureQuota.h>
+#import <StarTrek/STDepartureScheduler.h>
 #import <StarTrek/STDeparture.h>
 #import <StarTrek/STDock.h>
+#import <StarTrek/STPacer.h>
+#import <StarTrek/STCoalescer.h>
+#import <StarTrek/STFrameDecoder.h>
+#import <StarTrek/STArrivalDispatcher.h>
+#import <StarTrek/STPayloadCodec.h>
 #import <StarTrek/STStarDocker.h>
+#import <StarTrek/STAdvancePartyCache.h>
 #import <StarTrek/STStarGate.h>
@@ -72,6 +72,16 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (NSInteger)sendData:(NSData *)data;
 
+/**
+ *  Send remaining bytes of data, for resuming a partially sent package
+ *  without cutting it into a new data object
+ *
+ * @param data        - outgo data package
+ * @param offset      - bytes sent before
+ * @return count of bytes sent (from the offset)
+ */
+- (NSInteger)sendData:(NSData *)data offset:(NSUInteger)offset;
+
 /**
  *  Process received data
  *
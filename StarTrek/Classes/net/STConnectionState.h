@@ -59,10 +59,16 @@ typedef NS_ENUM(UInt8, STConnectionStateOrder) {
  *      EXPIRED     - long time, needs maintaining (still connected/bound)
  *      MAINTAINING - sent 'PING', waiting for response
  *      ERROR       - long long time no response, connection lost
+ *
+ *  States (and their transitions) are immutable after built,
+ *  so they can be shared by all connection state machines;
+ *  the time of entering current state is kept in the machine.
  */
 @interface STConnectionState : SMState
 
-@property(nonatomic, readonly) NSTimeInterval enterTime;
+// states are shared by all machines, so this is always 0 now
+@property(nonatomic, readonly) NSTimeInterval enterTime
+__attribute__((deprecated("use 'enterTime' of STConnectionStateMachine instead")));
 
 @end
 
@@ -56,23 +56,15 @@ static inline NSString *get_name(STConnectionStateOrder order) {
     return [s_names objectAtIndex:order];
 }
 
-@interface STConnectionState () {
-    
-    NSTimeInterval _enterTime;
-}
-
-@end
-
 @implementation STConnectionState
 
-/* designated initializer */
-- (instancetype)initWithIndex:(NSUInteger)stateIndex
-                    capacity:(NSUInteger)countOfTransitions {
-    if (self = [super initWithIndex:stateIndex capacity:countOfTransitions]) {
-        _enterTime = 0;
-    }
-    return self;
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+- (NSTimeInterval)enterTime {
+    // shared state, the time is kept in the machine
+    return 0;
 }
+#pragma clang diagnostic pop
 
 - (BOOL)isEqual:(id)object {
     if ([object isKindOfClass:[STConnectionState class]]) {
@@ -93,22 +85,19 @@ static inline NSString *get_name(STConnectionStateOrder order) {
     return get_name([self index]);
 }
 
-- (NSTimeInterval)enterTime {
-    return _enterTime;
-}
-
 //
 //  FSM Delegate
 //
 
 // Override
-- (void)onEnter:(id<SMState>)previous machine:(id<SMContext>)ctx time:(NSTimeInterval)now {
-    _enterTime = now;
+- (void)onEnter:(id<SMState>)previous machine:(STConnectionStateMachine *)ctx time:(NSTimeInterval)now {
+    // shared state, keep the time in the machine
+    [ctx setEnterTime:now];
 }
 
 // Override
-- (void)onExit:(id<SMState>)next machine:(id<SMContext>)ctx time:(NSTimeInterval)now {
-    _enterTime = 0;
+- (void)onExit:(id<SMState>)next machine:(STConnectionStateMachine *)ctx time:(NSTimeInterval)now {
+    [ctx setEnterTime:0];
 }
 
 // Override
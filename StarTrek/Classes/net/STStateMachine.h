@@ -45,10 +45,32 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property(nonatomic, weak, readonly) id<STConnection> connection;
 
+// time of entering current state, 0 means not entered
+@property(nonatomic, assign) NSTimeInterval enterTime;
+
 - (instancetype)initWithConnection:(id<STConnection>)connection;
 
+/**
+ *  Get states for this machine
+ *
+ *  Default states are built only once and shared by all machines,
+ *  override it to build a different graph with STConnectionStateBuilder
+ *
+ * @return connection states (ordered by index)
+ */
 // protected
-- (STConnectionStateBuilder *)createStateBuilder;
+- (NSArray<STConnectionState *> *)createStates;
+
+/**
+ *  Get builder for states of this machine
+ *
+ *  Only used when overridden, each machine will have its own states then
+ *
+ * @return connection state builder
+ */
+// protected
+- (STConnectionStateBuilder *)createStateBuilder
+__attribute__((deprecated("override 'createStates' instead")));
 
 @end
 
@@ -83,6 +105,10 @@ NS_ASSUME_NONNULL_BEGIN
  *
  */
 
+/**
+ *  Transitions are evaluated by C functions without capturing anything,
+ *  they read the connection from the machine when evaluating.
+ */
 @interface STConnectionStateTransitionBuilder : NSObject
 
 // Default -> Preparing
@@ -34,11 +34,74 @@
 //  Created by Albert Moky on 2023/3/7.
 //
 
+#import <ObjectKey/ObjectKey.h>
+
 #import "STConnection.h"
 #import "STConnectionState.h"
 
 #import "STStateMachine.h"
 
+typedef BOOL (*STConnectionEvaluator)(STConnectionStateMachine *machine,
+                                      NSTimeInterval now);
+
+/**
+ *  Transition evaluated by C function
+ */
+@interface __FunctionTransition : SMTransition
+
+@property(nonatomic, readonly) STConnectionEvaluator evaluator;
+
+- (instancetype)initWithTarget:(NSUInteger)stateIndex
+                     evaluator:(STConnectionEvaluator)func;
+
+@end
+
+@implementation __FunctionTransition
+
+- (instancetype)initWithTarget:(NSUInteger)stateIndex
+                     evaluator:(STConnectionEvaluator)func {
+    if (self = [super initWithTarget:stateIndex]) {
+        _evaluator = func;
+    }
+    return self;
+}
+
+// Override
+- (BOOL)evaluate:(STConnectionStateMachine *)ctx time:(NSTimeInterval)now {
+    return _evaluator(ctx, now);
+}
+
+@end
+
+#pragma mark -
+
+// states shared by all machines
+static NSArray<STConnectionState *> *s_states = nil;
+
+static inline STConnectionStateBuilder *default_builder(void) {
+    STConnectionStateTransitionBuilder *stb;
+    stb = [[STConnectionStateTransitionBuilder alloc] init];
+    return [[STConnectionStateBuilder alloc] initWithTransitionBuilder:stb];
+}
+
+static inline NSArray<STConnectionState *> *build_states(STConnectionStateBuilder *builder) {
+    return @[
+        [builder defaultState],
+        [builder preparingState],
+        [builder readyState],
+        [builder expiredState],
+        [builder maintainingState],
+        [builder errorState],
+    ];
+}
+
+static inline NSArray<STConnectionState *> *shared_states(void) {
+    OKSingletonDispatchOnce(^{
+        s_states = build_states(default_builder());
+    });
+    return s_states;
+}
+
 @interface STConnectionStateMachine ()
 
 @property(nonatomic, weak) id<STConnection> connection;
@@ -50,22 +113,30 @@
 - (instancetype)initWithConnection:(id<STConnection>)connection {
     if (self = [super initWithCapacity:6]) {
         self.connection = connection;
+        self.enterTime = 0;
         // init states
-        STConnectionStateBuilder *builder = [self createStateBuilder];
-        [self addState:[builder defaultState]];
-        [self addState:[builder preparingState]];
-        [self addState:[builder readyState]];
-        [self addState:[builder expiredState]];
-        [self addState:[builder maintainingState]];
-        [self addState:[builder errorState]];
+        for (STConnectionState *state in [self createStates]) {
+            [self addState:state];
+        }
     }
     return self;
 }
 
+- (NSArray<STConnectionState *> *)createStates {
+    SEL selector = @selector(createStateBuilder);
+    if ([self methodForSelector:selector] !=
+        [STConnectionStateMachine instanceMethodForSelector:selector]) {
+        // subclass still builds its own states
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-declarations"
+        return build_states([self createStateBuilder]);
+#pragma clang diagnostic pop
+    }
+    return shared_states();
+}
+
 - (STConnectionStateBuilder *)createStateBuilder {
-    STConnectionStateTransitionBuilder *stb;
-    stb = [[STConnectionStateTransitionBuilder alloc] init];
-    return [[STConnectionStateBuilder alloc] initWithTransitionBuilder:stb];
+    return default_builder();
 }
 
 // Override
@@ -78,146 +149,178 @@
 #pragma mark -
 
 static inline id<SMTransition> create_transition(NSUInteger stateIndex,
-                                                 SMBlock block) {
-    return [[SMBlockTransition alloc] initWithTarget:stateIndex block:block];
+                                                 STConnectionEvaluator func) {
+    return [[__FunctionTransition alloc] initWithTarget:stateIndex evaluator:func];
+}
+
+// Default -> Preparing
+static BOOL default_preparing(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    // connection started? change state to 'preparing'
+    return [conn isOpen];
+}
+
+// Preparing -> Ready
+static BOOL preparing_ready(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    // connected or bound, change state to 'ready'
+    return [conn isAlive];
+}
+
+// Preparing -> Default
+static BOOL preparing_default(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    // connection stopped, change state to 'not_connect'
+    return ![conn isOpen];
+}
+
+// Ready -> Expired
+static BOOL ready_expired(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return NO;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection still alive, but
+    // long time no response, change state to 'maintain_expired'
+    return ![timed isReceivedRecently:now];
+}
+
+// Ready -> Error
+static BOOL ready_error(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    // connection lost, change state to 'error'
+    return ![conn isAlive];
+}
+
+// Expired -> Maintaining
+static BOOL expired_maintaining(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return NO;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection still alive, and
+    // sent recently, change state to 'maintaining'
+    return [timed isSentRecently:now];
+}
+
+// Expired -> Error
+static BOOL expired_error(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return YES;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection lost, or
+    // long long time no response, change state to 'error'
+    return [timed isNotReceivedLongTimeAgo:now];
+}
+
+// Maintaining -> Ready
+static BOOL maintaining_ready(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return NO;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection still alive, and
+    // received recently, change state to 'ready'
+    return [timed isReceivedRecently:now];
+}
+
+// Maintaining -> Expired
+static BOOL maintaining_expired(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return NO;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection still alive, but
+    // long time no sending, change state to 'maintain_expired'
+    return ![timed isSentRecently:now];
+}
+
+// Maintaining -> Error
+static BOOL maintaining_error(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return YES;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection lost, or
+    // long long time no response, change state to 'error'
+    return [timed isNotReceivedLongTimeAgo:now];
+}
+
+// Error -> Default
+static BOOL error_default(STConnectionStateMachine *machine, NSTimeInterval now) {
+    id<STConnection> conn = [machine connection];
+    if (![conn isAlive]) {
+        return NO;
+    }
+    id<STTimedConnection> timed = (id<STTimedConnection>)conn;
+    // connection still alive, and
+    // can receive data during this state
+    NSTimeInterval enter = [machine enterTime];
+    return 0 < enter && enter < [timed lastReceivedTime];
 }
 
 @implementation STConnectionStateTransitionBuilder
 
 // Default -> Preparing
 - (SMTransition *)defaultPreparingTransition {
-    return create_transition(STConnectionStateOrderPreparing, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        // connection started? change state to 'preparing'
-        return [conn isOpen];
-    });
+    return create_transition(STConnectionStateOrderPreparing, default_preparing);
 }
 
 // Preparing -> Ready
 - (SMTransition *)preparingReadyTransition {
-    return create_transition(STConnectionStateOrderReady, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        // connected or bound, change state to 'ready'
-        return [conn isAlive];
-    });
+    return create_transition(STConnectionStateOrderReady, preparing_ready);
 }
 
 // Preparing -> Default
 - (SMTransition *)preparingDefaultTransition {
-    return create_transition(STConnectionStateOrderDefault, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        // connection stopped, change state to 'not_connect'
-        return ![conn isOpen];
-    });
+    return create_transition(STConnectionStateOrderDefault, preparing_default);
 }
 
 // Ready -> Expired
 - (SMTransition *)readyExpiredTransition {
-    return create_transition(STConnectionStateOrderExpired, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return NO;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection still alive, but
-        // long time no response, change state to 'maintain_expired'
-        return ![timed isReceivedRecently:now];
-    });
+    return create_transition(STConnectionStateOrderExpired, ready_expired);
 }
 
 // Ready -> Error
 - (SMTransition *)readyErrorTransition {
-    return create_transition(STConnectionStateOrderError, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        // connection lost, change state to 'error'
-        return ![conn isAlive];
-    });
+    return create_transition(STConnectionStateOrderError, ready_error);
 }
 
 // Expired -> Maintaining
 - (SMTransition *)expiredMaintainingTransition {
-    return create_transition(STConnectionStateOrderMaintaining, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return NO;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection still alive, and
-        // sent recently, change state to 'maintaining'
-        return [timed isSentRecently:now];
-    });
+    return create_transition(STConnectionStateOrderMaintaining, expired_maintaining);
 }
 
 // Expired -> Error
 - (SMTransition *)expiredErrorTransition {
-    return create_transition(STConnectionStateOrderError, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return YES;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection lost, or
-        // long long time no response, change state to 'error'
-        return [timed isNotReceivedLongTimeAgo:now];
-    });
+    return create_transition(STConnectionStateOrderError, expired_error);
 }
 
 // Maintaining -> Ready
 - (SMTransition *)maintainingReadyTransition {
-    return create_transition(STConnectionStateOrderReady, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return NO;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection still alive, and
-        // received recently, change state to 'ready'
-        return [timed isReceivedRecently:now];
-    });
+    return create_transition(STConnectionStateOrderReady, maintaining_ready);
 }
 
 // Maintaining -> Expired
 - (SMTransition *)maintainingExpiredTransition {
-    return create_transition(STConnectionStateOrderExpired, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return NO;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection still alive, but
-        // long time no sending, change state to 'maintain_expired'
-        return ![timed isSentRecently:now];
-    });
+    return create_transition(STConnectionStateOrderExpired, maintaining_expired);
 }
 
 // Maintaining -> Error
 - (SMTransition *)maintainingErrorTransition {
-    return create_transition(STConnectionStateOrderError, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return YES;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection lost, or
-        // long long time no response, change state to 'error'
-        return [timed isNotReceivedLongTimeAgo:now];
-    });
+    return create_transition(STConnectionStateOrderError, maintaining_error);
 }
 
 // Error -> Default
 - (SMTransition *)errorDefaultTransition {
-    return create_transition(STConnectionStateOrderDefault, ^BOOL(STConnectionStateMachine *machine, NSTimeInterval now) {
-        id<STConnection> conn = [machine connection];
-        if (![conn isAlive]) {
-            return NO;
-        }
-        id<STTimedConnection> timed = (id<STTimedConnection>)conn;
-        // connection still alive, and
-        // can receive data during this state
-        STConnectionState *current = [machine currentState];
-        NSTimeInterval enter = [current enterTime];
-        return 0 < enter && enter < [timed lastReceivedTime];
-    });
+    return create_transition(STConnectionStateOrderDefault, error_default);
 }
 
 @end
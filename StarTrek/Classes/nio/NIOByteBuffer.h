@@ -541,6 +541,31 @@ NS_DESIGNATED_INITIALIZER;
 
 @end
 
+@interface NIOByteBuffer (Direct)
+
+/**
+ * Returns the backing bytes at this buffer's current position,
+ * <tt>remaining()</tt> bytes can be read without copying.
+ *
+ * <p> The pointer is valid until the buffer is modified or released. </p>
+ *
+ * @return  The bytes at the buffer's current position
+ */
+- (const void *)readableBytes;
+
+/**
+ * Returns the backing bytes at this buffer's current position,
+ * <tt>remaining()</tt> bytes can be written without copying,
+ * the position should be moved after writing.
+ *
+ * <p> The pointer is valid until the buffer is modified or released. </p>
+ *
+ * @return  The bytes at the buffer's current position
+ */
+- (void *)writableBytes;
+
+@end
+
 #pragma mark -
 
 
@@ -354,6 +354,20 @@
 
 @end
 
+@implementation NIOByteBuffer (Direct)
+
+- (const void *)readableBytes {
+    const unsigned char *bytes = self.hb.bytes;
+    return bytes + self.offset + self.position;
+}
+
+- (void *)writableBytes {
+    unsigned char *bytes = self.hb.mutableBytes;
+    return bytes + self.offset + self.position;
+}
+
+@end
+
 #pragma mark -
 
 @implementation NIOHeapByteBuffer
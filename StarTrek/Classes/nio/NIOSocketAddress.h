@@ -6,6 +6,7 @@
 //
 
 #import <Foundation/Foundation.h>
+#import <sys/socket.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -34,5 +35,40 @@ NS_DESIGNATED_INITIALIZER;
 
 @end
 
+/**
+ *  Binary Socket Address
+ *  ~~~~~~~~~~~~~~~~~~~~~
+ *
+ *  IPv4/IPv6 endpoint kept in binary form,
+ *  hash is computed once, comparing with memcmp,
+ *  host & description are formatted only when needed.
+ *
+ *  Addresses created by the factories are interned,
+ *  so same endpoint returns same instance while it's alive.
+ *  A numeric NIOInetSocketAddress has the same hash for the same endpoint,
+ *  and is equal to it only when the scope id is zero (host has no scope).
+ */
+@interface NIOBinarySocketAddress : NSObject <NIOSocketAddress, NSCopying>
+
+@property(nonatomic, readonly) const struct sockaddr *sockaddr;
+@property(nonatomic, readonly) socklen_t sockaddrLength;
+
+- (nullable instancetype)initWithSockAddr:(const struct sockaddr *)addr
+                                   length:(socklen_t)len
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@interface NIOBinarySocketAddress (Creation)
+
+// interned, nil when the family is not AF_INET/AF_INET6
++ (nullable instancetype)addressWithSockAddr:(const struct sockaddr *)addr
+                                      length:(socklen_t)len;
+
+// interned, nil when the host is not a numeric IP
++ (nullable instancetype)addressWithHost:(NSString *)ip port:(UInt16)port;
+
+@end
+
 
 NS_ASSUME_NONNULL_END
@@ -5,11 +5,78 @@
 //  Created by Albert Moky on 2023/3/8.
 //
 
+#import <ObjectKey/ObjectKey.h>
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+
 #import "NIOSocketAddress.h"
 
-@interface NIOInetSocketAddress ()
+/**
+ *  Canonical form of IPv4/IPv6 endpoint,
+ *  unused bytes are always zero, so it can be compared with memcmp.
+ */
+typedef struct {
+    UInt8  family;    // AF_INET or AF_INET6
+    UInt8  reserved;
+    UInt16 port;      // host byte order
+    UInt32 scope;     // IPv6 scope id
+    UInt8  addr[16];  // IPv4 uses the first 4 bytes
+} NIOAddressKey;
+
+// FNV-1a
+static inline NSUInteger address_key_hash(const NIOAddressKey *key) {
+    const UInt8 *bytes = (const UInt8 *)key;
+    UInt64 h = 14695981039346656037ULL;
+    for (NSUInteger i = 0; i < sizeof(NIOAddressKey); ++i) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return (NSUInteger)h;
+}
+
+// parse numeric host, return false for domain name
+static inline BOOL address_key_parse(NIOAddressKey *key, NSString *host, UInt16 port) {
+    memset(key, 0, sizeof(NIOAddressKey));
+    const char *ip = [host UTF8String];
+    if (!ip) {
+        return NO;
+    } else if (inet_pton(AF_INET, ip, key->addr) == 1) {
+        key->family = AF_INET;
+    } else if (inet_pton(AF_INET6, ip, key->addr) == 1) {
+        key->family = AF_INET6;
+    } else {
+        return NO;
+    }
+    key->port = port;
+    return YES;
+}
+
+static inline BOOL address_key_from_sockaddr(NIOAddressKey *key, const struct sockaddr *sa, socklen_t len) {
+    memset(key, 0, sizeof(NIOAddressKey));
+    if (sa->sa_family == AF_INET && len >= sizeof(struct sockaddr_in)) {
+        const struct sockaddr_in *sin = (const struct sockaddr_in *)sa;
+        key->family = AF_INET;
+        key->port = ntohs(sin->sin_port);
+        memcpy(key->addr, &sin->sin_addr, 4);
+    } else if (sa->sa_family == AF_INET6 && len >= sizeof(struct sockaddr_in6)) {
+        const struct sockaddr_in6 *sin6 = (const struct sockaddr_in6 *)sa;
+        key->family = AF_INET6;
+        key->port = ntohs(sin6->sin6_port);
+        key->scope = sin6->sin6_scope_id;
+        memcpy(key->addr, &sin6->sin6_addr, 16);
+    } else {
+        return NO;
+    }
+    return YES;
+}
+
+@interface NIOInetSocketAddress () {
 
-@property(nonatomic, strong) NSString *desc;
+    NSUInteger _hash;
+}
+
+@property(atomic, strong, nullable) NSString *desc;  // lazy
 
 @property(nonatomic, strong) NSString *host;
 @property(nonatomic, assign) UInt16 port;
@@ -29,7 +96,14 @@
     if (self = [super init]) {
         self.host = ip;
         self.port = port;
-        self.desc = [NSString stringWithFormat:@"('%@', %u)", _host, _port];
+        self.desc = nil;
+        // numeric host shares the hash with binary address
+        NIOAddressKey key;
+        if (address_key_parse(&key, ip, port)) {
+            _hash = address_key_hash(&key);
+        } else {
+            _hash = [ip hash] + port * 13;
+        }
     }
     return self;
 }
@@ -37,28 +111,45 @@
 #pragma mark Object
 
 - (NSString *)description {
-    return _desc;
+    NSString *text = self.desc;
+    if (!text) {
+        text = [NSString stringWithFormat:@"('%@', %u)", _host, _port];
+        self.desc = text;
+    }
+    return text;
 }
 
 - (NSString *)debugDescription {
-    return _desc;
+    return [self description];
 }
 
 - (NSUInteger)hash {
-    return [_host hash] + _port * 13;
+    return _hash;
 }
 
 - (BOOL)isEqual:(id)object {
-    if ([object conformsToProtocol:@protocol(NIOSocketAddress)]) {
+    if ([object isKindOfClass:[NIOBinarySocketAddress class]]) {
+        return [object isEqual:self];
+    } else if ([object conformsToProtocol:@protocol(NIOSocketAddress)]) {
         // compare with wrapper
         if (object == self) {
             return YES;
         }
         // compare with host & port
         id<NIOSocketAddress> other = (id<NIOSocketAddress>)object;
-        return other.port == _port && [other.host isEqualToString:_host];
+        if (other.port != _port) {
+            return NO;
+        }
+        // numeric hosts are compared in canonical form,
+        // so '::1' equals '0:0::1' as the binary address does
+        NIOAddressKey key1, key2;
+        if (address_key_parse(&key1, _host, _port)) {
+            return address_key_parse(&key2, other.host, other.port) &&
+                memcmp(&key1, &key2, sizeof(NIOAddressKey)) == 0;
+        }
+        return [other.host isEqualToString:_host];
     } else if ([object isKindOfClass:[NSString class]]) {
-        return [_desc isEqual:object];
+        return [[self description] isEqual:object];
     }
     return NO;
 }
@@ -74,3 +165,219 @@
 }
 
 @end
+
+#pragma mark -
+
+@interface NIOBinarySocketAddress () {
+
+    NIOAddressKey _key;
+    NSUInteger _hash;
+
+    struct sockaddr_storage _storage;
+    socklen_t _length;
+}
+
+// shared by threads after interned
+@property(nonatomic, strong, nullable) NSString *host;  // lazy, locked
+@property(atomic, strong, nullable) NSString *desc;     // lazy
+
+@end
+
+@implementation NIOBinarySocketAddress
+
+- (instancetype)init {
+    NSAssert(false, @"DON'T call me");
+    return [self initWithSockAddr:NULL length:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithSockAddr:(const struct sockaddr *)addr length:(socklen_t)len {
+    if (self = [super init]) {
+        if (!addr || !address_key_from_sockaddr(&_key, addr, len)) {
+            return nil;
+        }
+        _hash = address_key_hash(&_key);
+        // rebuild sockaddr from the canonical key
+        memset(&_storage, 0, sizeof(_storage));
+        if (_key.family == AF_INET) {
+            struct sockaddr_in *sin = (struct sockaddr_in *)&_storage;
+            sin->sin_family = AF_INET;
+            sin->sin_port = htons(_key.port);
+            memcpy(&sin->sin_addr, _key.addr, 4);
+            _length = sizeof(struct sockaddr_in);
+        } else {
+            struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&_storage;
+            sin6->sin6_family = AF_INET6;
+            sin6->sin6_port = htons(_key.port);
+            sin6->sin6_scope_id = _key.scope;
+            memcpy(&sin6->sin6_addr, _key.addr, 16);
+            _length = sizeof(struct sockaddr_in6);
+        }
+#ifdef SIN6_LEN
+        _storage.ss_len = _length;
+#endif
+        self.host = nil;
+        self.desc = nil;
+    }
+    return self;
+}
+
+- (const struct sockaddr *)sockaddr {
+    return (const struct sockaddr *)&_storage;
+}
+
+- (socklen_t)sockaddrLength {
+    return _length;
+}
+
+// Override
+- (NSString *)host {
+    @synchronized (self) {
+        if (!_host) {
+            char buf[INET6_ADDRSTRLEN];
+            if (inet_ntop(_key.family, _key.addr, buf, sizeof(buf))) {
+                _host = [[NSString alloc] initWithUTF8String:buf];
+            } else {
+                _host = @"";
+            }
+        }
+        return _host;
+    }
+}
+
+// Override
+- (UInt16)port {
+    return _key.port;
+}
+
+#pragma mark Object
+
+- (NSString *)description {
+    NSString *text = self.desc;
+    if (!text) {
+        text = [NSString stringWithFormat:@"('%@', %u)", [self host], _key.port];
+        self.desc = text;
+    }
+    return text;
+}
+
+- (NSString *)debugDescription {
+    return [self description];
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (object == self) {
+        // interned
+        return YES;
+    } else if ([object isKindOfClass:[NIOBinarySocketAddress class]]) {
+        NIOBinarySocketAddress *other = (NIOBinarySocketAddress *)object;
+        return other->_hash == _hash && memcmp(&other->_key, &_key, sizeof(NIOAddressKey)) == 0;
+    } else if ([object conformsToProtocol:@protocol(NIOSocketAddress)]) {
+        // compare with numeric host & port,
+        // a host string carries no scope id, so it only equals the unscoped endpoint
+        id<NIOSocketAddress> other = (id<NIOSocketAddress>)object;
+        NIOAddressKey key;
+        if (!address_key_parse(&key, other.host, other.port)) {
+            return NO;
+        }
+        return memcmp(&key, &_key, sizeof(NIOAddressKey)) == 0;
+    } else if ([object isKindOfClass:[NSString class]]) {
+        return [[self description] isEqual:object];
+    }
+    return NO;
+}
+
+// Override
+- (id)copyWithZone:(nullable NSZone *)zone {
+    // immutable
+    return self;
+}
+
+@end
+
+@implementation NIOBinarySocketAddress (Creation)
+
+#define ADDRESS_INTERN_STRIPES 16  // power of 2
+
+// weak tables, endpoints not referenced any more will be removed;
+// striped by key hash, each stripe is locked by its own table
+static NSHashTable<NIOBinarySocketAddress *> *s_interned[ADDRESS_INTERN_STRIPES];
+// reusable lookup keys, one for each stripe, only touched under its lock
+static NIOBinarySocketAddress *s_probes[ADDRESS_INTERN_STRIPES];
+
+static inline NIOBinarySocketAddress *intern_member(NSUInteger stripe, const NIOAddressKey *key, NSUInteger hash) {
+    NIOBinarySocketAddress *probe = s_probes[stripe];
+    probe->_key = *key;
+    probe->_hash = hash;
+    return [s_interned[stripe] member:probe];
+}
+
++ (nullable instancetype)addressWithSockAddr:(const struct sockaddr *)addr length:(socklen_t)len {
+    NIOAddressKey key;
+    if (!addr || !address_key_from_sockaddr(&key, addr, len)) {
+        return nil;
+    }
+    OKSingletonDispatchOnce(^{
+        struct sockaddr_in sin;
+        memset(&sin, 0, sizeof(sin));
+        sin.sin_family = AF_INET;
+        for (NSUInteger i = 0; i < ADDRESS_INTERN_STRIPES; ++i) {
+            s_interned[i] = [NSHashTable weakObjectsHashTable];
+            s_probes[i] = [[NIOBinarySocketAddress alloc] initWithSockAddr:(const struct sockaddr *)&sin
+                                                                    length:sizeof(sin)];
+        }
+    });
+    NSUInteger hash = address_key_hash(&key);
+    NSUInteger stripe = hash & (ADDRESS_INTERN_STRIPES - 1);
+    NSHashTable<NIOBinarySocketAddress *> *table = s_interned[stripe];
+    // 1. probe with the stack key, no allocation for a known endpoint
+    NIOBinarySocketAddress *cached;
+    @synchronized (table) {
+        cached = intern_member(stripe, &key, hash);
+    }
+    if (cached) {
+        return cached;
+    }
+    // 2. create outside the lock, check again before adding
+    NIOBinarySocketAddress *address;
+    address = [[NIOBinarySocketAddress alloc] initWithSockAddr:addr length:len];
+    @synchronized (table) {
+        cached = [table member:address];
+        if (cached) {
+            return cached;
+        }
+        [table addObject:address];
+    }
+    return address;
+}
+
++ (nullable instancetype)addressWithHost:(NSString *)ip port:(UInt16)port {
+    NIOAddressKey key;
+    if (!address_key_parse(&key, ip, port)) {
+        // not a numeric host
+        return nil;
+    }
+    struct sockaddr_storage storage;
+    memset(&storage, 0, sizeof(storage));
+    socklen_t len;
+    if (key.family == AF_INET) {
+        struct sockaddr_in *sin = (struct sockaddr_in *)&storage;
+        sin->sin_family = AF_INET;
+        sin->sin_port = htons(port);
+        memcpy(&sin->sin_addr, key.addr, 4);
+        len = sizeof(struct sockaddr_in);
+    } else {
+        struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&storage;
+        sin6->sin6_family = AF_INET6;
+        sin6->sin6_port = htons(port);
+        memcpy(&sin6->sin6_addr, key.addr, 16);
+        len = sizeof(struct sockaddr_in6);
+    }
+    return [self addressWithSockAddr:(const struct sockaddr *)&storage length:len];
+}
+
+@end
@@ -91,7 +91,7 @@ STDockerStatus STDockerStatusFromConnectionState(STConnectionState *state);
  *  to the waiting queue for sending out
  *
  * @param ship - outgo ship carrying data package/fragment
- * @return false on duplicated
+ * @return false on duplicated, or the waiting queue is full
  */
 - (BOOL)sendShip:(id<STDeparture>)ship;
 
@@ -164,6 +164,26 @@ STDockerStatus STDockerStatusFromConnectionState(STConnectionState *state);
  */
 - (void)docker:(id<STDocker>)worker changedStatus:(STDockerStatus)previous toStatus:(STDockerStatus)current;
 
+@optional
+
+/**
+ *  Callback when packages sent (responded in one batch),
+ *  if not implemented, 'docker:sentShip:' will be called for each one
+ *
+ * @param departures  - outgo data package containers
+ * @param worker      - connection docker
+ */
+- (void)docker:(id<STDocker>)worker sentShips:(NSArray<id<STDeparture>> *)departures;
+
+/**
+ *  Callback when the departure queue reached the high watermark (not writable),
+ *  or drained to the low watermark (writable again)
+ *
+ * @param writable    - whether more ships can be sent now
+ * @param worker      - connection docker
+ */
+- (void)docker:(id<STDocker>)worker changedWritable:(BOOL)writable;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -57,6 +57,17 @@ typedef NS_ENUM(UInt8, STShipStatus) {
 
 #define STShipID NSCopying
 
+/*  Maximum Segment Size
+ *  ~~~~~~~~~~~~~~~~~~~~
+ *  Buffer size for receiving package
+ *
+ *  MTU        : 1500 bytes (excludes 14 bytes ethernet header & 4 bytes FCS)
+ *  IP header  :   20 bytes
+ *  TCP header :   20 bytes
+ *  UDP header :    8 bytes
+ */
+#define ST_MSS 1472  // 1500 - 20 - 8
+
 /**
  *  Star Ship
  *  ~~~~~~~~~
@@ -103,6 +114,17 @@ typedef NS_ENUM(UInt8, STShipStatus) {
  */
 - (nullable id<STArrival>)assembleArrivalShip:(id<STArrival>)income;
 
+@optional
+
+/**
+ *  SN list of all departures acknowledged by this response
+ *  (cumulative or range acks), each linked departure will check
+ *  which pages are responded in 'checkResponseWithinArrivalShip:'
+ *
+ * @return nil/empty for responding the ship with same SN only
+ */
+@property(nonatomic, readonly, nullable) NSArray<id<STShipID>> *respondedShipIDs;
+
 @end
 
 /**
@@ -141,8 +163,32 @@ typedef NS_ENUM(UInt8, STShipStatus) {
  */
 @property(nonatomic, readonly) NSInteger priority;
 
+@optional
+
+/**
+ *  Absolute time after which the task is useless,
+ *  it will be dropped instead of sent/retried
+ *
+ * @return 0 for never expired
+ */
+@property(nonatomic, readonly) NSTimeInterval deadline;
+
 @end
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// get deadline of departure task, 0 for never expired
+NSTimeInterval STDepartureDeadline(id<STDeparture> ship);
+
+// check whether the departure task is expired at this time
+BOOL STDepartureIsExpired(id<STDeparture> ship, NSTimeInterval now);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
 typedef NS_ENUM(NSInteger, STDeparturePriority) {
     STDeparturePriorityUrgent = -1,
     STDeparturePriorityNormal =  0,
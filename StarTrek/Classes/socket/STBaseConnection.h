@@ -35,17 +35,41 @@
 //
 
 #import <StarTrek/STAddressPairObject.h>
+#import <StarTrek/STClock.h>
 #import <StarTrek/STChannel.h>
 #import <StarTrek/STConnection.h>
 #import <StarTrek/STConnectionState.h>
 #import <StarTrek/STStateMachine.h>
 #import <StarTrek/STHub.h>
 
+@protocol STConnectionReadySet <NSObject>
+
+/**
+ *  Called when something happened to the connection
+ *  (data received/sent, channel changed, state changed),
+ *  the state machine should be evaluated in next turn
+ */
+- (void)connectionReady:(id<STConnection>)conn;
+
+/**
+ *  Called when the connection should be evaluated at a time
+ *  (next expiring boundary), even if nothing happened
+ */
+- (void)connection:(id<STConnection>)conn readyAtTime:(NSTimeInterval)when;
+
+@end
+
 @interface STConnection : STAddressPairObject <STConnection, STTimedConnection, STConnectionStateDelegate>
 
 @property(nonatomic, weak) id<STConnectionDelegate> delegate;  // delegate for handling connection events
 @property(nonatomic, weak) id<STChannel> channel;  // socket channel
 
+// notified when the state machine needs to be ticked
+@property(nonatomic, weak) id<STConnectionReadySet> readySet;
+
+// time source for active times (replaced by the hub's clock)
+@property(nonatomic, strong) STClock *clock;
+
 - (instancetype)initWithChannel:(id<STChannel>)channel
                   remoteAddress:(id<NIOSocketAddress>)remote
                    localAddress:(id<NIOSocketAddress>)local;
@@ -58,6 +82,15 @@
 - (void)start;
 - (void)stop;
 
+/**
+ *  Get next time to evaluate the state machine when nothing happened
+ *
+ * @param now - current time
+ * @return time when current state may be expired
+ */
+// protected
+- (NSTimeInterval)nextEvaluationTime:(NSTimeInterval)now;
+
 // protected
 - (NSInteger)sendBuffer:(NIOByteBuffer *)src remoteAddress:(id<NIOSocketAddress>)destination
                  throws:(NIOException **)error;
@@ -40,6 +40,13 @@
 
 #define CONNECTION_EXPIRES 16.0  // seconds
 
+// polling interval for unsteady states (default, preparing, error),
+// active connection will try to reconnect in error state
+#define CONNECTION_PENDING_INTERVAL 0.25
+
+// checking interval for channel lost in steady states
+#define CONNECTION_ALIVE_INTERVAL (CONNECTION_EXPIRES / 4)
+
 @interface STConnection () {
     
     NSTimeInterval _lastSentTime;
@@ -60,6 +67,8 @@
     if (self = [super initWithRemoteAddress:remote localAddress:local]) {
         self.channel = channel;
         self.delegate = nil;
+        self.readySet = nil;
+        self.clock = [STClock defaultClock];
         
         // active time
         _lastSentTime = 0;
@@ -118,6 +127,10 @@
             [oldChannel disconnect];
         }
     }
+    // 3. channel changed, evaluate the state
+    if (oldChannel != newChannel) {
+        [_readySet connectionReady:self];
+    }
 }
 
 // Override
@@ -162,6 +175,7 @@
     STConnectionStateMachine *machine = [self createStateMachine];
     [machine start];
     [self setStateMachine:machine];
+    [_readySet connectionReady:self];
 }
 
 - (void)stop {
@@ -175,7 +189,12 @@
 
 // Override
 - (void)onReceivedData:(NSData *)data {
-    _lastReceivedTime = OKGetCurrentTimeInterval();
+    _lastReceivedTime = [_clock now];
+    // in 'ready' state, receiving only delays the expiring,
+    // other states may change on data received
+    if (![self isStateIndex:STConnectionStateOrderReady]) {
+        [_readySet connectionReady:self];
+    }
     [_delegate connection:self receivedData:data];
 }
 
@@ -204,13 +223,22 @@
     }
     if (sent > 0) {
         // update sent time
-        _lastSentTime = OKGetCurrentTimeInterval();
+        _lastSentTime = [_clock now];
+        // 'expired' state will change on data sent
+        if ([self isStateIndex:STConnectionStateOrderExpired]) {
+            [_readySet connectionReady:self];
+        }
     }
     return sent;
 }
 
 // Override
 - (NSInteger)sendData:(NSData *)pack {
+    return [self sendData:pack offset:0];
+}
+
+// Override
+- (NSInteger)sendData:(NSData *)pack offset:(NSUInteger)offset {
     // try to send data
     NIOError *error = nil;
     NSInteger sent = -1;
@@ -218,9 +246,10 @@
     NIOException *e = nil;
     // @try
 
-    // prepare buffer
-    NIOByteBuffer *buffer = [NIOByteBuffer bufferWithCapacity:pack.length];
-    [buffer putData:pack];
+    // prepare buffer with the remaining bytes
+    NSUInteger len = pack.length - offset;
+    NIOByteBuffer *buffer = [NIOByteBuffer bufferWithCapacity:len];
+    [buffer putData:pack offset:offset length:len];
     // send buffer
     id<NIOSocketAddress> destination = [self remoteAddress];
     sent = [self sendBuffer:buffer remoteAddress:destination throws:&e];
@@ -253,12 +282,46 @@
     return [machine currentState];
 }
 
+// private
+- (BOOL)isStateIndex:(NSUInteger)index {
+    STConnectionState *current = [self state];
+    return current && current.index == index;
+}
+
 // Override
 - (void)tick:(NSTimeInterval)now elapsed:(NSTimeInterval)delta {
     STConnectionStateMachine *machine = [self stateMachine];
     if (machine) {
         [machine tick:now elapsed:delta];
+        // nothing happens before this time
+        [_readySet connection:self readyAtTime:[self nextEvaluationTime:now]];
+    }
+}
+
+// protected
+- (NSTimeInterval)nextEvaluationTime:(NSTimeInterval)now {
+    NSTimeInterval next;
+    STConnectionState *current = [self state];
+    switch (current.index) {
+        case STConnectionStateOrderReady:
+            // ready -> expired
+            next = _lastReceivedTime + CONNECTION_EXPIRES;
+            break;
+        case STConnectionStateOrderExpired:
+            // expired -> error
+            next = _lastReceivedTime + (CONNECTION_EXPIRES * 8);
+            break;
+        case STConnectionStateOrderMaintaining:
+            // maintaining -> expired, or maintaining -> error
+            next = MIN(_lastSentTime + CONNECTION_EXPIRES,
+                       _lastReceivedTime + (CONNECTION_EXPIRES * 8));
+            break;
+        default:
+            // waiting for channel
+            return now + CONNECTION_PENDING_INTERVAL;
     }
+    // the channel may be lost silently
+    return MIN(next, now + CONNECTION_ALIVE_INTERVAL);
 }
 
 //
@@ -321,6 +384,8 @@
             }
         }
     }
+    // state changed, evaluate the new state in next turn
+    [_readySet connectionReady:self];
     // callback
     [_delegate connection:self changedState:previous toState:current];
 }
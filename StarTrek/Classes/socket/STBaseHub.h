@@ -37,20 +37,31 @@
 #import <StarTrek/STAddressPairMap.h>
 #import <StarTrek/STConnection.h>
 #import <StarTrek/STHub.h>
+#import <StarTrek/STBaseConnection.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface STHub : NSObject <STHub>
+@interface STHub : NSObject <STHub, STConnectionReadySet>
 
 // delegate for handling connection events
 @property(nonatomic, weak, readonly) id<STConnectionDelegate> delegate;
 
+// interval for checking all connections to remove the closed ones
+@property(nonatomic, assign) NSTimeInterval cleanupInterval;
+
+// time source, ticked once per 'process', shared with connections
+// (set it before adding connections)
+@property(nonatomic, strong) STClock *clock;
+
 - (instancetype)initWithConnectionDelegate:(id<STConnectionDelegate>)delegate
 NS_DESIGNATED_INITIALIZER;
 
 // protected
 - (STAddressPairMap<id<STConnection>> *)createConnectionPool;
 
+// protected, override for a coarse or virtual clock (default is system clock)
+- (STClock *)createClock;
+
 @end
 
 // protected
@@ -111,15 +122,35 @@ NS_DESIGNATED_INITIALIZER;
 
 - (NSUInteger)availableInChannel:(id<STChannel>)channel;
 
+/**
+ *  Get channels need to be driven now,
+ *  default is all channels (polling)
+ *
+ * @param now - current time
+ * @return channels to receive data
+ */
+- (NSArray<id<STChannel>> *)readyChannelsWithTime:(NSTimeInterval)now;
+
 - (BOOL)driveChannel:(id<STChannel>)channel;
 
-- (NSInteger)driveChannels:(NSSet<id<STChannel>> *)channels;
+- (NSInteger)driveChannels:(NSArray<id<STChannel>> *)channels;
+
+- (void)cleanupChannels:(NSArray<id<STChannel>> *)channels;
 
-- (void)cleanupChannels:(NSSet<id<STChannel>> *)channels;
+/**
+ *  Get connections need to be driven now:
+ *      1. something happened (data received/sent, state changed, ...);
+ *      2. scheduled time arrived (next expiring boundary);
+ *      3. connections not notifying (not inherited from STConnection).
+ *
+ * @param now - current time
+ * @return connections to be ticked
+ */
+- (NSArray<id<STConnection>> *)readyConnectionsWithTime:(NSTimeInterval)now;
 
-- (void)driveConnections:(NSSet<id<STConnection>> *)connections;
+- (void)driveConnections:(NSArray<id<STConnection>> *)connections;
 
-- (void)cleanupConnections:(NSSet<id<STConnection>> *)connections;
+- (void)cleanupConnections:(NSArray<id<STConnection>> *)connections;
 
 @end
 
@@ -36,9 +36,12 @@
 
 #import <ObjectKey/ObjectKey.h>
 
+#import "STShip.h"
+#import "STConcurrentAddressPairMap.h"
+#import "STReadySet.h"
 #import "STBaseHub.h"
 
-@interface __ConnectionPool : STAddressPairMap<id<STConnection>>
+@interface __ConnectionPool : STConcurrentAddressPairMap<id<STConnection>>
 
 @end
 
@@ -68,24 +71,20 @@
 
 #pragma mark -
 
-/*  Maximum Segment Size
- *  ~~~~~~~~~~~~~~~~~~~~
- *  Buffer size for receiving package
- *
- *  MTU        : 1500 bytes (excludes 14 bytes ethernet header & 4 bytes FCS)
- *  IP header  :   20 bytes
- *  TCP header :   20 bytes
- *  UDP header :    8 bytes
- */
-static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
+static const NSTimeInterval HUB_CLEANUP_INTERVAL = 1.0;
 
 @interface STHub () {
     
-    NSTimeInterval _lastTimeDriveConnections;
+    NSTimeInterval _nextCleanupTime;
 }
 
 @property(nonatomic, strong) STAddressPairMap<id<STConnection>> *connectionPool;
 
+// connection => last tick time
+@property(nonatomic, strong) NSMapTable<id<STConnection>, NSNumber *> *tickTimes;
+
+@property(nonatomic, strong) STReadySet<id<STConnection>> *readySet;
+
 @property(nonatomic, weak) id<STConnectionDelegate> delegate;
 
 @end
@@ -103,7 +102,11 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
     if (self = [super init]) {
         self.delegate = delegate;
         self.connectionPool = [self createConnectionPool];
-        _lastTimeDriveConnections = OKGetCurrentTimeInterval();
+        self.readySet = [[STReadySet alloc] init];
+        self.cleanupInterval = HUB_CLEANUP_INTERVAL;
+        self.clock = [self createClock];
+        self.tickTimes = [NSMapTable weakToStrongObjectsMapTable];
+        _nextCleanupTime = 0;
     }
     return self;
 }
@@ -112,20 +115,39 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
     return [[__ConnectionPool alloc] init];
 }
 
+- (STClock *)createClock {
+    return [STClock defaultClock];
+}
+
 // Override
 - (BOOL)process {
-    // 1. drive all channels to receive data
-    NSSet<id<STChannel>> *channels = [self allChannels];
+    NSTimeInterval now = [_clock tick];
+    // 1. drive ready channels to receive data
+    NSArray<id<STChannel>> *channels = [self readyChannelsWithTime:now];
     NSInteger count = [self driveChannels:channels];
-    // 2. drive all connections to move on
-    NSSet<id<STConnection>> *connections = [self allConnections];
+    // 2. drive ready connections to move on
+    NSArray<id<STConnection>> *connections = [self readyConnectionsWithTime:now];
     [self driveConnections:connections];
     // 3. cleanup closed channels and connections
     [self cleanupChannels:channels];
     [self cleanupConnections:connections];
+    if (now >= _nextCleanupTime) {
+        _nextCleanupTime = now + _cleanupInterval;
+        [self cleanupConnections:[[self allConnections] allObjects]];
+    }
     return count > 0;
 }
 
+// Override
+- (void)connectionReady:(id<STConnection>)conn {
+    [_readySet addObject:conn];
+}
+
+// Override
+- (void)connection:(id<STConnection>)conn readyAtTime:(NSTimeInterval)when {
+    [_readySet addObject:conn time:when];
+}
+
 // Override
 - (nullable id<STConnection>)connectToRemoteAddress:(id<NIOSocketAddress>)remote
                                        localAddress:(nullable id<NIOSocketAddress>)local {
@@ -203,6 +225,15 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
         remoteAddress:(id<NIOSocketAddress>)remote
          localAddress:(id<NIOSocketAddress>)local {
     [_connectionPool setObject:conn forRemote:remote local:local];
+    if ([conn isKindOfClass:[STConnection class]]) {
+        // ticked on events & deadlines
+        [(STConnection *)conn setReadySet:self];
+        [(STConnection *)conn setClock:_clock];
+        [_readySet addObject:conn];
+    } else {
+        // ticked every turn
+        [_readySet addUnmanagedObject:conn];
+    }
 }
 
 - (void)removeConnection:(id<STConnection>)conn
@@ -217,7 +248,11 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
 
 - (NSUInteger)availableInChannel:(id<STChannel>)channel {
     NSAssert(false, @"override me!");
-    return NIO_MSS;
+    return ST_MSS;
+}
+
+- (NSArray<id<STChannel>> *)readyChannelsWithTime:(NSTimeInterval)now {
+    return [[self allChannels] allObjects];
 }
 
 - (BOOL)driveChannel:(id<STChannel>)sock {
@@ -253,6 +288,8 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
             conn = [self connectionWithRemoteAddress:remote localAddress:local];
             [self removeChannel:sock remoteAddress:remote localAddress:local];
             if (conn) {
+                // channel lost, evaluate the state
+                [_readySet addObject:conn];
                 NIOError *error = [[NIOError alloc] initWithException:e];
                 [delegate connection:conn error:error];
             }
@@ -275,7 +312,7 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
     return YES;
 }
 
-- (NSInteger)driveChannels:(NSSet<id<STChannel>> *)channels {
+- (NSInteger)driveChannels:(NSArray<id<STChannel>> *)channels {
     NSInteger count = 0;
     for (id<STChannel> sock in channels) {
         // drive channel to receive data
@@ -286,31 +323,47 @@ static const NSInteger NIO_MSS = 1472;  // 1500 - 20 - 8
     return count;
 }
 
-- (void)cleanupChannels:(NSSet<id<STChannel>> *)channels {
+- (void)cleanupChannels:(NSArray<id<STChannel>> *)channels {
     for (id<STChannel> sock in channels) {
         if (![sock isAlive]) {
             // if channel not connected (TCP) and not bound (UDP),
             // means it's closed, remove it from the hub
-            [self removeChannel:sock
-                  remoteAddress:sock.remoteAddress
-                   localAddress:sock.localAddress];
+            id<NIOSocketAddress> remote = [sock remoteAddress];
+            id<NIOSocketAddress> local = [sock localAddress];
+            [self removeChannel:sock remoteAddress:remote localAddress:local];
+            // channel closed, evaluate the state of its connection
+            id<STConnection> conn = nil;
+            if (remote) {
+                conn = [self connectionWithRemoteAddress:remote localAddress:local];
+            }
+            if (conn) {
+                [_readySet addObject:conn];
+            }
         }
     }
 }
 
-- (void)driveConnections:(NSSet<id<STConnection>> *)connections {
-    NSTimeInterval now = OKGetCurrentTimeInterval();
-    NSTimeInterval delta = now - _lastTimeDriveConnections;
+- (NSArray<id<STConnection>> *)readyConnectionsWithTime:(NSTimeInterval)now {
+    return [_readySet popObjectsWithTime:now];
+}
+
+- (void)driveConnections:(NSArray<id<STConnection>> *)connections {
+    NSTimeInterval now = [_clock now];
+    NSNumber *last;
+    NSTimeInterval delta;
     for (id<STConnection> conn in connections) {
+        // connections are driven sparsely, each one has its own elapsed time
+        last = [_tickTimes objectForKey:conn];
+        delta = last ? now - [last doubleValue] : 0;
+        [_tickTimes setObject:@(now) forKey:conn];
         // drive connection to go on
         [conn tick:now elapsed:delta];
         // NOTICE: let the delegate to decide whether close an error connection
         //         or just remove it.
     }
-    _lastTimeDriveConnections = now;
 }
 
-- (void)cleanupConnections:(NSSet<id<STConnection>> *)connections {
+- (void)cleanupConnections:(NSArray<id<STConnection>> *)connections {
     for (id<STConnection> conn in connections) {
         if (![conn isOpen]) {
             // if connection closed, remove it from the hub; notice that
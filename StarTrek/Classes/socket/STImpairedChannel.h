@@ -0,0 +1,130 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STImpairedChannel.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STClock.h>
+#import <StarTrek/STChannel.h>
+#import <StarTrek/STLoopbackChannel.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Network Impairment
+ *  ~~~~~~~~~~~~~~~~~~
+ *
+ *  Conditions of the link before the receiver:
+ *      1. loss: packets dropped randomly;
+ *      2. bandwidth: packets wait in a queue (tail dropped when full),
+ *         then take 'length / bandwidth' seconds to pass the link;
+ *      3. delay: packets arrive 'delay +/- jitter' seconds later,
+ *         jitter may reorder them too;
+ *      4. duplicate: packets arrive twice;
+ *      5. reorder: packets held 'reorderDelay' more, overtaken by the next ones.
+ *
+ *  Random choices come from 'seed', so a test can be reproduced.
+ */
+@interface STImpairment : NSObject
+
+@property(nonatomic, assign) double lossRate;       // [0, 1]
+@property(nonatomic, assign) double duplicateRate;  // [0, 1]
+@property(nonatomic, assign) double reorderRate;    // [0, 1]
+
+@property(nonatomic, assign) NSTimeInterval delay;         // one way
+@property(nonatomic, assign) NSTimeInterval jitter;        // uniform in [-jitter, +jitter]
+@property(nonatomic, assign) NSTimeInterval reorderDelay;  // default is 0.01
+
+@property(nonatomic, assign) double bandwidth;       // bytes per second, 0 for unlimited
+@property(nonatomic, assign) NSUInteger queueLimit;  // bytes waiting for the link, 0 for unlimited
+
+@property(nonatomic, assign) UInt64 seed;
+
+@end
+
+@interface STImpairment (Creation)
+
++ (instancetype)impairmentWithLoss:(double)rate
+                             delay:(NSTimeInterval)delay
+                            jitter:(NSTimeInterval)jitter;
+
+@end
+
+#pragma mark -
+
+/**
+ *  Impaired Channel
+ *  ~~~~~~~~~~~~~~~~
+ *
+ *  Decorator for testing, packets received from the inner channel
+ *  are impaired before returned, data sent goes to the inner channel directly.
+ *
+ *  Each read from the inner channel is taken as a packet,
+ *  so it should be a datagram channel for loss/duplicate/reorder.
+ */
+@interface STImpairedChannel : NSObject <STChannel, STLoopbackChannelDelegate>
+
+@property(nonatomic, strong, readonly) id<STChannel> channel;
+
+@property(nonatomic, strong, readonly) STImpairment *impairment;
+
+// time source for due times (set to the hub's clock)
+@property(nonatomic, strong) STClock *clock;
+
+// notified when the inner channel is ready
+@property(nonatomic, weak, nullable) id<STLoopbackChannelDelegate> delegate;
+
+// buffer size for reading the inner channel (default is 65536)
+@property(nonatomic, assign) NSUInteger maxPacketSize;
+
+// packets counting
+@property(nonatomic, readonly) NSUInteger received;
+@property(nonatomic, readonly) NSUInteger dropped;
+@property(nonatomic, readonly) NSUInteger duplicated;
+@property(nonatomic, readonly) NSUInteger reordered;
+@property(nonatomic, readonly) NSUInteger delivered;
+
+// length of the packet due now (after reading the inner channel), 0 for none
+@property(nonatomic, readonly) NSUInteger available;
+
+// due time of the first packet waiting, 0 for none
+@property(nonatomic, readonly) NSTimeInterval nextDueTime;
+
+- (instancetype)initWithChannel:(id<STChannel>)channel
+                     impairment:(STImpairment *)impairment
+                           seed:(UInt64)seed
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
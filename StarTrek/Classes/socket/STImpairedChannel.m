@@ -0,0 +1,420 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STImpairedChannel.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "NIOException.h"
+#import "NIOByteBuffer.h"
+
+#import "STImpairedChannel.h"
+
+static const NSTimeInterval IMPAIRMENT_REORDER_DELAY = 0.01;
+
+static const NSUInteger IMPAIRMENT_PACKET_SIZE = 65536;
+
+// SplitMix64
+static inline UInt64 random_next(UInt64 *state) {
+    UInt64 z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// [0, 1)
+static inline double random_unit(UInt64 *state) {
+    return (random_next(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+@implementation STImpairment
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _lossRate = 0;
+        _duplicateRate = 0;
+        _reorderRate = 0;
+        _delay = 0;
+        _jitter = 0;
+        _reorderDelay = IMPAIRMENT_REORDER_DELAY;
+        _bandwidth = 0;
+        _queueLimit = 0;
+        _seed = 0;
+    }
+    return self;
+}
+
+@end
+
+@implementation STImpairment (Creation)
+
++ (instancetype)impairmentWithLoss:(double)rate
+                             delay:(NSTimeInterval)delay
+                            jitter:(NSTimeInterval)jitter {
+    STImpairment *impairment = [[self alloc] init];
+    impairment.lossRate = rate;
+    impairment.delay = delay;
+    impairment.jitter = jitter;
+    return impairment;
+}
+
+@end
+
+#pragma mark -
+
+@interface __ImpairedPacket : NSObject
+
+@property(nonatomic, strong) NSData *data;
+@property(nonatomic, strong) id<NIOSocketAddress> remote;
+@property(nonatomic, assign) NSTimeInterval time;  // due time
+
+@end
+
+@implementation __ImpairedPacket
+
+@end
+
+@interface STImpairedChannel () {
+
+    UInt64 _random;               // PRNG state
+    NSTimeInterval _linkFreeTime;  // when the last packet passes the link
+}
+
+@property(nonatomic, strong) id<STChannel> channel;
+@property(nonatomic, strong) STImpairment *impairment;
+
+// packets in order of due time
+@property(nonatomic, strong) NSMutableArray<__ImpairedPacket *> *packets;
+
+// for reading the inner channel
+@property(nonatomic, strong, nullable) NIOByteBuffer *buffer;
+
+// error from the inner channel
+@property(nonatomic, strong, nullable) NIOException *error;
+
+@end
+
+@implementation STImpairedChannel
+
+- (instancetype)init {
+    NSAssert(false, @"DON'T call me!");
+    id<STChannel> channel = nil;
+    return [self initWithChannel:channel impairment:[[STImpairment alloc] init] seed:0];
+}
+
+/* designated initializer */
+- (instancetype)initWithChannel:(id<STChannel>)channel
+                     impairment:(STImpairment *)impairment
+                           seed:(UInt64)seed {
+    if (self = [super init]) {
+        self.channel = channel;
+        self.impairment = impairment;
+        self.clock = [STClock defaultClock];
+        self.maxPacketSize = IMPAIRMENT_PACKET_SIZE;
+        self.packets = [[NSMutableArray alloc] init];
+        self.buffer = nil;
+        self.error = nil;
+        _random = seed;
+        _linkFreeTime = 0;
+        _received = 0;
+        _dropped = 0;
+        _duplicated = 0;
+        _reordered = 0;
+        _delivered = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)available {
+    NSTimeInterval now = [_clock now];
+    [self pullWithTime:now];
+    __ImpairedPacket *first = [_packets firstObject];
+    if (first && first.time <= now) {
+        return [first.data length];
+    }
+    return 0;
+}
+
+- (NSTimeInterval)nextDueTime {
+    __ImpairedPacket *first = [_packets firstObject];
+    return first ? first.time : 0;
+}
+
+// private
+- (void)pullWithTime:(NSTimeInterval)now {
+    NIOByteBuffer *buffer = _buffer;
+    if (!buffer) {
+        buffer = [NIOByteBuffer bufferWithCapacity:_maxPacketSize];
+        self.buffer = buffer;
+    }
+    id<NIOSocketAddress> remote;
+    NSMutableData *data;
+    NIOException *e;
+    while (!_error) {
+        [buffer clear];
+        e = nil;
+        remote = [_channel receiveWithBuffer:buffer throws:&e];
+        if (e) {
+            // report it when receiving
+            self.error = e;
+            break;
+        } else if (!remote) {
+            // nothing more
+            break;
+        }
+        [buffer flip];
+        data = [[NSMutableData alloc] initWithLength:[buffer remaining]];
+        [buffer getData:data];
+        [self impairData:data remoteAddress:remote time:now];
+    }
+}
+
+// private
+- (void)impairData:(NSData *)data remoteAddress:(id<NIOSocketAddress>)remote
+              time:(NSTimeInterval)now {
+    STImpairment *imp = _impairment;
+    ++_received;
+    // 1. lost
+    if (random_unit(&_random) < imp.lossRate) {
+        ++_dropped;
+        return;
+    }
+    NSUInteger copies = 1;
+    if (random_unit(&_random) < imp.duplicateRate) {
+        ++_duplicated;
+        copies = 2;
+    }
+    NSUInteger length = [data length];
+    NSTimeInterval due;
+    for (NSUInteger i = 0; i < copies; ++i) {
+        // 2. waiting in the queue, then passing the link
+        due = now;
+        if (imp.bandwidth > 0) {
+            NSTimeInterval busy = MAX(_linkFreeTime, now);
+            if (imp.queueLimit > 0 && (busy - now) * imp.bandwidth + length > imp.queueLimit) {
+                // queue full
+                ++_dropped;
+                continue;
+            }
+            _linkFreeTime = busy + length / imp.bandwidth;
+            due = _linkFreeTime;
+        }
+        // 3. travelling
+        due += imp.delay;
+        if (imp.jitter > 0) {
+            due += imp.jitter * (2 * random_unit(&_random) - 1);
+        }
+        if (random_unit(&_random) < imp.reorderRate) {
+            ++_reordered;
+            due += imp.reorderDelay;
+        }
+        [self insertData:data remoteAddress:remote time:MAX(due, now)];
+    }
+}
+
+// private
+- (void)insertData:(NSData *)data remoteAddress:(id<NIOSocketAddress>)remote
+              time:(NSTimeInterval)due {
+    __ImpairedPacket *pack = [[__ImpairedPacket alloc] init];
+    pack.data = data;
+    pack.remote = remote;
+    pack.time = due;
+    // after packets with same due time
+    NSUInteger low = 0, high = [_packets count], mid;
+    while (low < high) {
+        mid = (low + high) / 2;
+        if ([_packets objectAtIndex:mid].time <= due) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    [_packets insertObject:pack atIndex:low];
+}
+
+// private
+- (nullable __ImpairedPacket *)popPacketWithTime:(NSTimeInterval)now {
+    [self pullWithTime:now];
+    __ImpairedPacket *first = [_packets firstObject];
+    if (!first || first.time > now) {
+        return nil;
+    }
+    [_packets removeObjectAtIndex:0];
+    ++_delivered;
+    return first;
+}
+
+// private
+- (NSInteger)putPacket:(__ImpairedPacket *)pack intoBuffer:(NIOByteBuffer *)dst {
+    NSData *data = pack.data;
+    // truncated like UDP
+    NSInteger len = MIN((NSInteger)[data length], [dst remaining]);
+    [dst putData:data offset:0 length:len];
+    return len;
+}
+
+// private
+- (BOOL)checkError:(NIOException **)error {
+    NIOException *e = _error;
+    if (!e) {
+        return NO;
+    }
+    self.error = nil;
+    if (error) {
+        *error = e;
+    }
+    return YES;
+}
+
+//
+//  Loopback Channel Delegate
+//
+
+// Override
+- (void)channelReady:(id<STChannel>)channel {
+    [_delegate channelReady:self];
+}
+
+//
+//  Channel
+//
+
+// Override
+- (nullable id<NIOSocketAddress>)remoteAddress {
+    return [_channel remoteAddress];
+}
+
+// Override
+- (nullable id<NIOSocketAddress>)localAddress {
+    return [_channel localAddress];
+}
+
+// Override
+- (BOOL)isOpen {
+    return [_channel isOpen];
+}
+
+// Override
+- (BOOL)isBound {
+    return [_channel isBound];
+}
+
+// Override
+- (BOOL)isConnected {
+    return [_channel isConnected];
+}
+
+// Override
+- (BOOL)isAlive {
+    return [_channel isAlive];
+}
+
+// Override
+- (BOOL)isBlocking {
+    return [_channel isBlocking];
+}
+
+// Override
+- (nullable NIOSelectableChannel *)configureBlocking:(BOOL)blocking {
+    return [_channel configureBlocking:blocking];
+}
+
+// Override
+- (NSString *)debugDescription {
+    return [NSString stringWithFormat:@"<%@ received=%lu dropped=%lu waiting=%lu>\n\t%@\n</%@>",
+            [self class], _received, _dropped, [_packets count],
+            [_channel debugDescription], [self class]];
+}
+
+// Override
+- (nullable id<NIONetworkChannel>)bindLocalAddress:(id<NIOSocketAddress>)local
+                                            throws:(NIOException **)error {
+    return [_channel bindLocalAddress:local throws:error];
+}
+
+// Override
+- (nullable id<NIONetworkChannel>)connectRemoteAddress:(id<NIOSocketAddress>)remote
+                                                throws:(NIOException **)error {
+    return [_channel connectRemoteAddress:remote throws:error];
+}
+
+// Override
+- (nullable id<NIOByteChannel>)disconnect {
+    return [_channel disconnect];
+}
+
+// Override
+- (void)close {
+    [_packets removeAllObjects];
+    [_channel close];
+}
+
+//
+//  Input/Output
+//
+
+// Override
+- (NSInteger)readWithBuffer:(NIOByteBuffer *)dst throws:(NIOException **)error {
+    __ImpairedPacket *pack = [self popPacketWithTime:[_clock now]];
+    if (pack) {
+        return [self putPacket:pack intoBuffer:dst];
+    } else if ([self checkError:error]) {
+        return -1;
+    }
+    return 0;
+}
+
+// Override
+- (NSInteger)writeWithBuffer:(NIOByteBuffer *)src throws:(NIOException **)error {
+    return [_channel writeWithBuffer:src throws:error];
+}
+
+// Override
+- (nullable id<NIOSocketAddress>)receiveWithBuffer:(NIOByteBuffer *)dst
+                                            throws:(NIOException **)error {
+    __ImpairedPacket *pack = [self popPacketWithTime:[_clock now]];
+    if (pack) {
+        [self putPacket:pack intoBuffer:dst];
+        return pack.remote;
+    }
+    [self checkError:error];
+    return nil;
+}
+
+// Override
+- (NSInteger)sendWithBuffer:(NIOByteBuffer *)src
+              remoteAddress:(id<NIOSocketAddress>)remote
+                     throws:(NIOException **)error {
+    return [_channel sendWithBuffer:src remoteAddress:remote throws:error];
+}
+
+@end
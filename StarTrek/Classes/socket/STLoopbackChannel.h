@@ -0,0 +1,107 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STLoopbackChannel.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STAddressPairObject.h>
+#import <StarTrek/STChannel.h>
+#import <StarTrek/STRingBuffer.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@protocol STLoopbackChannelDelegate <NSObject>
+
+/**
+ *  Called when data arrived, or the peer closed
+ *  (may be called from the peer's thread)
+ *
+ * @param channel - loopback channel (or its decorator) to be read
+ */
+- (void)channelReady:(id<STChannel>)channel;
+
+@end
+
+/**
+ *  Loopback Channel
+ *  ~~~~~~~~~~~~~~~~
+ *
+ *  In-process channel, connected to its peer by two ring buffers:
+ *      inbox  - written by the peer, read by this channel;
+ *      outbox - inbox of the peer, written by this channel.
+ *
+ *  Each ring buffer is lock-free for one writer and one reader, so a channel
+ *  should be written by one thread (sending) and read by one thread (its hub).
+ */
+@interface STLoopbackChannel : STAddressPairObject <STChannel>
+
+// notified when the inbox becomes readable
+@property(nonatomic, weak, nullable) id<STLoopbackChannelDelegate> delegate;
+
+@property(nonatomic, weak, readonly, nullable) STLoopbackChannel *peer;
+
+@property(nonatomic, readonly) STRingBuffer *inbox;
+
+// keep packet boundaries (UDP), or not (TCP)
+@property(nonatomic, readonly, getter=isDatagram) BOOL datagram;
+
+// bytes (stream), or length of the next packet (datagram) can be read now
+@property(nonatomic, readonly) NSUInteger available;
+
+- (instancetype)initWithRemoteAddress:(nullable id<NIOSocketAddress>)remote
+                         localAddress:(nullable id<NIOSocketAddress>)local
+                           bufferSize:(NSUInteger)size
+                             datagram:(BOOL)datagram
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+@interface STLoopbackChannel (Creation)
+
+/**
+ *  Create two channels connected to each other
+ *
+ * @param local    - address of the first channel
+ * @param remote   - address of the second channel
+ * @param size     - buffer size for each direction
+ * @param datagram - keep packet boundaries
+ * @return channels at (local, remote)
+ */
++ (NSArray<STLoopbackChannel *> *)channelsWithLocalAddress:(id<NIOSocketAddress>)local
+                                             remoteAddress:(id<NIOSocketAddress>)remote
+                                                bufferSize:(NSUInteger)size
+                                                  datagram:(BOOL)datagram;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,305 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STLoopbackChannel.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "NIOException.h"
+#import "NIOByteBuffer.h"
+
+#import "STLoopbackChannel.h"
+
+static const NSUInteger LOOPBACK_BUFFER_SIZE = 65536;
+
+@interface STLoopbackChannel () {
+
+    BOOL _opened;
+}
+
+@property(nonatomic, weak) STLoopbackChannel *peer;
+
+@property(nonatomic, strong) STRingBuffer *inbox;
+@property(nonatomic, strong, nullable) STRingBuffer *outbox;  // inbox of the peer
+
+@end
+
+@implementation STLoopbackChannel
+
+- (instancetype)initWithRemoteAddress:(nullable id<NIOSocketAddress>)remote
+                         localAddress:(nullable id<NIOSocketAddress>)local {
+    return [self initWithRemoteAddress:remote
+                          localAddress:local
+                            bufferSize:LOOPBACK_BUFFER_SIZE
+                              datagram:NO];
+}
+
+/* designated initializer */
+- (instancetype)initWithRemoteAddress:(nullable id<NIOSocketAddress>)remote
+                         localAddress:(nullable id<NIOSocketAddress>)local
+                           bufferSize:(NSUInteger)size
+                             datagram:(BOOL)datagram {
+    if (self = [super initWithRemoteAddress:remote localAddress:local]) {
+        self.inbox = [[STRingBuffer alloc] initWithCapacity:size];
+        self.outbox = nil;
+        _datagram = datagram;
+        _opened = YES;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    // make sure the peer will not wait for this channel
+    if (_opened) {
+        _opened = NO;
+        [self shutdown];
+    }
+}
+
+// private
+- (void)connectPeer:(STLoopbackChannel *)other {
+    self.peer = other;
+    self.outbox = other.inbox;
+}
+
+// private
+- (void)notifyPeer {
+    STLoopbackChannel *other = _peer;
+    if (other && [_outbox signal]) {
+        [other.delegate channelReady:other];
+    }
+}
+
+- (NSUInteger)available {
+    if (_datagram) {
+        return [_inbox nextPacketLength];
+    }
+    return [_inbox available];
+}
+
+// Override
+- (BOOL)isOpen {
+    return _opened;
+}
+
+// Override
+- (BOOL)isConnected {
+    return _opened && _outbox;
+}
+
+// Override
+- (BOOL)isBound {
+    // bound on creation
+    return [self isConnected];
+}
+
+// Override
+- (BOOL)isAlive {
+    return [self isOpen] && ([self isConnected] || [self isBound]);
+}
+
+// Override
+- (BOOL)isBlocking {
+    return NO;
+}
+
+// Override
+- (nullable NIOSelectableChannel *)configureBlocking:(BOOL)blocking {
+    // no inner socket
+    return nil;
+}
+
+// Override
+- (NSString *)debugDescription {
+    return [NSString stringWithFormat:@"<%@ remote=\"%@\" local=\"%@\" available=%lu />",
+            [self class], [self remoteAddress], [self localAddress], [self available]];
+}
+
+// Override
+- (nullable id<NIONetworkChannel>)bindLocalAddress:(id<NIOSocketAddress>)local
+                                            throws:(NIOException **)error {
+    if (local && ![local isEqual:[self localAddress]]) {
+        // cannot rebind
+        if (error) {
+            *error = [[NIOSocketException alloc] initWithReason:@"loopback channel bound"];
+        }
+    }
+    return nil;
+}
+
+// Override
+- (nullable id<NIONetworkChannel>)connectRemoteAddress:(id<NIOSocketAddress>)remote
+                                                throws:(NIOException **)error {
+    if (![self isConnected] || (remote && ![remote isEqual:[self remoteAddress]])) {
+        // cannot reconnect, open a new channel via the hub
+        if (error) {
+            *error = [[NIOSocketException alloc] initWithReason:@"loopback channel connected"];
+        }
+    }
+    return nil;
+}
+
+// Override
+- (nullable id<NIOByteChannel>)disconnect {
+    [self close];
+    return self;
+}
+
+// private
+- (void)shutdown {
+    // no more data in both directions
+    [_inbox close];
+    [_outbox close];
+    // let the peer read the rest and find it closed
+    [self notifyPeer];
+}
+
+// Override
+- (void)close {
+    if (!_opened) {
+        return;
+    }
+    _opened = NO;
+    [self shutdown];
+    // let the hub remove this channel
+    [_delegate channelReady:self];
+}
+
+//
+//  Input/Output
+//
+
+// Override
+- (NSInteger)readWithBuffer:(NIOByteBuffer *)dst throws:(NIOException **)error {
+    if (!_opened) {
+        if (error) {
+            *error = [[NIOClosedChannelException alloc] init];
+        }
+        return -1;
+    }
+    // check before reading, data written before closing will not be lost
+    BOOL closed = [_inbox isClosed];
+    NSInteger cnt;
+    if (_datagram) {
+        cnt = [_inbox popPacket:[dst writableBytes] length:[dst remaining]];
+    } else {
+        cnt = [_inbox readBytes:[dst writableBytes] length:[dst remaining]];
+    }
+    if (cnt > 0) {
+        [dst position:([dst position] + cnt)];
+        return cnt;
+    } else if (closed) {
+        // end of stream
+        [self close];
+        return -1;
+    }
+    return 0;
+}
+
+// Override
+- (NSInteger)writeWithBuffer:(NIOByteBuffer *)src throws:(NIOException **)error {
+    STRingBuffer *outbox = _outbox;
+    NSInteger len = [src remaining];
+    NSInteger cnt = -1;
+    if (_opened && outbox) {
+        if (_datagram && len > [outbox maxPacketLength]) {
+            // never fits in the ring, like EMSGSIZE
+            if (error) {
+                *error = [[NIOSocketException alloc] initWithReason:@"message too long"];
+            }
+            return -1;
+        } else if (_datagram) {
+            // all or nothing
+            if ([outbox pushPacket:[src readableBytes] length:len]) {
+                cnt = len;
+            } else {
+                cnt = [outbox isClosed] ? -1 : 0;
+            }
+        } else {
+            cnt = [outbox writeBytes:[src readableBytes] length:len];
+        }
+    }
+    if (cnt < 0) {
+        // peer closed
+        [self close];
+        if (error) {
+            *error = [[NIOClosedChannelException alloc] init];
+        }
+        return -1;
+    }
+    if (cnt > 0) {
+        [src position:([src position] + cnt)];
+        [self notifyPeer];
+    }
+    return cnt;
+}
+
+// Override
+- (nullable id<NIOSocketAddress>)receiveWithBuffer:(NIOByteBuffer *)dst
+                                            throws:(NIOException **)error {
+    NSInteger cnt = [self readWithBuffer:dst throws:error];
+    if (cnt > 0) {
+        return [self remoteAddress];
+    }
+    return nil;
+}
+
+// Override
+- (NSInteger)sendWithBuffer:(NIOByteBuffer *)src
+              remoteAddress:(id<NIOSocketAddress>)remote
+                     throws:(NIOException **)error {
+    // connected, only to the peer
+    return [self writeWithBuffer:src throws:error];
+}
+
+@end
+
+@implementation STLoopbackChannel (Creation)
+
++ (NSArray<STLoopbackChannel *> *)channelsWithLocalAddress:(id<NIOSocketAddress>)local
+                                             remoteAddress:(id<NIOSocketAddress>)remote
+                                                bufferSize:(NSUInteger)size
+                                                  datagram:(BOOL)datagram {
+    STLoopbackChannel *first = [[self alloc] initWithRemoteAddress:remote
+                                                      localAddress:local
+                                                        bufferSize:size
+                                                          datagram:datagram];
+    STLoopbackChannel *second = [[self alloc] initWithRemoteAddress:local
+                                                       localAddress:remote
+                                                         bufferSize:size
+                                                           datagram:datagram];
+    [first connectPeer:second];
+    [second connectPeer:first];
+    return @[first, second];
+}
+
+@end
@@ -0,0 +1,85 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STLoopbackHub.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STBaseHub.h>
+#import <StarTrek/STLoopbackChannel.h>
+#import <StarTrek/STImpairedChannel.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Loopback Hub
+ *  ~~~~~~~~~~~~
+ *
+ *  In-process transport, hubs are connected by loopback channels:
+ *      1. a hub binds local addresses to accept channels;
+ *      2. connecting to a bound address creates a pair of channels,
+ *         one for each hub, the local address will be assigned
+ *         (127.x.y.1:49152~65535) when not given;
+ *      3. only channels with data arrived (or closed) will be driven;
+ *      4. with 'impairment', packets received by this hub are impaired
+ *         (lost, delayed, ...) for testing.
+ *
+ *  Hubs can be driven in different threads, but the data of a connection
+ *  should be sent in one thread.
+ */
+@interface STLoopbackHub : STHub <STLoopbackChannelDelegate>
+
+// buffer size of each direction for new channels (default is 64 KB)
+@property(nonatomic, assign) NSUInteger bufferSize;
+
+// keep packet boundaries for channels accepted by this hub (default is NO)
+@property(nonatomic, assign, getter=isDatagram) BOOL datagram;
+
+// link conditions for channels created after set (default is nil)
+@property(nonatomic, strong, nullable) STImpairment *impairment;
+
+/**
+ *  Accept channels connecting to the address
+ *
+ * @param local - address for connecting
+ * @return NO on address in use by another hub
+ */
+- (BOOL)bindLocalAddress:(id<NIOSocketAddress>)local;
+
+- (void)unbindLocalAddress:(id<NIOSocketAddress>)local;
+
+// protected
+- (STAddressPairMap<id<STChannel>> *)createChannelPool;
+
+@end
+
+NS_ASSUME_NONNULL_END
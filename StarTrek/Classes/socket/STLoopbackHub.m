@@ -0,0 +1,317 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STLoopbackHub.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <ObjectKey/ObjectKey.h>
+
+#import "STConcurrentAddressPairMap.h"
+#import "STReadySet.h"
+
+#import "STLoopbackHub.h"
+
+static const NSUInteger LOOPBACK_BUFFER_SIZE = 65536;
+
+// local addresses for connecting: 127.x.y.1:49152~65535
+static const UInt16 LOOPBACK_EPHEMERAL_PORT = 49152;
+static const NSUInteger LOOPBACK_EPHEMERAL_COUNT = 16384;
+
+static NSUInteger s_ephemeral = 0;
+
+// seeds for impaired channels
+static UInt64 s_impaired = 0;
+
+static inline id<NIOSocketAddress> ephemeral_address(void) {
+    NSUInteger n = __atomic_fetch_add(&s_ephemeral, 1, __ATOMIC_RELAXED);
+    NSUInteger index = n / LOOPBACK_EPHEMERAL_COUNT;
+    UInt16 port = LOOPBACK_EPHEMERAL_PORT + n % LOOPBACK_EPHEMERAL_COUNT;
+    NSString *host = [NSString stringWithFormat:@"127.%lu.%lu.1",
+                      (unsigned long)((index >> 8) & 0xFF),
+                      (unsigned long)(index & 0xFF)];
+    return [NIOBinarySocketAddress addressWithHost:host port:port];
+}
+
+// bound address => hub
+static NSMapTable<id<NIOSocketAddress>, id> *s_listeners = nil;
+
+static inline NSMapTable<id<NIOSocketAddress>, id> *listeners(void) {
+    OKSingletonDispatchOnce(^{
+        s_listeners = [NSMapTable strongToWeakObjectsMapTable];
+    });
+    return s_listeners;
+}
+
+static inline STLoopbackChannel *loopback_channel(id<STChannel> channel) {
+    if ([channel isKindOfClass:[STImpairedChannel class]]) {
+        return (STLoopbackChannel *)[(STImpairedChannel *)channel channel];
+    }
+    return (STLoopbackChannel *)channel;
+}
+
+@interface STLoopbackHub ()
+
+@property(nonatomic, strong) STAddressPairMap<id<STChannel>> *channelPool;
+
+// channels with data arrived
+@property(nonatomic, strong) STReadySet<id<STChannel>> *readyChannels;
+
+// channels connected to this hub, waiting for creating connections
+@property(nonatomic, strong) NSMutableArray<id<STChannel>> *backlog;
+
+@end
+
+@implementation STLoopbackHub
+
+/* designated initializer */
+- (instancetype)initWithConnectionDelegate:(id<STConnectionDelegate>)delegate {
+    if (self = [super initWithConnectionDelegate:delegate]) {
+        self.channelPool = [self createChannelPool];
+        self.readyChannels = [[STReadySet alloc] init];
+        self.backlog = [[NSMutableArray alloc] init];
+        self.bufferSize = LOOPBACK_BUFFER_SIZE;
+        self.datagram = NO;
+        self.impairment = nil;
+    }
+    return self;
+}
+
+- (STAddressPairMap<id<STChannel>> *)createChannelPool {
+    return [[STConcurrentAddressPairMap alloc] init];
+}
+
+- (BOOL)bindLocalAddress:(id<NIOSocketAddress>)local {
+    NSMapTable *table = listeners();
+    @synchronized (table) {
+        id hub = [table objectForKey:local];
+        if (hub && hub != self) {
+            // address in use
+            return NO;
+        }
+        [table setObject:self forKey:local];
+    }
+    return YES;
+}
+
+- (void)unbindLocalAddress:(id<NIOSocketAddress>)local {
+    NSMapTable *table = listeners();
+    @synchronized (table) {
+        if ([table objectForKey:local] == self) {
+            [table removeObjectForKey:local];
+        }
+    }
+}
+
+// private
++ (nullable STLoopbackHub *)listenerForAddress:(id<NIOSocketAddress>)address {
+    NSMapTable *table = listeners();
+    @synchronized (table) {
+        return [table objectForKey:address];
+    }
+}
+
+// private
+- (id<STChannel>)wrapChannel:(STLoopbackChannel *)sock {
+    STImpairment *impairment = _impairment;
+    if (!impairment) {
+        // notify this hub for data arrived
+        sock.delegate = self;
+        return sock;
+    }
+    UInt64 n = __atomic_fetch_add(&s_impaired, 1, __ATOMIC_RELAXED);
+    STImpairedChannel *wrapper;
+    wrapper = [[STImpairedChannel alloc] initWithChannel:sock
+                                              impairment:impairment
+                                                    seed:(impairment.seed + n)];
+    wrapper.clock = [self clock];
+    wrapper.delegate = self;
+    sock.delegate = wrapper;
+    return wrapper;
+}
+
+// private, called by the connecting hub (maybe in another thread)
+- (void)acceptChannel:(STLoopbackChannel *)channel {
+    id<STChannel> sock = [self wrapChannel:channel];
+    @synchronized (_backlog) {
+        [_backlog addObject:sock];
+    }
+}
+
+// private
+- (void)acceptChannels {
+    NSArray<id<STChannel>> *incoming;
+    @synchronized (_backlog) {
+        if ([_backlog count] == 0) {
+            return;
+        }
+        incoming = [_backlog copy];
+        [_backlog removeAllObjects];
+    }
+    id<NIOSocketAddress> remote;
+    id<NIOSocketAddress> local;
+    id<STConnection> conn;
+    for (id<STChannel> sock in incoming) {
+        remote = [sock remoteAddress];
+        local = [sock localAddress];
+        [_channelPool setObject:sock forRemote:remote local:local];
+        conn = [self createConnectionWithChannel:sock remoteAddress:remote localAddress:local];
+        if (conn) {
+            [self setConnection:conn remoteAddress:remote localAddress:local];
+        }
+    }
+}
+
+// Override
+- (void)channelReady:(id<STChannel>)channel {
+    [_readyChannels addObject:channel];
+}
+
+// Override
+- (nullable id<STChannel>)openChannelForRemoteAddress:(nullable id<NIOSocketAddress>)remote
+                                         localAddress:(nullable id<NIOSocketAddress>)local {
+    if (!remote) {
+        // cannot connect to nowhere
+        return nil;
+    }
+    id<STChannel> sock = [_channelPool objectForRemote:remote local:local];
+    if ([sock isAlive]) {
+        return sock;
+    }
+    STLoopbackHub *server = [STLoopbackHub listenerForAddress:remote];
+    if (!server) {
+        // connection refused
+        return nil;
+    }
+    if (!local) {
+        local = ephemeral_address();
+    }
+    NSArray<STLoopbackChannel *> *pair;
+    pair = [STLoopbackChannel channelsWithLocalAddress:local
+                                         remoteAddress:remote
+                                            bufferSize:_bufferSize
+                                              datagram:[server isDatagram]];
+    sock = [self wrapChannel:[pair firstObject]];
+    [_channelPool setObject:sock forRemote:remote local:local];
+    [server acceptChannel:[pair lastObject]];
+    return sock;
+}
+
+//
+//  Channel
+//
+
+// Override
+- (NSSet<id<STChannel>> *)allChannels {
+    return [_channelPool allValues];
+}
+
+// Override
+- (void)removeChannel:(id<STChannel>)channel
+        remoteAddress:(id<NIOSocketAddress>)remote
+         localAddress:(id<NIOSocketAddress>)local {
+    id<STChannel> cached = [_channelPool removeObject:channel forRemote:remote local:local];
+    if ([cached isOpen]) {
+        [cached close];
+    }
+}
+
+//
+//  Connection
+//
+
+// Override
+- (id<STConnection>)createConnectionWithChannel:(id<STChannel>)channel
+                                  remoteAddress:(id<NIOSocketAddress>)remote
+                                   localAddress:(id<NIOSocketAddress>)local {
+    if (!local) {
+        // assigned when connecting
+        local = [channel localAddress];
+    }
+    STConnection *conn = [[STConnection alloc] initWithChannel:channel
+                                                 remoteAddress:remote
+                                                  localAddress:local];
+    [conn setDelegate:[self delegate]];
+    [conn start];
+    return conn;
+}
+
+//
+//  Processor
+//
+
+// Override
+- (NSArray<id<STChannel>> *)readyChannelsWithTime:(NSTimeInterval)now {
+    NSArray<id<STChannel>> *channels = [_readyChannels popObjectsWithTime:now];
+    // NOTICE: accept after popping, so all channels popped have connections,
+    //         because a channel is accepted before data written into it.
+    [self acceptChannels];
+    return channels;
+}
+
+// Override
+- (NSUInteger)availableInChannel:(id<STChannel>)channel {
+    STLoopbackChannel *sock = loopback_channel(channel);
+    NSUInteger available;
+    if (sock == channel) {
+        available = [sock available];
+    } else {
+        // packets due now
+        available = [(STImpairedChannel *)channel available];
+    }
+    if (available == 0 && [[sock inbox] isClosed]) {
+        // closed by the peer, read to find the end
+        return 1;
+    }
+    return available;
+}
+
+// Override
+- (BOOL)driveChannel:(id<STChannel>)channel {
+    STLoopbackChannel *sock = loopback_channel(channel);
+    // data written after this will notify again
+    [[sock inbox] clearSignal];
+    BOOL ok = [super driveChannel:channel];
+    if (sock != channel) {
+        // packets delayed, drive again when the first one is due
+        NSTimeInterval due = [(STImpairedChannel *)channel nextDueTime];
+        if (due > 0 && [channel isAlive]) {
+            [_readyChannels addObject:channel time:due];
+        }
+    } else if ([sock available] > 0) {
+        // more data (packets) waiting
+        [_readyChannels addObject:sock];
+    }
+    return ok;
+}
+
+@end
@@ -35,11 +35,11 @@
 //
 
 #import <StarTrek/NIOSocketAddress.h>
-#import <StarTrek/STHashKeyPairMap.h>
+#import <StarTrek/STFlatKeyPairMap.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
-@interface STAddressPairMap<__covariant ObjectType> : STHashKeyPairMap<id<NIOSocketAddress>, ObjectType>
+@interface STAddressPairMap<__covariant ObjectType> : STFlatKeyPairMap<id<NIOSocketAddress>, ObjectType>
 
 - (instancetype)init NS_DESIGNATED_INITIALIZER;
 
@@ -0,0 +1,63 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STConcurrentAddressPairMap.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STAddressPairMap.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Concurrent Address Pair Map
+ *  ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ *
+ *  Thread-safe map for docker/connection pools:
+ *      1. mappings are spread into stripes by the hash of the first key
+ *         (remote, or local when remote is empty), each stripe has its own lock;
+ *      2. 'allValues' & 'valuesArray' return immutable snapshots, which will
+ *         be rebuilt only after the mappings changed (version increased).
+ */
+@interface STConcurrentAddressPairMap<__covariant ObjectType> : STAddressPairMap<ObjectType>
+
+@property(nonatomic, readonly) NSUInteger stripes;
+
+// increased on each mutation
+@property(nonatomic, readonly) NSUInteger version;
+
+- (instancetype)initWithStripes:(NSUInteger)count
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,185 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STConcurrentAddressPairMap.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STConcurrentAddressPairMap.h"
+
+static const NSUInteger PAIR_MAP_STRIPES = 16;
+
+// mix the high bits in, addresses may have similar hash values
+static inline NSUInteger stripe_index(id key, NSUInteger count) {
+    NSUInteger h = [key hash];
+    h ^= h >> 16;
+    h *= 0x45d9f3b;
+    h ^= h >> 16;
+    return h % count;
+}
+
+@interface STConcurrentAddressPairMap ()
+
+// each stripe is protected by locking itself
+@property(nonatomic, strong) NSArray<STAddressPairMap *> *tables;
+
+@property(nonatomic, strong) NSObject *snapshotLock;
+@property(nonatomic, strong, nullable) NSSet *snapshot;      // nil means dirty
+@property(nonatomic, strong, nullable) NSArray *snapshotArray;
+
+@property(nonatomic, assign) NSUInteger version;
+
+@end
+
+@implementation STConcurrentAddressPairMap
+
+- (instancetype)init {
+    return [self initWithStripes:PAIR_MAP_STRIPES];
+}
+
+/* designated initializer */
+- (instancetype)initWithStripes:(NSUInteger)count {
+    if (self = [super init]) {
+        count = MAX(count, 1);
+        NSMutableArray *tables = [[NSMutableArray alloc] initWithCapacity:count];
+        for (NSUInteger index = 0; index < count; ++index) {
+            [tables addObject:[[STAddressPairMap alloc] init]];
+        }
+        self.tables = tables;
+        self.snapshotLock = [[NSObject alloc] init];
+        self.snapshot = [NSSet set];
+        self.snapshotArray = @[];
+        self.version = 0;
+    }
+    return self;
+}
+
+- (NSUInteger)stripes {
+    return [_tables count];
+}
+
+- (NSUInteger)version {
+    @synchronized (_snapshotLock) {
+        return _version;
+    }
+}
+
+// Override
+- (NSUInteger)count {
+    NSUInteger total = 0;
+    for (STAddressPairMap *table in _tables) {
+        @synchronized (table) {
+            total += [table count];
+        }
+    }
+    return total;
+}
+
+// private
+- (STAddressPairMap *)tableForRemote:(nullable id)remote local:(nullable id)local {
+    id key = remote ? remote : local;
+    NSAssert(key, @"local & remote addresses should not empty at the same time");
+    return [_tables objectAtIndex:stripe_index(key, [_tables count])];
+}
+
+// private
+- (void)invalidateSnapshot {
+    @synchronized (_snapshotLock) {
+        ++_version;
+        _snapshot = nil;
+        _snapshotArray = nil;
+    }
+}
+
+// Override
+- (NSSet<id> *)allValues {
+    // NOTICE: writers release the stripe lock before invalidating,
+    //         so locking stripes inside here will not dead lock.
+    @synchronized (_snapshotLock) {
+        NSSet *values = _snapshot;
+        if (!values) {
+            NSMutableSet *mSet = [[NSMutableSet alloc] init];
+            for (STAddressPairMap *table in _tables) {
+                @synchronized (table) {
+                    [mSet unionSet:[table allValues]];
+                }
+            }
+            values = [mSet copy];
+            _snapshot = values;
+        }
+        return values;
+    }
+}
+
+// Override
+- (NSArray<id> *)valuesArray {
+    @synchronized (_snapshotLock) {
+        NSArray *values = _snapshotArray;
+        if (!values) {
+            values = [[self allValues] allObjects];
+            _snapshotArray = values;
+        }
+        return values;
+    }
+}
+
+// Override
+- (nullable id)objectForRemote:(nullable id)remote local:(nullable id)local {
+    STAddressPairMap *table = [self tableForRemote:remote local:local];
+    @synchronized (table) {
+        return [table objectForRemote:remote local:local];
+    }
+}
+
+// Override
+- (void)setObject:(id)value
+        forRemote:(nullable id)remote local:(nullable id)local {
+    STAddressPairMap *table = [self tableForRemote:remote local:local];
+    @synchronized (table) {
+        [table setObject:value forRemote:remote local:local];
+    }
+    [self invalidateSnapshot];
+}
+
+// Override
+- (nullable id)removeObject:(nullable id)value
+                  forRemote:(nullable id)remote local:(nullable id)local {
+    STAddressPairMap *table = [self tableForRemote:remote local:local];
+    id old;
+    @synchronized (table) {
+        old = [table removeObject:value forRemote:remote local:local];
+    }
+    [self invalidateSnapshot];
+    return old;
+}
+
+@end
@@ -0,0 +1,75 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STFlatKeyPairMap.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/STKeyPairMap.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Flat Key Pair Map
+ *  ~~~~~~~~~~~~~~~~~
+ *
+ *  One open-addressing table keyed by the pair (remote, local),
+ *  a missing key in the pair is stored as the default key:
+ *
+ *      mapping: (remote, local) => value
+ *      mapping: (remote, default) => value
+ *      mapping: (local, default) => value
+ *
+ *  Wildcard lookups (remote only, or local only) are served by
+ *  a secondary index on the first key.
+ *
+ *  Keys and values are retained, this map is not thread-safe.
+ *
+ *  'allValues' and 'valuesArray' are immutable snapshots,
+ *  which are rebuilt only after the version changed.
+ */
+@interface STFlatKeyPairMap<__covariant KeyType, __covariant ObjectType> : STKeyPairMap<KeyType, ObjectType>
+
+@property(nonatomic, readonly) NSUInteger count;
+
+// increased on each mutation
+@property(nonatomic, readonly) NSUInteger version;
+
+- (instancetype)initWithDefaultValue:(KeyType)any;
+
+- (instancetype)initWithDefaultValue:(KeyType)any
+                            capacity:(NSUInteger)capacity
+NS_DESIGNATED_INITIALIZER;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,354 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STFlatKeyPairMap.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STFlatKeyPairMap.h"
+
+// keep load factor under 3/4
+static const NSUInteger FLAT_MAP_CAPACITY = 16;
+
+typedef struct {
+    NSUInteger hash;
+    void *key1;   // retained
+    void *key2;   // retained
+    void *value;  // retained, NULL means empty slot
+} STFlatPairSlot;
+
+static inline NSUInteger pair_hash(id key1, id key2) {
+    NSUInteger h = [key1 hash] * 13 + [key2 hash];
+    // mix the high bits in for masking
+    h ^= h >> 17;
+    h *= 0xed5ad4bb;
+    h ^= h >> 11;
+    return h;
+}
+
+// give the retained object back to ARC (no CoreFoundation needed)
+static inline void slot_release(void *ptr) {
+    (void)(__bridge_transfer id)ptr;
+}
+
+static inline BOOL key_equal(void *ptr, id key) {
+    id obj = (__bridge id)ptr;
+    return obj == key || [obj isEqual:key];
+}
+
+@interface STFlatKeyPairMap () {
+
+    STFlatPairSlot *_slots;
+    NSUInteger _mask;   // capacity - 1
+    NSUInteger _count;
+
+    NSUInteger _version;
+}
+
+@property(nonatomic, strong) id defaultKey;
+
+// secondary index: key1 => values
+@property(nonatomic, strong) NSMapTable<id, NSMutableArray *> *index;
+
+// snapshots of values, nil after changed
+@property(nonatomic, strong, nullable) NSSet *valuesSet;
+@property(nonatomic, strong, nullable) NSArray *valuesList;
+
+@end
+
+@implementation STFlatKeyPairMap
+
+- (instancetype)init {
+    NSAssert(false, @"DON'T call me!");
+    id address = nil;
+    return [self initWithDefaultValue:address];
+}
+
+- (instancetype)initWithDefaultValue:(id)any {
+    return [self initWithDefaultValue:any capacity:FLAT_MAP_CAPACITY];
+}
+
+/* designated initializer */
+- (instancetype)initWithDefaultValue:(id)any capacity:(NSUInteger)capacity {
+    if (self = [super init]) {
+        self.defaultKey = any;
+        NSUInteger size = FLAT_MAP_CAPACITY;
+        while (size * 3 / 4 < capacity) {
+            size <<= 1;
+        }
+        _slots = calloc(size, sizeof(STFlatPairSlot));
+        _mask = size - 1;
+        _count = 0;
+        self.index = [NSMapTable strongToStrongObjectsMapTable];
+    }
+    return self;
+}
+
+- (void)dealloc {
+    for (NSUInteger i = 0; i <= _mask; ++i) {
+        if (_slots[i].value) {
+            slot_release(_slots[i].key1);
+            slot_release(_slots[i].key2);
+            slot_release(_slots[i].value);
+        }
+    }
+    free(_slots);
+}
+
+- (NSUInteger)count {
+    return _count;
+}
+
+- (NSUInteger)version {
+    return _version;
+}
+
+// private
+- (void)changed {
+    ++_version;
+    _valuesSet = nil;
+    _valuesList = nil;
+}
+
+// private
+- (NSInteger)findKey1:(id)key1 key2:(id)key2 hash:(NSUInteger)hash {
+    NSUInteger i = hash & _mask;
+    STFlatPairSlot *slot;
+    while ((slot = &_slots[i])->value) {
+        if (slot->hash == hash && key_equal(slot->key1, key1) && key_equal(slot->key2, key2)) {
+            return i;
+        }
+        i = (i + 1) & _mask;
+    }
+    return -1;
+}
+
+// private
+- (void)resize:(NSUInteger)size {
+    STFlatPairSlot *old = _slots;
+    NSUInteger oldSize = _mask + 1;
+    _slots = calloc(size, sizeof(STFlatPairSlot));
+    _mask = size - 1;
+    NSUInteger i;
+    for (NSUInteger j = 0; j < oldSize; ++j) {
+        if (!old[j].value) {
+            continue;
+        }
+        // move without retaining again
+        i = old[j].hash & _mask;
+        while (_slots[i].value) {
+            i = (i + 1) & _mask;
+        }
+        _slots[i] = old[j];
+    }
+    free(old);
+}
+
+// private, backward shift deletion (no tombstones)
+- (void)removeSlotAtIndex:(NSUInteger)i {
+    slot_release(_slots[i].key1);
+    slot_release(_slots[i].key2);
+    slot_release(_slots[i].value);
+    NSUInteger j = i, k;
+    while (YES) {
+        j = (j + 1) & _mask;
+        if (!_slots[j].value) {
+            break;
+        }
+        k = _slots[j].hash & _mask;
+        // move slot j back if its home is not in (i, j]
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        _slots[i] = _slots[j];
+        i = j;
+    }
+    memset(&_slots[i], 0, sizeof(STFlatPairSlot));
+    --_count;
+}
+
+// private
+- (void)indexValue:(id)value forKey:(id)key1 {
+    NSMutableArray *values = [_index objectForKey:key1];
+    if (!values) {
+        values = [[NSMutableArray alloc] initWithCapacity:1];
+        [_index setObject:values forKey:key1];
+    }
+    [values addObject:value];
+}
+
+// private
+- (void)unindexValue:(id)value forKey:(id)key1 {
+    NSMutableArray *values = [_index objectForKey:key1];
+    NSUInteger pos = [values indexOfObjectIdenticalTo:value];
+    if (pos != NSNotFound) {
+        [values removeObjectAtIndex:pos];
+        if ([values count] == 0) {
+            [_index removeObjectForKey:key1];
+        }
+    }
+}
+
+// Override
+- (NSSet<id> *)allValues {
+    NSSet *values = _valuesSet;
+    if (!values) {
+        NSMutableSet *mSet = [[NSMutableSet alloc] initWithCapacity:_count];
+        for (NSUInteger i = 0; i <= _mask; ++i) {
+            if (_slots[i].value) {
+                [mSet addObject:(__bridge id)_slots[i].value];
+            }
+        }
+        values = [mSet copy];
+        _valuesSet = values;
+    }
+    return values;
+}
+
+// Override
+- (NSArray<id> *)valuesArray {
+    NSArray *values = _valuesList;
+    if (!values) {
+        values = [[self allValues] allObjects];
+        _valuesList = values;
+    }
+    return values;
+}
+
+// Override
+- (nullable id)objectForRemote:(nullable id)remote local:(nullable id)local {
+    id key1, key2;
+    if (!remote) {
+        NSAssert(local, @"local & remote addresses should not empty at the same time");
+        key1 = local;
+        key2 = nil;
+    } else {
+        key1 = remote;
+        key2 = local;
+    }
+    NSInteger pos;
+    if (key2) {
+        // mapping: (remote, local) => value
+        pos = [self findKey1:key1 key2:key2 hash:pair_hash(key1, key2)];
+        if (pos >= 0) {
+            return (__bridge id)_slots[pos].value;
+        }
+    }
+    // mapping: (remote, null) => value
+    // mapping: (local, null) => value
+    pos = [self findKey1:key1 key2:_defaultKey hash:pair_hash(key1, _defaultKey)];
+    if (pos >= 0) {
+        return (__bridge id)_slots[pos].value;
+    }
+    if (key2) {
+        return nil;
+    }
+    // take any value connected to remote / bound to local
+    return [[_index objectForKey:key1] firstObject];
+}
+
+// Override
+- (void)setObject:(id)value forRemote:(nullable id)remote local:(nullable id)local {
+    if (!value) {
+        [self removeObject:nil forRemote:remote local:local];
+        return;
+    }
+    id key1, key2;
+    if (!remote) {
+        NSAssert(local, @"local & remote addresses should not empty at the same time");
+        key1 = local;
+        key2 = _defaultKey;
+    } else if (!local) {
+        key1 = remote;
+        key2 = _defaultKey;
+    } else {
+        key1 = remote;
+        key2 = local;
+    }
+    NSUInteger hash = pair_hash(key1, key2);
+    NSInteger pos = [self findKey1:key1 key2:key2 hash:hash];
+    if (pos >= 0) {
+        // replace value
+        STFlatPairSlot *slot = &_slots[pos];
+        id old = (__bridge id)slot->value;
+        if (old != value) {
+            [self unindexValue:old forKey:key1];
+            [self indexValue:value forKey:key1];
+            slot_release(slot->value);
+            slot->value = (__bridge_retained void *)value;
+            [self changed];
+        }
+        return;
+    }
+    if ((_count + 1) * 4 > (_mask + 1) * 3) {
+        [self resize:((_mask + 1) << 1)];
+    }
+    NSUInteger i = hash & _mask;
+    while (_slots[i].value) {
+        i = (i + 1) & _mask;
+    }
+    _slots[i].hash = hash;
+    _slots[i].key1 = (__bridge_retained void *)key1;
+    _slots[i].key2 = (__bridge_retained void *)key2;
+    _slots[i].value = (__bridge_retained void *)value;
+    ++_count;
+    [self indexValue:value forKey:key1];
+    [self changed];
+}
+
+// Override
+- (nullable id)removeObject:(nullable id)value
+                  forRemote:(nullable id)remote local:(nullable id)local {
+    id key1, key2;
+    if (!remote) {
+        NSAssert(local, @"local & remote addresses should not empty at the same time");
+        key1 = local;
+        key2 = _defaultKey;
+    } else if (!local) {
+        key1 = remote;
+        key2 = _defaultKey;
+    } else {
+        key1 = remote;
+        key2 = local;
+    }
+    NSInteger pos = [self findKey1:key1 key2:key2 hash:pair_hash(key1, key2)];
+    if (pos < 0) {
+        return value;
+    }
+    id old = (__bridge id)_slots[pos].value;
+    [self unindexValue:old forKey:key1];
+    [self removeSlotAtIndex:pos];
+    [self changed];
+    return old;
+}
+
+@end
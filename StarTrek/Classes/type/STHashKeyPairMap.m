@@ -40,6 +40,10 @@
 
 @property(nonatomic, strong) NSMutableSet<id> *cachedValues;
 
+// immutable copy of cached values, nil after changed,
+// both are guarded by locking 'cachedValues'
+@property(nonatomic, strong, nullable) NSSet<id> *snapshot;
+
 @end
 
 @implementation STHashKeyPairMap
@@ -53,12 +57,16 @@
 
 // Override
 - (NSSet<id> *)allValues {
-    NSMutableSet *mSet = [[NSMutableSet alloc] init];
-    [_cachedValues enumerateObjectsWithOptions:NSEnumerationConcurrent
-                                    usingBlock:^(id obj, BOOL *stop) {
-        [mSet addObject:obj];
-    }];
-    return mSet;
+    @synchronized (_cachedValues) {
+        NSSet *values = _snapshot;
+        if (!values) {
+            // NOTICE: adding into a mutable set concurrently is not safe,
+            //         copy it once and reuse until changed.
+            values = [_cachedValues copy];
+            _snapshot = values;
+        }
+        return values;
+    }
 }
 
 // Override
@@ -67,9 +75,12 @@
     if (value) {
         // the caller may create different values with same pair (remote, local)
         // so here we should try to remove it first to make sure it's clean
-        [_cachedValues removeObject:value];
-        // cache it
-        [_cachedValues addObject:value];
+        @synchronized (_cachedValues) {
+            [_cachedValues removeObject:value];
+            // cache it
+            [_cachedValues addObject:value];
+            _snapshot = nil;
+        }
     }
     // create indexes
     [super setObject:value forRemote:remote local:local];
@@ -80,12 +91,15 @@
                   forRemote:(nullable id)remote local:(nullable id)local {
     // remove indexes
     id old = [super removeObject:value forRemote:remote local:local];
-    if (old) {
-        [_cachedValues removeObject:old];
-    }
-    // clear cached value
-    if (value && value != old) {
-        [_cachedValues removeObject:value];
+    @synchronized (_cachedValues) {
+        if (old) {
+            [_cachedValues removeObject:old];
+        }
+        // clear cached value
+        if (value && value != old) {
+            [_cachedValues removeObject:value];
+        }
+        _snapshot = nil;
     }
     return old ? old : value;
 }
@@ -47,6 +47,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (readonly, copy) NSSet<ObjectType> *allValues;
 
+/**
+ *  Get all mapped values as a stable array, for iterating by index
+ *
+ * @return values
+ */
+@property (readonly, copy) NSArray<ObjectType> *valuesArray;
+
 /**
  *  Get value by key pair (remote, local)
  *
@@ -45,6 +45,10 @@
     return nil;
 }
 
+- (NSArray<id> *)valuesArray {
+    return [[self allValues] allObjects];
+}
+
 - (nullable id)objectForRemote:(nullable id)remote local:(nullable id)local {
     NSAssert(false, @"override me!");
     return nil;
@@ -0,0 +1,73 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STReadySet.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Ready Set
+ *  ~~~~~~~~~
+ *
+ *  Objects to be driven in the next turn:
+ *      1. ready now, for events (data arrived, state changed, ...);
+ *      2. due at a time, kept in a min-heap, only the earliest time
+ *         of each object will be popped;
+ *      3. unmanaged, for objects not notifying, popped every turn.
+ *
+ *  Timers & unmanaged objects are held weakly; objects are compared by
+ *  identity, so two equal objects (e.g.: dockers for the same addresses)
+ *  will both be popped.
+ */
+@interface STReadySet<__covariant ObjectType> : NSObject
+
+- (void)addObject:(ObjectType)obj;
+
+- (void)addObject:(ObjectType)obj time:(NSTimeInterval)when;
+
+- (void)addUnmanagedObject:(ObjectType)obj;
+
+/**
+ *  Get objects ready now, and the due ones
+ *
+ * @param now - current time
+ * @return objects to be driven (each one once)
+ */
+- (NSArray<ObjectType> *)popObjectsWithTime:(NSTimeInterval)now;
+
+@end
+
+NS_ASSUME_NONNULL_END
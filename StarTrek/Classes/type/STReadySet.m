@@ -0,0 +1,174 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STReadySet.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STReadySet.h"
+
+@interface __ReadyTimer : NSObject
+
+@property(nonatomic, weak) id target;
+@property(nonatomic, assign) NSTimeInterval time;
+
+@end
+
+@implementation __ReadyTimer
+
+@end
+
+@interface STReadySet ()
+
+// objects ready now, by identity
+@property(nonatomic, strong) NSHashTable *ready;
+@property(nonatomic, strong) NSMutableArray<__ReadyTimer *> *timers;
+
+// object => earliest due time, for skipping later timers
+@property(nonatomic, strong) NSMapTable<id, NSNumber *> *dues;
+
+// objects not notifying, driven every turn
+@property(nonatomic, strong) NSHashTable *unmanaged;
+
+@end
+
+@implementation STReadySet
+
+- (instancetype)init {
+    if (self = [super init]) {
+        self.ready = [NSHashTable hashTableWithOptions:(NSPointerFunctionsStrongMemory |
+                                                        NSPointerFunctionsObjectPointerPersonality)];
+        self.timers = [[NSMutableArray alloc] init];
+        NSPointerFunctionsOptions keyOptions = NSPointerFunctionsWeakMemory
+                                             | NSPointerFunctionsObjectPointerPersonality;
+        self.dues = [NSMapTable mapTableWithKeyOptions:keyOptions
+                                          valueOptions:NSPointerFunctionsStrongMemory];
+        self.unmanaged = [NSHashTable hashTableWithOptions:(NSPointerFunctionsWeakMemory |
+                                                            NSPointerFunctionsObjectPointerPersonality)];
+    }
+    return self;
+}
+
+- (void)addObject:(id)obj {
+    @synchronized (self) {
+        [_ready addObject:obj];
+    }
+}
+
+- (void)addObject:(id)obj time:(NSTimeInterval)when {
+    @synchronized (self) {
+        NSNumber *due = [_dues objectForKey:obj];
+        if (due && [due doubleValue] <= when) {
+            // will be driven before that
+            return;
+        }
+        [_dues setObject:@(when) forKey:obj];
+        __ReadyTimer *timer = [[__ReadyTimer alloc] init];
+        timer.target = obj;
+        timer.time = when;
+        // sift up
+        NSUInteger pos = [_timers count];
+        [_timers addObject:timer];
+        NSUInteger parent;
+        while (pos > 0) {
+            parent = (pos - 1) / 2;
+            if ([_timers objectAtIndex:parent].time <= when) {
+                break;
+            }
+            [_timers exchangeObjectAtIndex:pos withObjectAtIndex:parent];
+            pos = parent;
+        }
+    }
+}
+
+- (void)addUnmanagedObject:(id)obj {
+    @synchronized (self) {
+        [_unmanaged addObject:obj];
+    }
+}
+
+// private
+- (__ReadyTimer *)popTimer {
+    __ReadyTimer *top = [_timers firstObject];
+    __ReadyTimer *last = [_timers lastObject];
+    [_timers removeLastObject];
+    NSUInteger count = [_timers count];
+    if (count == 0) {
+        return top;
+    }
+    [_timers replaceObjectAtIndex:0 withObject:last];
+    // sift down
+    NSUInteger pos = 0, child;
+    while ((child = pos * 2 + 1) < count) {
+        if (child + 1 < count && [_timers objectAtIndex:(child + 1)].time < [_timers objectAtIndex:child].time) {
+            ++child;
+        }
+        if ([_timers objectAtIndex:pos].time <= [_timers objectAtIndex:child].time) {
+            break;
+        }
+        [_timers exchangeObjectAtIndex:pos withObjectAtIndex:child];
+        pos = child;
+    }
+    return top;
+}
+
+- (NSArray *)popObjectsWithTime:(NSTimeInterval)now {
+    @synchronized (self) {
+        // move due timers into the ready set
+        __ReadyTimer *timer;
+        id obj;
+        NSNumber *due;
+        while ((timer = [_timers firstObject]) && timer.time <= now) {
+            [self popTimer];
+            obj = timer.target;
+            if (!obj) {
+                // object released
+                continue;
+            }
+            due = [_dues objectForKey:obj];
+            if (!due || [due doubleValue] != timer.time) {
+                // replaced by an earlier timer, stale
+                continue;
+            }
+            [_dues removeObjectForKey:obj];
+            [_ready addObject:obj];
+        }
+        for (obj in _unmanaged) {
+            [_ready addObject:obj];
+        }
+        NSArray *objects = [_ready allObjects];
+        [_ready removeAllObjects];
+        return objects;
+    }
+}
+
+@end
@@ -0,0 +1,133 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STRingBuffer.h
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Ring Buffer
+ *  ~~~~~~~~~~~
+ *
+ *  Lock-free byte queue for one producer thread and one consumer thread:
+ *      1. stream: bytes are written & read in any length (like TCP);
+ *      2. datagram: each packet is stored with a 4-byte length header,
+ *         pushed all or nothing, popped one by one (like UDP).
+ *
+ *  Don't mix the two modes on one buffer. Memory is allocated on the first
+ *  write, so idle buffers cost nothing but the object itself.
+ */
+@interface STRingBuffer : NSObject
+
+// max bytes in the buffer (power of 2)
+@property(nonatomic, readonly) NSUInteger capacity;
+
+// max length of one packet (capacity - header)
+@property(nonatomic, readonly) NSUInteger maxPacketLength;
+
+// consumer side: bytes waiting to be read
+@property(nonatomic, readonly) NSUInteger available;
+
+// producer side: bytes can be written now
+@property(nonatomic, readonly) NSUInteger space;
+
+// closed by either side, no more data will be written
+@property(nonatomic, readonly, getter=isClosed) BOOL closed;
+
+- (instancetype)initWithCapacity:(NSUInteger)size
+NS_DESIGNATED_INITIALIZER;
+
+#pragma mark Stream
+
+/**
+ *  Write bytes as many as possible (producer)
+ *
+ * @param bytes  - data
+ * @param length - data length
+ * @return count of bytes written, -1 on closed
+ */
+- (NSInteger)writeBytes:(const void *)bytes length:(NSUInteger)length;
+
+/**
+ *  Read bytes as many as possible (consumer)
+ *
+ * @param buffer - destination
+ * @param length - max length
+ * @return count of bytes read
+ */
+- (NSUInteger)readBytes:(void *)buffer length:(NSUInteger)length;
+
+#pragma mark Datagram
+
+/**
+ *  Push a packet (producer)
+ *
+ * @param bytes  - packet data
+ * @param length - packet length
+ * @return NO when no enough space (or closed)
+ */
+- (BOOL)pushPacket:(const void *)bytes length:(NSUInteger)length;
+
+/**
+ *  Pop the next packet (consumer), the rest is dropped
+ *  if the buffer is too small (truncated like UDP)
+ *
+ * @param buffer - destination
+ * @param length - max length
+ * @return count of bytes copied, -1 on no packet
+ */
+- (NSInteger)popPacket:(void *)buffer length:(NSUInteger)length;
+
+// consumer side: length of the next packet, 0 on empty
+@property(nonatomic, readonly) NSUInteger nextPacketLength;
+
+#pragma mark Signal
+
+/**
+ *  Mark readable after writing (producer)
+ *
+ * @return YES when it's not marked before, the consumer should be notified
+ */
+- (BOOL)signal;
+
+// clear the mark before reading (consumer)
+- (void)clearSignal;
+
+- (void)close;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,215 @@
+// license: https://mit-license.org
+//
+//  StarTrek : Interstellar Transport
+//
+//                               Written in 2023 by Moky <albert.moky@gmail.com>
+//
+// =============================================================================
+// The MIT License (MIT)
+//
+// Copyright (c) 2023 Albert Moky
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+// =============================================================================
+//
+//  STRingBuffer.m
+//  StarTrek
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STRingBuffer.h"
+
+static const NSUInteger RING_PACKET_HEAD = 4;  // UInt32 length
+
+static inline NSUInteger ring_capacity(NSUInteger size) {
+    NSUInteger capacity = 64;
+    while (capacity < size) {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+static inline void ring_copy_in(UInt8 *ring, NSUInteger mask, NSUInteger pos,
+                                const UInt8 *src, NSUInteger len) {
+    NSUInteger offset = pos & mask;
+    NSUInteger first = MIN(len, mask + 1 - offset);
+    memcpy(ring + offset, src, first);
+    if (len > first) {
+        // wrapped
+        memcpy(ring, src + first, len - first);
+    }
+}
+
+static inline void ring_copy_out(const UInt8 *ring, NSUInteger mask, NSUInteger pos,
+                                 UInt8 *dst, NSUInteger len) {
+    NSUInteger offset = pos & mask;
+    NSUInteger first = MIN(len, mask + 1 - offset);
+    memcpy(dst, ring + offset, first);
+    if (len > first) {
+        // wrapped
+        memcpy(dst + first, ring, len - first);
+    }
+}
+
+@interface STRingBuffer () {
+
+    UInt8 *_ring;      // allocated by the producer on first write
+    NSUInteger _mask;
+
+    NSUInteger _head;  // read position, moved by the consumer only
+    NSUInteger _tail;  // write position, moved by the producer only
+
+    int _signaled;
+    int _closed;
+}
+
+@end
+
+@implementation STRingBuffer
+
+- (instancetype)init {
+    return [self initWithCapacity:65536];
+}
+
+/* designated initializer */
+- (instancetype)initWithCapacity:(NSUInteger)size {
+    if (self = [super init]) {
+        _capacity = ring_capacity(size);
+        _mask = _capacity - 1;
+        _ring = NULL;
+        _head = 0;
+        _tail = 0;
+        _signaled = 0;
+        _closed = 0;
+    }
+    return self;
+}
+
+- (void)dealloc {
+    if (_ring) {
+        free(_ring);
+        _ring = NULL;
+    }
+}
+
+- (NSUInteger)available {
+    NSUInteger tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    return tail - _head;
+}
+
+- (NSUInteger)maxPacketLength {
+    return _capacity - RING_PACKET_HEAD;
+}
+
+- (NSUInteger)space {
+    NSUInteger head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+    return _capacity - (_tail - head);
+}
+
+- (BOOL)isClosed {
+    return __atomic_load_n(&_closed, __ATOMIC_ACQUIRE) != 0;
+}
+
+- (void)close {
+    __atomic_store_n(&_closed, 1, __ATOMIC_RELEASE);
+}
+
+// private
+- (BOOL)prepareRing {
+    if (!_ring) {
+        // published to the consumer by the next release of '_tail'
+        _ring = malloc(_capacity);
+    }
+    return _ring != NULL;
+}
+
+#pragma mark Stream
+
+- (NSInteger)writeBytes:(const void *)bytes length:(NSUInteger)length {
+    if ([self isClosed]) {
+        return -1;
+    }
+    NSUInteger count = MIN(length, [self space]);
+    if (count == 0 || ![self prepareRing]) {
+        return 0;
+    }
+    ring_copy_in(_ring, _mask, _tail, bytes, count);
+    __atomic_store_n(&_tail, _tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+- (NSUInteger)readBytes:(void *)buffer length:(NSUInteger)length {
+    NSUInteger count = MIN(length, [self available]);
+    if (count == 0) {
+        return 0;
+    }
+    ring_copy_out(_ring, _mask, _head, buffer, count);
+    __atomic_store_n(&_head, _head + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+#pragma mark Datagram
+
+- (BOOL)pushPacket:(const void *)bytes length:(NSUInteger)length {
+    if ([self isClosed] || length > UINT32_MAX) {
+        return NO;
+    }
+    if (RING_PACKET_HEAD + length > [self space] || ![self prepareRing]) {
+        return NO;
+    }
+    UInt32 head = (UInt32)length;
+    ring_copy_in(_ring, _mask, _tail, (const UInt8 *)&head, RING_PACKET_HEAD);
+    ring_copy_in(_ring, _mask, _tail + RING_PACKET_HEAD, bytes, length);
+    __atomic_store_n(&_tail, _tail + RING_PACKET_HEAD + length, __ATOMIC_RELEASE);
+    return YES;
+}
+
+- (NSUInteger)nextPacketLength {
+    if ([self available] < RING_PACKET_HEAD) {
+        return 0;
+    }
+    UInt32 head = 0;
+    ring_copy_out(_ring, _mask, _head, (UInt8 *)&head, RING_PACKET_HEAD);
+    return head;
+}
+
+- (NSInteger)popPacket:(void *)buffer length:(NSUInteger)length {
+    if ([self available] < RING_PACKET_HEAD) {
+        return -1;
+    }
+    UInt32 head = 0;
+    ring_copy_out(_ring, _mask, _head, (UInt8 *)&head, RING_PACKET_HEAD);
+    NSUInteger count = MIN(length, (NSUInteger)head);
+    ring_copy_out(_ring, _mask, _head + RING_PACKET_HEAD, buffer, count);
+    __atomic_store_n(&_head, _head + RING_PACKET_HEAD + head, __ATOMIC_RELEASE);
+    return count;
+}
+
+#pragma mark Signal
+
+- (BOOL)signal {
+    return __atomic_exchange_n(&_signaled, 1, __ATOMIC_SEQ_CST) == 0;
+}
+
+- (void)clearSignal {
+    __atomic_store_n(&_signaled, 0, __ATOMIC_SEQ_CST);
+}
+
+@end
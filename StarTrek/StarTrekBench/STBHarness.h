@@ -0,0 +1,124 @@
+//
+//  STBHarness.h
+//  StarTrekBench
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Prepare 'n' entities before measuring,
+ *  extra numbers (e.g. footprint) can be put into 'metrics'
+ */
+typedef void (^STBSetupBlock)(NSUInteger n, NSMutableDictionary<NSString *, id> *metrics);
+
+// one operation, 'i' counts from 0 in each run
+typedef void (^STBOperationBlock)(NSUInteger i);
+
+typedef void (^STBTeardownBlock)(void);
+
+/**
+ *  Benchmark
+ *  ~~~~~~~~~
+ *
+ *  Runs 'operations' times of the operation block for each size,
+ *  the sizes are entity counts for a scaling curve (or payload sizes
+ *  when 'sizeInBytes' is set).
+ */
+@interface STBBenchmark : NSObject
+
+@property(nonatomic, copy) NSString *name;
+
+// sizes of this benchmark, nil means the harness default (1 ... 1M)
+@property(nonatomic, strong, nullable) NSArray<NSNumber *> *sizes;
+
+// operations per run (default is 100,000)
+@property(nonatomic, assign) NSUInteger operations;
+
+// bytes handled by one operation, for MB/s
+// (0 means the size when 'sizeInBytes', or no throughput of bytes)
+@property(nonatomic, assign) NSUInteger bytesPerOperation;
+
+// the size is a length in bytes, not an entity count (never skipped)
+@property(nonatomic, assign) BOOL sizeInBytes;
+
+@property(nonatomic, copy, nullable) STBSetupBlock setup;
+@property(nonatomic, copy) STBOperationBlock operation;
+@property(nonatomic, copy, nullable) STBTeardownBlock teardown;
+
++ (instancetype)benchmarkWithName:(NSString *)name;
+
+@end
+
+/**
+ *  Benchmark Harness
+ *  ~~~~~~~~~~~~~~~~~
+ *
+ *  For each benchmark and size:
+ *      1. setup, with heap bytes & objects measured around it;
+ *      2. run operations, the total time gives the throughput,
+ *         and up to 'maxSamples' operations are timed one by one
+ *         for latency percentiles;
+ *      3. count objects allocated per operation;
+ *      4. teardown.
+ *
+ *  Object counting needs GNUstep (GSDebugAllocation), on Darwin
+ *  the net change of malloc blocks is reported for setup instead,
+ *  and 'allocs_per_op' is omitted (a net count can't tell allocations).
+ */
+@interface STBHarness : NSObject
+
+// default sizes (1, 10, 100, ... 1,000,000)
+@property(nonatomic, strong) NSArray<NSNumber *> *sizes;
+
+// sizes larger than this will be skipped
+@property(nonatomic, assign) NSUInteger maxSize;
+
+// operations timed one by one in each run (default is 100,000)
+@property(nonatomic, assign) NSUInteger maxSamples;
+
+// run benchmarks whose names contain this only
+@property(nonatomic, copy, nullable) NSString *filter;
+
+@property(nonatomic, readonly) NSArray<STBBenchmark *> *benchmarks;
+
+- (void)addBenchmark:(STBBenchmark *)bench;
+
+/**
+ *  Run all benchmarks, progress is printed to stderr
+ *
+ * @return results
+ */
+- (NSArray<NSDictionary<NSString *, id> *> *)run;
+
+/**
+ *  Build JSON report
+ *
+ * @param results - results from 'run'
+ * @return JSON data
+ */
+- (NSData *)JSONDataWithResults:(NSArray<NSDictionary<NSString *, id> *> *)results;
+
+@end
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// monotonic time in nanoseconds
+uint64_t STBNanoTime(void);
+
+// bytes in use by malloc
+uint64_t STBHeapBytes(void);
+
+// objects allocated so far (GNUstep), or malloc blocks in use (Darwin)
+uint64_t STBObjectCount(void);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+NS_ASSUME_NONNULL_END
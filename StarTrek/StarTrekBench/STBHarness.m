@@ -0,0 +1,280 @@
+//
+//  STBHarness.m
+//  StarTrekBench
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <time.h>
+
+#if defined(GNUSTEP)
+#import <Foundation/NSDebug.h>
+#elif defined(__APPLE__)
+#import <malloc/malloc.h>
+#endif
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#import "STBHarness.h"
+
+static const NSUInteger BENCH_OPERATIONS = 100000;
+static const NSUInteger BENCH_SAMPLES = 100000;
+static const NSUInteger BENCH_MAX_SIZE = 1000000;
+
+// drain autoreleased objects every 1024 operations
+static const NSUInteger BENCH_POOL_MASK = 0x3FF;
+
+uint64_t STBNanoTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t STBHeapBytes(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#elif defined(__GLIBC__)
+    struct mallinfo info = mallinfo();
+    return (uint32_t)info.uordblks + (uint32_t)info.hblkhd;
+#elif defined(__APPLE__)
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.size_in_use;
+#else
+    return 0;
+#endif
+}
+
+uint64_t STBObjectCount(void) {
+#if defined(GNUSTEP)
+    uint64_t total = 0;
+    Class *list = (Class *)GSDebugAllocationClassList();
+    if (list) {
+        for (Class *cls = list; *cls; ++cls) {
+            total += GSDebugAllocationTotal(*cls);
+        }
+        free(list);
+    }
+    return total;
+#elif defined(__APPLE__)
+    malloc_statistics_t stats;
+    malloc_zone_statistics(NULL, &stats);
+    return stats.blocks_in_use;
+#else
+    return 0;
+#endif
+}
+
+static int compare_samples(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+static inline uint64_t percentile(const uint64_t *sorted, NSUInteger count, double q) {
+    NSUInteger index = (NSUInteger)(q * count);
+    return sorted[index < count ? index : count - 1];
+}
+
+@implementation STBBenchmark
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _operations = BENCH_OPERATIONS;
+        _bytesPerOperation = 0;
+        _sizeInBytes = NO;
+    }
+    return self;
+}
+
++ (instancetype)benchmarkWithName:(NSString *)name {
+    STBBenchmark *bench = [[self alloc] init];
+    bench.name = name;
+    return bench;
+}
+
+@end
+
+#pragma mark -
+
+@interface STBHarness ()
+
+@property(nonatomic, strong) NSMutableArray<STBBenchmark *> *list;
+
+@end
+
+@implementation STBHarness
+
+- (instancetype)init {
+    if (self = [super init]) {
+        self.sizes = @[@1, @10, @100, @1000, @10000, @100000, @1000000];
+        self.maxSize = BENCH_MAX_SIZE;
+        self.maxSamples = BENCH_SAMPLES;
+        self.filter = nil;
+        self.list = [[NSMutableArray alloc] init];
+#if defined(GNUSTEP)
+        GSDebugAllocationActive(YES);
+#endif
+    }
+    return self;
+}
+
+- (NSArray<STBBenchmark *> *)benchmarks {
+    return _list;
+}
+
+- (void)addBenchmark:(STBBenchmark *)bench {
+    [_list addObject:bench];
+}
+
+- (NSArray<NSDictionary<NSString *, id> *> *)run {
+    NSMutableArray *results = [[NSMutableArray alloc] init];
+    NSArray<NSNumber *> *sizes;
+    NSUInteger n;
+    for (STBBenchmark *bench in _list) {
+        if ([_filter length] > 0 && [bench.name rangeOfString:_filter].location == NSNotFound) {
+            continue;
+        }
+        sizes = bench.sizes ? bench.sizes : _sizes;
+        for (NSNumber *size in sizes) {
+            n = [size unsignedIntegerValue];
+            if (n > _maxSize && !bench.sizeInBytes) {
+                continue;
+            }
+            fprintf(stderr, "%-40s n=%-8lu ", [bench.name UTF8String], (unsigned long)n);
+            NSDictionary *result = [self runBenchmark:bench size:n];
+            fprintf(stderr, "%12.0f ops/s  p50=%llu ns  p99=%llu ns\n",
+                    [result[@"ops_per_sec"] doubleValue],
+                    [result[@"latency_ns"][@"p50"] unsignedLongLongValue],
+                    [result[@"latency_ns"][@"p99"] unsignedLongLongValue]);
+            [results addObject:result];
+        }
+    }
+    return results;
+}
+
+// private
+- (NSDictionary<NSString *, id> *)runBenchmark:(STBBenchmark *)bench size:(NSUInteger)n {
+    NSMutableDictionary *metrics = [[NSMutableDictionary alloc] init];
+    // 1. setup
+    uint64_t heap = STBHeapBytes();
+    uint64_t objects = STBObjectCount();
+    uint64_t start = STBNanoTime();
+    @autoreleasepool {
+        if (bench.setup) {
+            bench.setup(n, metrics);
+        }
+    }
+    uint64_t setupNanos = STBNanoTime() - start;
+    int64_t setupHeap = (int64_t)(STBHeapBytes() - heap);
+    int64_t setupObjects = (int64_t)(STBObjectCount() - objects);
+    // 2. run
+    NSUInteger ops = bench.operations;
+    NSUInteger stride = 1;
+    if (_maxSamples > 0 && ops > _maxSamples) {
+        stride = (ops + _maxSamples - 1) / _maxSamples;
+    }
+    uint64_t *samples = malloc(sizeof(uint64_t) * (ops / stride + 1));
+    NSUInteger count = 0;
+    STBOperationBlock operation = bench.operation;
+    uint64_t time;
+    NSUInteger i = 0, end;
+    objects = STBObjectCount();
+    start = STBNanoTime();
+    while (i < ops) {
+        end = MIN(ops, (i | BENCH_POOL_MASK) + 1);
+        @autoreleasepool {
+            for (; i < end; ++i) {
+                if (i % stride == 0) {
+                    time = STBNanoTime();
+                    operation(i);
+                    samples[count++] = STBNanoTime() - time;
+                } else {
+                    operation(i);
+                }
+            }
+        }
+    }
+    uint64_t elapsed = STBNanoTime() - start;
+    // net count on Darwin (blocks in use), so it may go down
+    int64_t allocated = (int64_t)(STBObjectCount() - objects);
+    (void)allocated;  // reported on GNUstep only
+    // 3. teardown
+    @autoreleasepool {
+        if (bench.teardown) {
+            bench.teardown();
+        }
+    }
+    // 4. report
+    qsort(samples, count, sizeof(uint64_t), compare_samples);
+    NSDictionary *latency = @{
+        @"samples": @(count),
+        @"p50":  @(count > 0 ? percentile(samples, count, 0.50) : 0),
+        @"p90":  @(count > 0 ? percentile(samples, count, 0.90) : 0),
+        @"p99":  @(count > 0 ? percentile(samples, count, 0.99) : 0),
+        @"p999": @(count > 0 ? percentile(samples, count, 0.999) : 0),
+        @"max":  @(count > 0 ? samples[count - 1] : 0),
+    };
+    free(samples);
+    double seconds = elapsed / 1e9;
+    NSUInteger bytes = bench.bytesPerOperation;
+    if (bytes == 0 && bench.sizeInBytes) {
+        bytes = n;
+    }
+    NSMutableDictionary *result = [[NSMutableDictionary alloc] init];
+    result[@"name"] = bench.name;
+    result[@"size"] = @(n);
+    result[@"operations"] = @(ops);
+    result[@"seconds"] = @(seconds);
+    result[@"ops_per_sec"] = @(seconds > 0 ? ops / seconds : 0);
+    result[@"ns_per_op"] = @(ops > 0 ? (double)elapsed / ops : 0);
+    if (bytes > 0) {
+        result[@"mb_per_sec"] = @(seconds > 0 ? (double)bytes * ops / seconds / (1 << 20) : 0);
+    }
+    result[@"latency_ns"] = latency;
+#if defined(GNUSTEP)
+    // only cumulative counters tell allocations per operation
+    result[@"allocs_per_op"] = @(ops > 0 ? (double)allocated / ops : 0);
+#endif
+    result[@"setup"] = @{
+        @"seconds": @(setupNanos / 1e9),
+        @"heap_bytes": @(setupHeap),
+        @"objects": @(setupObjects),
+        @"heap_bytes_per_entity": @(n > 0 ? (double)setupHeap / n : 0),
+        @"objects_per_entity": @(n > 0 ? (double)setupObjects / n : 0),
+    };
+    if ([metrics count] > 0) {
+        result[@"metrics"] = metrics;
+    }
+    return result;
+}
+
+- (NSData *)JSONDataWithResults:(NSArray<NSDictionary<NSString *, id> *> *)results {
+    NSProcessInfo *info = [NSProcessInfo processInfo];
+#if defined(GNUSTEP)
+    NSString *runtime = @"gnustep";
+#else
+    NSString *runtime = @"apple";
+#endif
+    NSDictionary *report = @{
+        @"suite": @"StarTrek",
+        @"timestamp": @([[NSDate date] timeIntervalSince1970]),
+        @"platform": @{
+            @"os": [info operatingSystemVersionString],
+            @"cpus": @([info activeProcessorCount]),
+            @"runtime": runtime,
+        },
+        @"results": results,
+    };
+    NSError *error = nil;
+    NSData *json = [NSJSONSerialization dataWithJSONObject:report
+                                                   options:NSJSONWritingPrettyPrinted
+                                                     error:&error];
+    NSAssert(!error, @"JSON error: %@", error);
+    return json;
+}
+
+@end
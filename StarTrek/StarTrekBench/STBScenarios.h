@@ -0,0 +1,37 @@
+//
+//  STBScenarios.h
+//  StarTrekBench
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STBHarness.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Register all benchmarks of the transport core:
+ *
+ *      nio.bytebuffer.*      - put/flip/get payloads
+ *      dock.departure_hall.* - add/send/ack with 'n' ships waiting
+ *      dock.arrival_hall.*   - assemble fragments with 'n' ships cached
+ *      type.pair_map.*       - lookup & footprint, flat vs nested tables
+ *      socket.hub.*          - process with 'n' connections
+ *      gate.*                - process with 'n' dockers
+ *      frame_decoder.*       - delimiter scan over 1 MB of 64-byte lines
+ *      docker.partial_send.* - resume partial sends on a tiny socket buffer
+ *      net.state_machine.*   - footprint of connection state machines, shared vs owned states
+ *      loopback.*            - round trip through loopback hubs with 'n' connections
+ *      impair.*              - ships over impaired loopback, size is the loss rate in per mille
+ */
+void STBRegisterScenarios(STBHarness *harness);
+
+#ifdef __cplusplus
+} /* end of extern "C" */
+#endif
+
+NS_ASSUME_NONNULL_END
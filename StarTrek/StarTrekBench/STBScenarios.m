@@ -0,0 +1,1229 @@
+//
+//  STBScenarios.m
+//  StarTrekBench
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <errno.h>
+#import <fcntl.h>
+#import <unistd.h>
+#import <sys/socket.h>
+
+#import <ObjectKey/ObjectKey.h>
+#import <StarTrek/StarTrek.h>
+
+#import "STBScenarios.h"
+
+static const NSUInteger BENCH_LINE_LENGTH = 64;          // including CR LF
+static const NSUInteger BENCH_SCAN_LENGTH = 1024 * 1024;  // 1 MB
+static const int BENCH_TINY_SNDBUF = 4096;
+
+static inline NSArray<NSNumber *> *entity_sizes(NSUInteger max) {
+    NSMutableArray *sizes = [[NSMutableArray alloc] init];
+    for (NSUInteger n = 1; n <= max; n *= 10) {
+        [sizes addObject:@(n)];
+    }
+    return sizes;
+}
+
+// distinct address for entity 'i'
+static inline id<NIOSocketAddress> bench_address(NSUInteger i) {
+    NSString *host = [NSString stringWithFormat:@"10.%lu.%lu.%lu",
+                      (unsigned long)((i >> 16) & 0xFF),
+                      (unsigned long)((i >> 8) & 0xFF),
+                      (unsigned long)(i & 0xFF)];
+    UInt16 port = (UInt16)(1024 + (i >> 24));
+    return [NIOInetSocketAddress addressWithHost:host port:port];
+}
+
+// visit entities out of order
+static inline NSUInteger scatter(NSUInteger i, NSUInteger n) {
+    return (NSUInteger)(((uint64_t)i * 2654435761ULL) % n);
+}
+
+#pragma mark - Ships
+
+@interface STBDeparture : STDeparture {
+
+    NSNumber *_sn;
+    NSArray<NSData *> *_fragments;
+}
+
+- (instancetype)initWithSN:(NSUInteger)sn fragment:(NSData *)fra;
+
+@end
+
+@implementation STBDeparture
+
+- (instancetype)initWithSN:(NSUInteger)sn fragment:(NSData *)fra {
+    if (self = [super initWithPriority:STDeparturePriorityNormal maxTries:3]) {
+        _sn = @(sn);
+        _fragments = @[fra];
+    }
+    return self;
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (NSArray<NSData *> *)fragments {
+    return _fragments;
+}
+
+// Override
+- (BOOL)checkResponseWithinArrivalShip:(id<STArrival>)response {
+    _fragments = @[];
+    return YES;
+}
+
+// Override
+- (BOOL)isImportant {
+    return YES;
+}
+
+@end
+
+@interface STBArrival : STArrival {
+
+    NSNumber *_sn;
+    NSUInteger _pages;
+    NSUInteger _received;
+}
+
+- (instancetype)initWithSN:(NSUInteger)sn pages:(NSUInteger)count time:(NSTimeInterval)now;
+
+@end
+
+@implementation STBArrival
+
+- (instancetype)initWithSN:(NSUInteger)sn pages:(NSUInteger)count time:(NSTimeInterval)now {
+    if (self = [super initWithTime:now]) {
+        _sn = @(sn);
+        _pages = count;
+        _received = 0;
+    }
+    return self;
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (nullable id<STArrival>)assembleArrivalShip:(id<STArrival>)income {
+    _received += 1;
+    return _received >= _pages ? self : nil;
+}
+
+@end
+
+#pragma mark - Channel, Hub & Gate
+
+/**
+ *  Channel always alive, data sent will be dropped
+ */
+@interface STBNullChannel : NSObject <STChannel>
+
+@property(nonatomic, strong) id<NIOSocketAddress> remoteAddress;
+@property(nonatomic, strong) id<NIOSocketAddress> localAddress;
+
+- (instancetype)initWithRemoteAddress:(id<NIOSocketAddress>)remote
+                         localAddress:(id<NIOSocketAddress>)local;
+
+@end
+
+@implementation STBNullChannel
+
+- (instancetype)initWithRemoteAddress:(id<NIOSocketAddress>)remote
+                         localAddress:(id<NIOSocketAddress>)local {
+    if (self = [super init]) {
+        self.remoteAddress = remote;
+        self.localAddress = local;
+    }
+    return self;
+}
+
+- (BOOL)isOpen {
+    return YES;
+}
+
+- (BOOL)isBound {
+    return YES;
+}
+
+- (BOOL)isConnected {
+    return YES;
+}
+
+- (BOOL)isAlive {
+    return YES;
+}
+
+- (BOOL)isBlocking {
+    return NO;
+}
+
+- (void)close {
+}
+
+- (nullable NIOSelectableChannel *)configureBlocking:(BOOL)blocking {
+    return nil;
+}
+
+- (nullable id<NIONetworkChannel>)bindLocalAddress:(id<NIOSocketAddress>)local
+                                            throws:(NIOException **)error {
+    return nil;
+}
+
+- (nullable id<NIONetworkChannel>)connectRemoteAddress:(id<NIOSocketAddress>)remote
+                                                throws:(NIOException **)error {
+    return nil;
+}
+
+- (nullable id<NIOByteChannel>)disconnect {
+    return nil;
+}
+
+- (NSInteger)readWithBuffer:(NIOByteBuffer *)dst throws:(NIOException **)error {
+    return 0;
+}
+
+- (NSInteger)writeWithBuffer:(NIOByteBuffer *)src throws:(NIOException **)error {
+    NSInteger len = [src remaining];
+    [src position:[src limit]];
+    return len;
+}
+
+- (nullable id<NIOSocketAddress>)receiveWithBuffer:(NIOByteBuffer *)dst
+                                            throws:(NIOException **)error {
+    return nil;
+}
+
+- (NSInteger)sendWithBuffer:(NIOByteBuffer *)src
+              remoteAddress:(id<NIOSocketAddress>)remote
+                     throws:(NIOException **)error {
+    return [self writeWithBuffer:src throws:error];
+}
+
+@end
+
+// hub without sockets, only connections are driven
+@interface STBHub : STHub
+
+@end
+
+@implementation STBHub
+
+// Override
+- (NSSet<id<STChannel>> *)allChannels {
+    return [NSSet set];
+}
+
+// Override
+- (void)removeChannel:(id<STChannel>)channel
+        remoteAddress:(id<NIOSocketAddress>)remote
+         localAddress:(id<NIOSocketAddress>)local {
+}
+
+// Override
+- (nullable id<STChannel>)openChannelForRemoteAddress:(nullable id<NIOSocketAddress>)remote
+                                         localAddress:(nullable id<NIOSocketAddress>)local {
+    return nil;
+}
+
+// Override
+- (NSUInteger)availableInChannel:(id<STChannel>)channel {
+    return 0;
+}
+
+@end
+
+@interface STBDocker : STDocker
+
+@end
+
+@implementation STBDocker
+
+// Override
+- (void)heartbeat {
+}
+
+// Override
+- (BOOL)sendData:(NSData *)payload {
+    return NO;
+}
+
+// Override
+- (id<STArrival>)arrivalWithData:(NSData *)data {
+    return nil;
+}
+
+// Override
+- (id<STArrival>)checkArrival:(id<STArrival>)income {
+    return income;
+}
+
+@end
+
+@interface STBGate : STGate
+
+@end
+
+@implementation STBGate
+
+// Override
+- (id<STDocker>)createDockerWithConnection:(id<STConnection>)conn
+                              advanceParty:(NSArray<NSData *> *)data {
+    return [[STBDocker alloc] initWithConnection:conn];
+}
+
+@end
+
+// open connections on null channels, channels are kept in 'channels'
+static inline NSArray<STConnection *> *open_connections(NSUInteger n,
+                                                        NSMutableArray *channels) {
+    NSMutableArray *connections = [[NSMutableArray alloc] initWithCapacity:n];
+    id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    id<NIOSocketAddress> remote;
+    STBNullChannel *sock;
+    STConnection *conn;
+    for (NSUInteger i = 0; i < n; ++i) {
+        remote = bench_address(i);
+        sock = [[STBNullChannel alloc] initWithRemoteAddress:remote localAddress:local];
+        conn = [[STConnection alloc] initWithChannel:sock remoteAddress:remote localAddress:local];
+        [channels addObject:sock];
+        [connections addObject:conn];
+    }
+    return connections;
+}
+
+#pragma mark - Scenarios
+
+static void register_bytebuffer(STBHarness *harness) {
+    __block NIOByteBuffer *buffer;
+    __block NSData *payload;
+    __block NSMutableData *output;
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:@"nio.bytebuffer.put_get"];
+    bench.sizes = @[@64, @1472, @65536];
+    bench.sizeInBytes = YES;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        buffer = [NIOByteBuffer bufferWithCapacity:n];
+        payload = [[NSMutableData alloc] initWithLength:n];
+        output = [[NSMutableData alloc] initWithLength:n];
+    };
+    bench.operation = ^(NSUInteger i) {
+        [buffer clear];
+        [buffer putData:payload];
+        [buffer flip];
+        [buffer getData:output];
+    };
+    bench.teardown = ^{
+        buffer = nil;
+        payload = nil;
+        output = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+static void register_departure_hall(STBHarness *harness) {
+    __block STDepartureHall *hall;
+    __block NSData *fragment;
+    __block NSUInteger next;
+    __block NSTimeInterval now;
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:@"dock.departure_hall.add_send_ack"];
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        hall = [[STDepartureHall alloc] init];
+        fragment = [[NSMutableData alloc] initWithLength:1024];
+        now = OKGetCurrentTimeInterval();
+        for (next = 0; next < n; ++next) {
+            [hall addDeparture:[[STBDeparture alloc] initWithSN:next fragment:fragment] time:now];
+        }
+    };
+    // keep 'n' ships waiting: send one, respond it, and add a new one
+    bench.operation = ^(NSUInteger i) {
+        id<STDeparture> ship = [hall nextDepartureWithTime:now];
+        if (ship) {
+            NSUInteger sn = [(NSNumber *)[ship sn] unsignedIntegerValue];
+            STBArrival *ack = [[STBArrival alloc] initWithSN:sn pages:1 time:now];
+            [hall checkResponseInArrival:ack time:now];
+        }
+        [hall addDeparture:[[STBDeparture alloc] initWithSN:next++ fragment:fragment] time:now];
+    };
+    bench.teardown = ^{
+        hall = nil;
+        fragment = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+static void register_arrival_hall(STBHarness *harness) {
+    __block STArrivalHall *hall;
+    __block NSUInteger pending;
+    __block NSTimeInterval now;
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:@"dock.arrival_hall.assemble"];
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        hall = [[STArrivalHall alloc] init];
+        pending = n;
+        now = OKGetCurrentTimeInterval();
+        for (NSUInteger sn = 0; sn < n; ++sn) {
+            [hall assembleArrival:[[STBArrival alloc] initWithSN:sn pages:2 time:now] time:now];
+        }
+    };
+    // keep 'n' ships assembling: complete the oldest one, and start a new one
+    bench.operation = ^(NSUInteger i) {
+        [hall assembleArrival:[[STBArrival alloc] initWithSN:i pages:2 time:now] time:now];
+        [hall assembleArrival:[[STBArrival alloc] initWithSN:(i + pending) pages:2 time:now] time:now];
+    };
+    bench.teardown = ^{
+        hall = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+static void register_pair_map(STBHarness *harness, NSString *kind) {
+    BOOL flat = [kind isEqualToString:@"flat"];
+    __block STKeyPairMap<id<NIOSocketAddress>, id> *map;
+    __block NSArray<id<NIOSocketAddress>> *remotes;
+    __block id<NIOSocketAddress> local;
+    __block NSUInteger count;
+    NSString *name = [NSString stringWithFormat:@"type.pair_map.%@.lookup", kind];
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.operations = 1000000;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        NSMutableArray *keys = [[NSMutableArray alloc] initWithCapacity:n];
+        for (NSUInteger i = 0; i < n; ++i) {
+            [keys addObject:bench_address(i)];
+        }
+        remotes = keys;
+        local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+        count = n;
+        // footprint of the map only (keys & values exist already)
+        uint64_t heap = STBHeapBytes();
+        uint64_t objects = STBObjectCount();
+        if (flat) {
+            map = [[STAddressPairMap alloc] init];
+        } else {
+            map = [STHashKeyPairMap mapWithDefaultValue:STAnyAddress()];
+        }
+        for (id<NIOSocketAddress> remote in keys) {
+            [(id)map setObject:remote forRemote:remote local:local];
+        }
+        metrics[@"map_bytes_per_entry"] = @((double)(int64_t)(STBHeapBytes() - heap) / n);
+        metrics[@"map_objects_per_entry"] = @((double)(int64_t)(STBObjectCount() - objects) / n);
+    };
+    bench.operation = ^(NSUInteger i) {
+        [map objectForRemote:[remotes objectAtIndex:scatter(i, count)] local:local];
+    };
+    bench.teardown = ^{
+        map = nil;
+        remotes = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+static void register_hub(STBHarness *harness, BOOL wake) {
+    __block STBHub *hub;
+    __block NSMutableArray *channels;
+    __block NSArray<STConnection *> *connections;
+    __block NSUInteger count;
+    id<STConnectionDelegate> delegate = nil;
+    NSString *name = wake ? @"socket.hub.process.wake" : @"socket.hub.process.idle";
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.sizes = entity_sizes(100000);
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        hub = [[STBHub alloc] initWithConnectionDelegate:delegate];
+        channels = [[NSMutableArray alloc] initWithCapacity:n];
+        connections = open_connections(n, channels);
+        count = n;
+        for (STConnection *conn in connections) {
+            [conn start];
+            [hub setConnection:conn remoteAddress:conn.remoteAddress localAddress:conn.localAddress];
+        }
+        // default -> preparing -> ready
+        for (NSUInteger i = 0; i < 4; ++i) {
+            [hub process];
+        }
+    };
+    bench.operation = ^(NSUInteger i) {
+        if (wake) {
+            [hub connectionReady:[connections objectAtIndex:scatter(i, count)]];
+        }
+        [hub process];
+    };
+    bench.teardown = ^{
+        for (STConnection *conn in connections) {
+            [conn stop];
+        }
+        hub = nil;
+        connections = nil;
+        channels = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+static void register_gate(STBHarness *harness, BOOL wake) {
+    __block STBGate *gate;
+    __block NSMutableArray *channels;
+    __block NSArray<STConnection *> *connections;
+    __block NSArray<STBDocker *> *dockers;
+    __block NSUInteger count;
+    id<STDockerDelegate> delegate = nil;
+    NSString *name = wake ? @"gate.process.wake" : @"gate.process.idle";
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.sizes = entity_sizes(100000);
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        gate = [[STBGate alloc] initWithDockerDelegate:delegate];
+        channels = [[NSMutableArray alloc] initWithCapacity:n];
+        connections = open_connections(n, channels);
+        NSMutableArray *workers = [[NSMutableArray alloc] initWithCapacity:n];
+        STBDocker *worker;
+        for (STConnection *conn in connections) {
+            [conn start];
+            worker = [[STBDocker alloc] initWithConnection:conn];
+            [gate setDocker:worker remoteAddress:conn.remoteAddress localAddress:conn.localAddress];
+            [workers addObject:worker];
+        }
+        dockers = workers;
+        count = n;
+        // drive the new dockers once
+        [gate process];
+    };
+    bench.operation = ^(NSUInteger i) {
+        if (wake) {
+            [gate dockerReady:[dockers objectAtIndex:scatter(i, count)]];
+        }
+        [gate process];
+    };
+    bench.teardown = ^{
+        for (STConnection *conn in connections) {
+            [conn stop];
+        }
+        gate = nil;
+        dockers = nil;
+        connections = nil;
+        channels = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+// 1 MB of 64-byte lines, split into reads of 'size' bytes
+static inline NSArray<NSData *> *scan_reads(NSUInteger size, NSData *tail) {
+    NSMutableData *data = [[NSMutableData alloc] initWithCapacity:(BENCH_SCAN_LENGTH + [tail length])];
+    UInt8 line[BENCH_LINE_LENGTH];
+    for (NSUInteger i = 0; i < BENCH_SCAN_LENGTH / BENCH_LINE_LENGTH; ++i) {
+        for (NSUInteger j = 0; j < BENCH_LINE_LENGTH - 2; ++j) {
+            line[j] = 'a' + (i + j) % 26;
+        }
+        line[BENCH_LINE_LENGTH - 2] = '\r';
+        line[BENCH_LINE_LENGTH - 1] = '\n';
+        [data appendBytes:line length:BENCH_LINE_LENGTH];
+    }
+    [data appendData:tail];
+    NSMutableArray *reads = [[NSMutableArray alloc] init];
+    NSUInteger total = [data length];
+    for (NSUInteger pos = 0; pos < total; pos += size) {
+        [reads addObject:[data subdataWithRange:NSMakeRange(pos, MIN(size, total - pos))]];
+    }
+    return reads;
+}
+
+static void register_delimiter(STBHarness *harness, NSString *kind, NSData *delimiter) {
+    __block STDelimiterFrameDecoder *decoder;
+    __block NSArray<NSData *> *reads;
+    __block NSUInteger frames;
+    NSString *name = [NSString stringWithFormat:@"frame_decoder.delimiter.%@", kind];
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    // read sizes
+    bench.sizes = @[@1472, @16384, @(BENCH_SCAN_LENGTH)];
+    bench.sizeInBytes = YES;
+    bench.bytesPerOperation = BENCH_SCAN_LENGTH;
+    bench.operations = 200;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        decoder = [[STDelimiterFrameDecoder alloc] initWithDelimiter:delimiter maxFrameLength:0];
+        // CRLF lines, ends with the delimiter to flush the buffer each time
+        reads = scan_reads(n, delimiter);
+        frames = 0;
+        for (NSData *data in reads) {
+            frames += [[decoder decodeData:data] count];
+        }
+        metrics[@"frames_per_op"] = @(frames);
+    };
+    bench.operation = ^(NSUInteger i) {
+        for (NSData *data in reads) {
+            [decoder decodeData:data];
+        }
+    };
+    bench.teardown = ^{
+        decoder = nil;
+        reads = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+// remaining bytes from the offset, sharing memory with the original data
+static inline NSData *data_from_offset(NSData *data, NSUInteger offset) {
+    if (offset == 0) {
+        return data;
+    }
+    void *bytes = (UInt8 *)[data bytes] + offset;
+    NSUInteger len = [data length] - offset;
+    NSData *owner = data;
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:len deallocator:^(void *ptr, NSUInteger size) {
+        (void)owner;  // keep the original data alive
+    }];
+}
+
+static inline void drain_socket(int fd, UInt8 *buffer, size_t size) {
+    while (read(fd, buffer, size) > 0) {
+        // dropped
+    }
+}
+
+static void register_partial_send(STBHarness *harness, BOOL view) {
+    __block int fds[2] = {-1, -1};
+    __block NSData *fragment;
+    __block NSUInteger partials;
+    __block UInt8 *sink;
+    NSString *name = view ? @"docker.partial_send.view" : @"docker.partial_send.copy";
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.sizes = @[@1472, @16384, @65536, @262144];
+    bench.sizeInBytes = YES;
+    bench.operations = 10000;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        int ok = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        NSCAssert(ok == 0, @"socketpair error: %d", errno);
+        int size = BENCH_TINY_SNDBUF;
+        setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+        setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+        fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+        fragment = [[NSMutableData alloc] initWithLength:n];
+        sink = malloc(65536);
+        partials = 0;
+    };
+    // send one fragment, resuming from the sent offset on each partial write
+    bench.operation = ^(NSUInteger i) {
+        NSUInteger total = [fragment length];
+        NSUInteger offset = 0;
+        NSData *rest;
+        ssize_t sent;
+        while (offset < total) {
+            if (view) {
+                rest = data_from_offset(fragment, offset);
+            } else {
+                rest = [fragment subdataWithRange:NSMakeRange(offset, total - offset)];
+            }
+            sent = write(fds[0], [rest bytes], [rest length]);
+            if (sent > 0) {
+                offset += sent;
+                if (offset < total) {
+                    ++partials;
+                }
+            } else {
+                // socket buffer full, let the peer read
+                drain_socket(fds[1], sink, 65536);
+            }
+        }
+        drain_socket(fds[1], sink, 65536);
+    };
+    bench.teardown = ^{
+        close(fds[0]);
+        close(fds[1]);
+        free(sink);
+        fragment = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+#pragma mark - State Machine
+
+// builds its own states, as every machine did before sharing
+@interface STBOwnedStateMachine : STConnectionStateMachine
+
+@end
+
+@implementation STBOwnedStateMachine
+
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wdeprecated-implementations"
+// Override
+- (STConnectionStateBuilder *)createStateBuilder {
+    STConnectionStateTransitionBuilder *stb;
+    stb = [[STConnectionStateTransitionBuilder alloc] init];
+    return [[STConnectionStateBuilder alloc] initWithTransitionBuilder:stb];
+}
+#pragma clang diagnostic pop
+
+@end
+
+static void register_state_machine(STBHarness *harness, BOOL shared) {
+    __block NSMutableArray *machines;
+    __block STConnection *conn;
+    Class clazz = shared ? [STConnectionStateMachine class] : [STBOwnedStateMachine class];
+    NSString *name = shared ? @"net.state_machine.shared" : @"net.state_machine.owned";
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.sizes = entity_sizes(100000);
+    bench.operations = 10000;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+        conn = [[STConnection alloc] initWithChannel:nil remoteAddress:bench_address(0) localAddress:local];
+        machines = [[NSMutableArray alloc] initWithCapacity:n];
+        // footprint of the machines only
+        uint64_t heap = STBHeapBytes();
+        uint64_t objects = STBObjectCount();
+        for (NSUInteger i = 0; i < n; ++i) {
+            [machines addObject:[[clazz alloc] initWithConnection:conn]];
+        }
+        metrics[@"machine_bytes_per_entry"] = @((double)(int64_t)(STBHeapBytes() - heap) / n);
+        metrics[@"machine_objects_per_entry"] = @((double)(int64_t)(STBObjectCount() - objects) / n);
+    };
+    // create one more machine, for objects per connection
+    bench.operation = ^(NSUInteger i) {
+        (void)[[clazz alloc] initWithConnection:conn];
+    };
+    bench.teardown = ^{
+        machines = nil;
+        conn = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+#pragma mark - Loopback
+
+@interface STBEcho : NSObject <STConnectionDelegate>
+
+// send back received data
+@property(nonatomic, assign) BOOL echo;
+
+@end
+
+@implementation STBEcho
+
+- (void)connection:(id<STConnection>)connection
+      changedState:(nullable STConnectionState *)previous
+           toState:(nullable STConnectionState *)current {
+}
+
+- (void)connection:(id<STConnection>)connection receivedData:(NSData *)data {
+    if (_echo) {
+        [connection sendData:data];
+    }
+}
+
+- (void)connection:(id<STConnection>)connection sentData:(NSData *)data withLength:(NSInteger)sent {
+}
+
+- (void)connection:(id<STConnection>)connection failedToSendData:(NSData *)data error:(NIOError *)error {
+}
+
+- (void)connection:(id<STConnection>)connection error:(NIOError *)error {
+}
+
+@end
+
+static void register_loopback(STBHarness *harness) {
+    __block STBEcho *echo;
+    __block STBEcho *sink;
+    __block STLoopbackHub *server;
+    __block STLoopbackHub *client;
+    __block NSArray<id<STConnection>> *connections;
+    __block NSData *message;
+    __block NSUInteger count;
+    id<NIOSocketAddress> address = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:@"loopback.hub.roundtrip"];
+    bench.sizes = entity_sizes(100000);
+    bench.bytesPerOperation = 64 * 2;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        echo = [[STBEcho alloc] init];
+        echo.echo = YES;
+        sink = [[STBEcho alloc] init];
+        server = [[STLoopbackHub alloc] initWithConnectionDelegate:echo];
+        client = [[STLoopbackHub alloc] initWithConnectionDelegate:sink];
+        server.bufferSize = 4096;
+        client.bufferSize = 4096;
+        [server bindLocalAddress:address];
+        NSMutableArray *conns = [[NSMutableArray alloc] initWithCapacity:n];
+        id<STConnection> conn;
+        for (NSUInteger i = 0; i < n; ++i) {
+            conn = [client connectToRemoteAddress:address localAddress:nil];
+            if (conn) {
+                [conns addObject:conn];
+            }
+        }
+        connections = conns;
+        count = [conns count];
+        message = [[NSMutableData alloc] initWithLength:64];
+        // accept channels, default -> preparing -> ready
+        for (NSUInteger i = 0; i < 4; ++i) {
+            [server process];
+            [client process];
+        }
+        metrics[@"connections"] = @(count);
+    };
+    // client sends, server echoes, client receives
+    bench.operation = ^(NSUInteger i) {
+        [[connections objectAtIndex:scatter(i, count)] sendData:message];
+        [server process];
+        [client process];
+    };
+    bench.teardown = ^{
+        [server unbindLocalAddress:address];
+        for (id<STConnection> conn in connections) {
+            [conn close];
+        }
+        connections = nil;
+        server = nil;
+        client = nil;
+        echo = nil;
+        sink = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+#pragma mark - Impairment
+
+static const NSUInteger BENCH_PAGE_SIZE = 1024;
+
+/*  Bench Packet
+ *  ~~~~~~~~~~~~
+ *  type(1) + sn(4) + pages(2) + index(2) + payload
+ *      'D' - data fragment
+ *      'A' - response for a data fragment
+ *      'P' - ping, 'Q' - pong
+ */
+typedef struct {
+    UInt8 type;
+    UInt8 sn[4];
+    UInt8 pages[2];
+    UInt8 index[2];
+} STBPacketHead;
+
+static inline NSData *bench_packet(UInt8 type, UInt32 sn, UInt16 pages, UInt16 index,
+                                   NSUInteger bodyLength) {
+    NSMutableData *data = [[NSMutableData alloc] initWithLength:(sizeof(STBPacketHead) + bodyLength)];
+    STBPacketHead *head = (STBPacketHead *)[data mutableBytes];
+    head->type = type;
+    memcpy(head->sn, &sn, 4);
+    memcpy(head->pages, &pages, 2);
+    memcpy(head->index, &index, 2);
+    return data;
+}
+
+@interface STBShipArrival : STArrival
+
+@property(nonatomic, readonly) UInt8 type;
+@property(nonatomic, readonly) UInt16 pages;
+@property(nonatomic, readonly) UInt16 index;
+
+- (instancetype)initWithData:(NSData *)data time:(NSTimeInterval)now;
+
+@end
+
+@interface STBShipArrival () {
+
+    NSNumber *_sn;
+    NSMutableIndexSet *_received;
+}
+
+@end
+
+@implementation STBShipArrival
+
+- (instancetype)initWithData:(NSData *)data time:(NSTimeInterval)now {
+    if (self = [super initWithTime:now]) {
+        const STBPacketHead *head = (const STBPacketHead *)[data bytes];
+        UInt32 sn;
+        memcpy(&sn, head->sn, 4);
+        memcpy(&_pages, head->pages, 2);
+        memcpy(&_index, head->index, 2);
+        _type = head->type;
+        _sn = @(sn);
+        _received = nil;
+    }
+    return self;
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (nullable id<STArrival>)assembleArrivalShip:(id<STArrival>)income {
+    if (!_received) {
+        _received = [[NSMutableIndexSet alloc] init];
+    }
+    // duplicated fragments are counted once
+    [_received addIndex:[(STBShipArrival *)income index]];
+    return [_received count] >= _pages ? self : nil;
+}
+
+@end
+
+@interface STBShipDeparture : STDeparture {
+
+    NSNumber *_sn;
+    // index => fragment, waiting for responses
+    NSMutableDictionary<NSNumber *, NSData *> *_waiting;
+}
+
+- (instancetype)initWithSN:(UInt32)sn pages:(UInt16)count;
+
+@end
+
+@implementation STBShipDeparture
+
+- (instancetype)initWithSN:(UInt32)sn pages:(UInt16)count {
+    if (self = [super initWithPriority:STDeparturePriorityNormal maxTries:3]) {
+        _sn = @(sn);
+        _waiting = [[NSMutableDictionary alloc] initWithCapacity:count];
+        for (UInt16 i = 0; i < count; ++i) {
+            [_waiting setObject:bench_packet('D', sn, count, i, BENCH_PAGE_SIZE) forKey:@(i)];
+        }
+    }
+    return self;
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (NSArray<NSData *> *)fragments {
+    return [_waiting allValues];
+}
+
+// Override
+- (BOOL)checkResponseWithinArrivalShip:(id<STArrival>)response {
+    [_waiting removeObjectForKey:@([(STBShipArrival *)response index])];
+    return [_waiting count] == 0;
+}
+
+// Override
+- (BOOL)isImportant {
+    return YES;
+}
+
+@end
+
+@interface STBTransfer : NSObject <STDockerDelegate>
+
+@property(nonatomic, strong) STClock *clock;
+
+@property(nonatomic, readonly) NSUInteger inflight;
+@property(nonatomic, readonly) NSUInteger started;
+@property(nonatomic, readonly) NSUInteger acked;
+@property(nonatomic, readonly) NSUInteger failed;
+@property(nonatomic, readonly) NSUInteger delivered;
+@property(nonatomic, readonly) NSUInteger fragmentsSent;
+@property(nonatomic, readonly) NSTimeInterval lastDeliveryTime;
+
+// sorted delivery latencies (virtual seconds)
+@property(nonatomic, readonly) NSArray<NSNumber *> *latencies;
+
+- (void)startShip:(id<STDeparture>)ship;
+
+- (void)sentFragments:(NSUInteger)count;
+
+@end
+
+@interface STBTransfer () {
+
+    NSMutableDictionary<id<STShipID>, NSNumber *> *_sendTimes;
+    NSMutableSet<id<STShipID>> *_received;
+    NSMutableArray<NSNumber *> *_latencies;
+}
+
+@end
+
+@implementation STBTransfer
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _sendTimes = [[NSMutableDictionary alloc] init];
+        _received = [[NSMutableSet alloc] init];
+        _latencies = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (NSArray<NSNumber *> *)latencies {
+    @synchronized (self) {
+        return [_latencies sortedArrayUsingSelector:@selector(compare:)];
+    }
+}
+
+- (void)startShip:(id<STDeparture>)ship {
+    @synchronized (self) {
+        [_sendTimes setObject:@([_clock now]) forKey:[ship sn]];
+        ++_inflight;
+        ++_started;
+    }
+}
+
+- (void)sentFragments:(NSUInteger)count {
+    @synchronized (self) {
+        _fragmentsSent += count;
+    }
+}
+
+- (void)docker:(id<STDocker>)worker receivedShip:(id<STArrival>)arrival {
+    @synchronized (self) {
+        id<STShipID> sn = [arrival sn];
+        if ([_received containsObject:sn]) {
+            return;
+        }
+        [_received addObject:sn];
+        NSTimeInterval now = [_clock now];
+        [_latencies addObject:@(now - [[_sendTimes objectForKey:sn] doubleValue])];
+        _lastDeliveryTime = now;
+        ++_delivered;
+    }
+}
+
+- (void)docker:(id<STDocker>)worker sentShip:(id<STDeparture>)departure {
+    @synchronized (self) {
+        ++_acked;
+        --_inflight;
+    }
+}
+
+- (void)docker:(id<STDocker>)worker failedToSendShip:(id<STDeparture>)departure error:(NIOError *)error {
+    @synchronized (self) {
+        ++_failed;
+        --_inflight;
+    }
+}
+
+- (void)docker:(id<STDocker>)worker sendingShip:(id<STDeparture>)departure error:(NIOError *)error {
+}
+
+- (void)docker:(id<STDocker>)worker changedStatus:(STDockerStatus)previous toStatus:(STDockerStatus)current {
+}
+
+@end
+
+@interface STBShipDocker : STDocker
+
+@end
+
+@implementation STBShipDocker
+
+// Override
+- (void)heartbeat {
+    [[self connection] sendData:bench_packet('P', 0, 0, 0, 0)];
+}
+
+// Override
+- (BOOL)sendData:(NSData *)payload {
+    return NO;
+}
+
+// Override
+- (id<STArrival>)arrivalWithData:(NSData *)data {
+    if ([data length] < sizeof(STBPacketHead)) {
+        return nil;
+    }
+    return [[STBShipArrival alloc] initWithData:data time:[[self clock] now]];
+}
+
+// Override
+- (id<STArrival>)checkArrival:(id<STArrival>)income {
+    STBShipArrival *ship = (STBShipArrival *)income;
+    switch ([ship type]) {
+        case 'A':
+            [self checkResponseInArrival:ship];
+            return nil;
+        case 'D':
+            [[self connection] sendData:bench_packet('A', [(NSNumber *)[ship sn] unsignedIntValue],
+                                                     [ship pages], [ship index], 0)];
+            return [self assembleArrival:ship];
+        case 'P':
+            [[self connection] sendData:bench_packet('Q', 0, 0, 0, 0)];
+            return nil;
+        default:
+            return nil;
+    }
+}
+
+// Override
+- (id<STDeparture>)nextDepartureWithTime:(NSTimeInterval)now {
+    id<STDeparture> outgo = [super nextDepartureWithTime:now];
+    if (outgo && [outgo status:now] != STShipStatusFailed) {
+        // first try or retry
+        [(STBTransfer *)[self delegate] sentFragments:[[outgo fragments] count]];
+    }
+    return outgo;
+}
+
+@end
+
+// same docker sending with the default congestion window
+@interface STBPacedShipDocker : STBShipDocker
+
+@end
+
+@implementation STBPacedShipDocker
+
+// Override
+- (STPacer *)createPacer {
+    return [STPacer pacerWithRate:0 window:(ST_MSS * 10)];
+}
+
+@end
+
+@interface STBShipGate : STGate
+
+// create dockers with pacer
+@property(nonatomic, assign) BOOL paced;
+
+@end
+
+@implementation STBShipGate
+
+// Override
+- (id<STDocker>)createDockerWithConnection:(id<STConnection>)conn
+                              advanceParty:(NSArray<NSData *> *)data {
+    if (_paced) {
+        return [[STBPacedShipDocker alloc] initWithConnection:conn];
+    }
+    return [[STBShipDocker alloc] initWithConnection:conn];
+}
+
+@end
+
+static inline double latency_percentile(NSArray<NSNumber *> *sorted, double p) {
+    NSUInteger count = [sorted count];
+    if (count == 0) {
+        return 0;
+    }
+    NSUInteger index = MIN((NSUInteger)(p * count), count - 1);
+    return [[sorted objectAtIndex:index] doubleValue];
+}
+
+// ships of 8 x 1 KB fragments over impaired loopback, each operation is 1 ms of virtual time,
+// sent as fast as possible or paced by the congestion window
+static void register_impairment(STBHarness *harness, BOOL paced) {
+    static const NSUInteger total = 256;   // ships
+    static const NSUInteger window = 16;   // ships in flight
+    static const UInt16 pages = 8;
+    __block STVirtualClock *clock;
+    __block STBTransfer *transfer;
+    __block STBShipGate *serverGate;
+    __block STBShipGate *clientGate;
+    __block STLoopbackHub *server;
+    __block STLoopbackHub *client;
+    __block STBShipDocker *worker;
+    __block NSTimeInterval startTime;
+    __block NSUInteger lossPerMille;
+    __block NSMutableDictionary *results;
+    id<NIOSocketAddress> address = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    NSString *name = paced ? @"impair.loss.transfer.paced" : @"impair.loss.transfer";
+    STBBenchmark *bench = [STBBenchmark benchmarkWithName:name];
+    bench.sizes = @[@0, @10, @50, @100];  // loss rate in per mille
+    bench.operations = 400000;
+    bench.setup = ^(NSUInteger n, NSMutableDictionary *metrics) {
+        clock = [[STVirtualClock alloc] initWithTime:1000000];
+        startTime = [clock now];
+        lossPerMille = n;
+        results = metrics;
+        transfer = [[STBTransfer alloc] init];
+        transfer.clock = clock;
+        serverGate = [[STBShipGate alloc] initWithDockerDelegate:transfer];
+        clientGate = [[STBShipGate alloc] initWithDockerDelegate:transfer];
+        clientGate.paced = paced;
+        server = [[STLoopbackHub alloc] initWithConnectionDelegate:serverGate];
+        client = [[STLoopbackHub alloc] initWithConnectionDelegate:clientGate];
+        serverGate.clock = clock;
+        clientGate.clock = clock;
+        server.clock = clock;
+        client.clock = clock;
+        server.datagram = YES;
+        // each direction has its own link conditions
+        STImpairment *impairment = [STImpairment impairmentWithLoss:(n / 1000.0) delay:0.02 jitter:0.005];
+        impairment.seed = 20261018;
+        server.impairment = impairment;
+        client.impairment = impairment;
+        [server bindLocalAddress:address];
+        id<STConnection> conn = [client connectToRemoteAddress:address localAddress:nil];
+        NSCAssert(conn, @"failed to connect loopback hub");
+        worker = (STBShipDocker *)[clientGate createDockerWithConnection:conn advanceParty:@[]];
+        [clientGate setDocker:worker remoteAddress:[conn remoteAddress] localAddress:[conn localAddress]];
+    };
+    bench.operation = ^(NSUInteger i) {
+        // keep the window full
+        STBShipDeparture *ship;
+        while ([transfer inflight] < window && [transfer started] < total) {
+            ship = [[STBShipDeparture alloc] initWithSN:(UInt32)([transfer started] + 1) pages:pages];
+            [transfer startShip:ship];
+            [worker sendShip:ship];
+        }
+        // run until idle, then let the time go
+        BOOL busy;
+        for (NSUInteger k = 0; k < 16; ++k) {
+            busy = [clientGate process];
+            busy = [client process] || busy;
+            busy = [server process] || busy;
+            busy = [serverGate process] || busy;
+            if (!busy) {
+                break;
+            }
+        }
+        [clock advance:0.001];
+    };
+    bench.teardown = ^{
+        NSTimeInterval elapsed = [transfer lastDeliveryTime] - startTime;
+        NSUInteger original = [transfer started] * pages;
+        NSArray<NSNumber *> *latencies = [transfer latencies];
+        results[@"loss_rate"] = @(lossPerMille / 1000.0);
+        results[@"paced"] = @(paced);
+        results[@"ships_total"] = @(total);
+        results[@"ships_started"] = @([transfer started]);
+        results[@"ships_delivered"] = @([transfer delivered]);
+        results[@"ships_acked"] = @([transfer acked]);
+        results[@"ships_failed"] = @([transfer failed]);
+        results[@"goodput_bytes_per_sec"] = @(elapsed > 0 ? [transfer delivered] * pages * BENCH_PAGE_SIZE / elapsed : 0);
+        results[@"retransmit_ratio"] = @(original > 0 ? ((double)[transfer fragmentsSent] - original) / original : 0);
+        results[@"ship_latency_p50"] = @(latency_percentile(latencies, 0.50));
+        results[@"ship_latency_p99"] = @(latency_percentile(latencies, 0.99));
+        results[@"virtual_seconds"] = @([clock now] - startTime);
+        [server unbindLocalAddress:address];
+        [[worker connection] close];
+        worker = nil;
+        clientGate = nil;
+        serverGate = nil;
+        client = nil;
+        server = nil;
+        transfer = nil;
+        results = nil;
+        clock = nil;
+    };
+    [harness addBenchmark:bench];
+}
+
+void STBRegisterScenarios(STBHarness *harness) {
+    register_bytebuffer(harness);
+    register_departure_hall(harness);
+    register_arrival_hall(harness);
+    register_pair_map(harness, @"flat");
+    register_pair_map(harness, @"nested");
+    register_hub(harness, NO);
+    register_hub(harness, YES);
+    register_gate(harness, NO);
+    register_gate(harness, YES);
+    register_delimiter(harness, @"crlf", [NSData dataWithBytes:"\r\n" length:2]);
+    register_delimiter(harness, @"crlfcrlf", [NSData dataWithBytes:"\r\n\r\n" length:4]);
+    register_partial_send(harness, YES);
+    register_partial_send(harness, NO);
+    register_state_machine(harness, YES);
+    register_state_machine(harness, NO);
+    register_loopback(harness);
+    register_impairment(harness, NO);
+    register_impairment(harness, YES);
+}
@@ -0,0 +1,88 @@
+//
+//  main.m
+//  StarTrekBench
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <stdio.h>
+#import <stdlib.h>
+
+#import "STBHarness.h"
+#import "STBScenarios.h"
+
+static void usage(const char *cmd) {
+    fprintf(stderr, "Usage: %s [options]\n", cmd);
+    fprintf(stderr, "    --list              list scenarios and exit\n");
+    fprintf(stderr, "    --filter <text>     run scenarios whose name contains the text\n");
+    fprintf(stderr, "    --sizes <a,b,c>     entity counts (default: 1,10,...,1000000)\n");
+    fprintf(stderr, "    --max <n>           skip entity counts larger than n\n");
+    fprintf(stderr, "    --samples <n>       latency samples per run\n");
+    fprintf(stderr, "    --output <file>     write JSON report to file (default: stdout)\n");
+}
+
+static inline NSArray<NSNumber *> *parse_sizes(const char *arg) {
+    NSString *text = [NSString stringWithUTF8String:arg];
+    NSMutableArray *sizes = [[NSMutableArray alloc] init];
+    NSInteger n;
+    for (NSString *item in [text componentsSeparatedByString:@","]) {
+        n = [item integerValue];
+        if (n > 0) {
+            [sizes addObject:@(n)];
+        }
+    }
+    return sizes;
+}
+
+int main(int argc, const char *argv[]) {
+    @autoreleasepool {
+        STBHarness *harness = [[STBHarness alloc] init];
+        NSString *output = nil;
+        BOOL list = NO;
+        const char *opt;
+        for (int i = 1; i < argc; ++i) {
+            opt = argv[i];
+            if (strcmp(opt, "--list") == 0) {
+                list = YES;
+            } else if (strcmp(opt, "--help") == 0 || strcmp(opt, "-h") == 0) {
+                usage(argv[0]);
+                return 0;
+            } else if (i + 1 >= argc) {
+                usage(argv[0]);
+                return 1;
+            } else if (strcmp(opt, "--filter") == 0) {
+                harness.filter = [NSString stringWithUTF8String:argv[++i]];
+            } else if (strcmp(opt, "--sizes") == 0) {
+                harness.sizes = parse_sizes(argv[++i]);
+            } else if (strcmp(opt, "--max") == 0) {
+                harness.maxSize = (NSUInteger)strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(opt, "--samples") == 0) {
+                harness.maxSamples = (NSUInteger)strtoull(argv[++i], NULL, 10);
+            } else if (strcmp(opt, "--output") == 0) {
+                output = [NSString stringWithUTF8String:argv[++i]];
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        STBRegisterScenarios(harness);
+        if (list) {
+            for (STBBenchmark *bench in harness.benchmarks) {
+                printf("%s\n", [bench.name UTF8String]);
+            }
+            return 0;
+        }
+        NSArray *results = [harness run];
+        NSData *json = [harness JSONDataWithResults:results];
+        if ([output length] > 0) {
+            if (![json writeToFile:output atomically:YES]) {
+                fprintf(stderr, "failed to write report: %s\n", [output UTF8String]);
+                return 2;
+            }
+        } else {
+            fwrite([json bytes], 1, [json length], stdout);
+            fputc('\n', stdout);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+#
+#  stage.sh <stage> <Module>=<dir> ...
+#
+#  Flatten module sources for GNUstep make:
+#      headers => <stage>/include/<Module>/ (for '#import <Module/xxx.h>')
+#      sources => <stage>/src/
+#  prints paths of the staged sources.
+#
+set -e
+
+STAGE="$1"
+shift
+
+mkdir -p "$STAGE/src"
+for SPEC in "$@"; do
+    MODULE="${SPEC%%=*}"
+    DIR="${SPEC#*=}"
+    if [ ! -d "$DIR" ]; then
+        echo "stage.sh: module $MODULE not found in $DIR" >&2
+        exit 1
+    fi
+    DIR=$(cd "$DIR" && pwd)
+    mkdir -p "$STAGE/include/$MODULE"
+    find "$DIR" -name '*.h' | while read -r FILE; do
+        ln -sf "$FILE" "$STAGE/include/$MODULE/$(basename "$FILE")"
+    done
+    find "$DIR" -name '*.m' | while read -r FILE; do
+        NAME="$(basename "$FILE")"
+        ln -sf "$FILE" "$STAGE/src/$NAME"
+        echo "$STAGE/src/$NAME"
+    done
+done
@@ -0,0 +1,115 @@
+//
+//  NIOSocketAddressTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline socklen_t test_sockaddr6(struct sockaddr_in6 *sin6, const char *ip, UInt16 port, UInt32 scope) {
+    memset(sin6, 0, sizeof(struct sockaddr_in6));
+    sin6->sin6_family = AF_INET6;
+    sin6->sin6_port = htons(port);
+    sin6->sin6_scope_id = scope;
+    inet_pton(AF_INET6, ip, &sin6->sin6_addr);
+    return sizeof(struct sockaddr_in6);
+}
+
+@interface NIOSocketAddressTests : XCTestCase
+
+@end
+
+@implementation NIOSocketAddressTests
+
+- (void)testInterned {
+    NIOBinarySocketAddress *a1 = [NIOBinarySocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    NIOBinarySocketAddress *a2 = [NIOBinarySocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    NIOBinarySocketAddress *b = [NIOBinarySocketAddress addressWithHost:@"127.0.0.1" port:9395];
+    XCTAssertNotNil(a1);
+    XCTAssertEqual(a1, a2);
+    XCTAssertNotEqual(a1, b);
+    XCTAssertNotEqualObjects(a1, b);
+    // same endpoint from sockaddr
+    struct sockaddr_in sin;
+    memset(&sin, 0, sizeof(sin));
+    sin.sin_family = AF_INET;
+    sin.sin_port = htons(9394);
+    inet_pton(AF_INET, "127.0.0.1", &sin.sin_addr);
+    NIOBinarySocketAddress *a3 = [NIOBinarySocketAddress addressWithSockAddr:(const struct sockaddr *)&sin
+                                                                      length:sizeof(sin)];
+    XCTAssertEqual(a1, a3);
+    // IPv6 in different text forms
+    NIOBinarySocketAddress *c1 = [NIOBinarySocketAddress addressWithHost:@"::1" port:9394];
+    NIOBinarySocketAddress *c2 = [NIOBinarySocketAddress addressWithHost:@"0:0::1" port:9394];
+    XCTAssertEqual(c1, c2);
+    XCTAssertEqualObjects([c1 host], @"::1");
+    // not numeric
+    XCTAssertNil([NIOBinarySocketAddress addressWithHost:@"localhost" port:9394]);
+}
+
+- (void)testMixedEquality {
+    NIOBinarySocketAddress *bin = [NIOBinarySocketAddress addressWithHost:@"::1" port:9394];
+    NIOInetSocketAddress *in1 = [NIOInetSocketAddress addressWithHost:@"::1" port:9394];
+    NIOInetSocketAddress *in2 = [NIOInetSocketAddress addressWithHost:@"0:0::1" port:9394];
+    NIOInetSocketAddress *in3 = [NIOInetSocketAddress addressWithHost:@"::1" port:9395];
+    // transitive, both ways
+    XCTAssertEqualObjects(bin, in1);
+    XCTAssertEqualObjects(in1, bin);
+    XCTAssertEqualObjects(bin, in2);
+    XCTAssertEqualObjects(in2, bin);
+    XCTAssertEqualObjects(in1, in2);
+    XCTAssertEqualObjects(in2, in1);
+    XCTAssertEqual([bin hash], [in1 hash]);
+    XCTAssertEqual([bin hash], [in2 hash]);
+    XCTAssertNotEqualObjects(in1, in3);
+    XCTAssertNotEqualObjects(bin, in3);
+    // one entry in a set
+    NSMutableSet *set = [[NSMutableSet alloc] init];
+    [set addObject:bin];
+    [set addObject:in1];
+    [set addObject:in2];
+    XCTAssertEqual([set count], 1);
+    // domain names still compare as text
+    NIOInetSocketAddress *d1 = [NIOInetSocketAddress addressWithHost:@"localhost" port:9394];
+    NIOInetSocketAddress *d2 = [NIOInetSocketAddress addressWithHost:@"localhost" port:9394];
+    XCTAssertEqualObjects(d1, d2);
+    XCTAssertEqual([d1 hash], [d2 hash]);
+    XCTAssertNotEqualObjects(d1, bin);
+}
+
+- (void)testScope {
+    struct sockaddr_in6 sin6;
+    socklen_t len;
+    len = test_sockaddr6(&sin6, "fe80::1", 9394, 0);
+    NIOBinarySocketAddress *s0 = [NIOBinarySocketAddress addressWithSockAddr:(const struct sockaddr *)&sin6
+                                                                      length:len];
+    len = test_sockaddr6(&sin6, "fe80::1", 9394, 2);
+    NIOBinarySocketAddress *s2 = [NIOBinarySocketAddress addressWithSockAddr:(const struct sockaddr *)&sin6
+                                                                      length:len];
+    len = test_sockaddr6(&sin6, "fe80::1", 9394, 3);
+    NIOBinarySocketAddress *s3 = [NIOBinarySocketAddress addressWithSockAddr:(const struct sockaddr *)&sin6
+                                                                      length:len];
+    // scoped endpoints are interned apart
+    XCTAssertNotEqual(s2, s3);
+    XCTAssertNotEqualObjects(s2, s3);
+    XCTAssertNotEqualObjects(s0, s2);
+    len = test_sockaddr6(&sin6, "fe80::1", 9394, 2);
+    XCTAssertEqual(s2, [NIOBinarySocketAddress addressWithSockAddr:(const struct sockaddr *)&sin6
+                                                            length:len]);
+    XCTAssertEqual(((const struct sockaddr_in6 *)[s2 sockaddr])->sin6_scope_id, 2);
+    // a host string has no scope
+    NIOInetSocketAddress *inet = [NIOInetSocketAddress addressWithHost:@"fe80::1" port:9394];
+    XCTAssertEqualObjects(s0, inet);
+    XCTAssertEqualObjects(inet, s0);
+    XCTAssertNotEqualObjects(s2, inet);
+    XCTAssertNotEqualObjects(inet, s2);
+    XCTAssertNotEqualObjects(s3, inet);
+}
+
+@end
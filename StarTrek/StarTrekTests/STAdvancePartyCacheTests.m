@@ -0,0 +1,114 @@
+//
+//  STAdvancePartyCacheTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline STConnection *connection(UInt16 port) {
+    id<NIOSocketAddress> remote = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:port];
+    id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"0.0.0.0" port:9394];
+    return [[STConnection alloc] initWithChannel:nil remoteAddress:remote localAddress:local];
+}
+
+static inline NSData *packet(NSUInteger length, UInt8 value) {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    memset([data mutableBytes], value, length);
+    return data;
+}
+
+@interface STAdvancePartyCacheTests : XCTestCase
+
+@end
+
+@implementation STAdvancePartyCacheTests
+
+- (void)testMaxPackets {
+    STAdvancePartyCache *cache = [[STAdvancePartyCache alloc] initWithMaxPackets:3
+                                                                        maxBytes:1000
+                                                                      maxParties:10
+                                                                         expires:60];
+    STConnection *conn = connection(1001);
+    NSArray<NSData *> *packages;
+    for (UInt8 index = 1; index <= 4; ++index) {
+        packages = [cache cacheData:packet(10, index) forConnection:conn time:1];
+    }
+    NSArray *expected = @[packet(10, 2), packet(10, 3), packet(10, 4)];
+    XCTAssertEqualObjects(packages, expected);
+    XCTAssertEqual([cache count], 1);
+    XCTAssertEqual([cache length], 30);
+    // same addresses, another connection object
+    packages = [cache cacheData:packet(10, 5) forConnection:connection(1001) time:2];
+    XCTAssertEqual([packages count], 3);
+    XCTAssertEqual([cache count], 1);
+    
+    [cache clearForConnection:conn];
+    XCTAssertEqual([cache count], 0);
+    XCTAssertEqual([cache length], 0);
+}
+
+- (void)testMaxBytes {
+    STAdvancePartyCache *cache = [[STAdvancePartyCache alloc] initWithMaxPackets:8
+                                                                        maxBytes:100
+                                                                      maxParties:10
+                                                                         expires:60];
+    STConnection *conn1 = connection(1001);
+    STConnection *conn2 = connection(1002);
+    [cache cacheData:packet(60, 1) forConnection:conn1 time:1];
+    // the oldest party is evicted
+    [cache cacheData:packet(60, 2) forConnection:conn2 time:2];
+    XCTAssertEqual([cache count], 1);
+    XCTAssertEqual([cache length], 60);
+    // then the oldest packages of this party
+    NSArray<NSData *> *packages = [cache cacheData:packet(50, 3) forConnection:conn2 time:3];
+    XCTAssertEqualObjects(packages, @[packet(50, 3)]);
+    XCTAssertEqual([cache length], 50);
+    // too big, not cached
+    packages = [cache cacheData:packet(101, 4) forConnection:conn1 time:4];
+    XCTAssertEqualObjects(packages, @[packet(101, 4)]);
+    XCTAssertEqual([cache count], 1);
+    XCTAssertEqual([cache length], 50);
+}
+
+- (void)testMaxParties {
+    STAdvancePartyCache *cache = [[STAdvancePartyCache alloc] initWithMaxPackets:8
+                                                                        maxBytes:100000
+                                                                      maxParties:100
+                                                                         expires:60];
+    STConnection *first = connection(1000);
+    [cache cacheData:packet(1, 0) forConnection:first time:1];
+    for (UInt16 port = 1001; port < 1200; ++port) {
+        [cache cacheData:packet(1, 0) forConnection:connection(port) time:1];
+        XCTAssertLessThanOrEqual([cache count], 100);
+    }
+    XCTAssertEqual([cache count], 100);
+    XCTAssertEqual([cache length], 100);
+    // the first one was evicted
+    NSArray<NSData *> *packages = [cache cacheData:packet(1, 1) forConnection:first time:2];
+    XCTAssertEqual([packages count], 1);
+}
+
+- (void)testExpires {
+    STAdvancePartyCache *cache = [[STAdvancePartyCache alloc] initWithMaxPackets:8
+                                                                        maxBytes:1000
+                                                                      maxParties:10
+                                                                         expires:10];
+    STConnection *conn1 = connection(1001);
+    STConnection *conn2 = connection(1002);
+    [cache cacheData:packet(10, 1) forConnection:conn1 time:100];
+    [cache cacheData:packet(10, 2) forConnection:conn2 time:105];
+    XCTAssertEqual([cache purgeWithTime:109], 0);
+    XCTAssertEqual([cache purgeWithTime:110], 1);
+    XCTAssertEqual([cache count], 1);
+    // expired parties are evicted before caching
+    NSArray<NSData *> *packages = [cache cacheData:packet(10, 3) forConnection:conn2 time:115];
+    XCTAssertEqualObjects(packages, @[packet(10, 3)]);
+    XCTAssertEqual([cache count], 1);
+    XCTAssertEqual([cache length], 10);
+}
+
+@end
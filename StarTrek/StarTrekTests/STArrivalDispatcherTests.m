@@ -0,0 +1,96 @@
+//
+//  STArrivalDispatcherTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+@interface STArrivalDispatcherTests : XCTestCase
+
+@end
+
+@implementation STArrivalDispatcherTests
+
+- (void)testOrderPerDispatcher {
+    STArrivalDispatcher *dispatcher1 = [[STArrivalDispatcher alloc] initWithCapacity:0];
+    STArrivalDispatcher *dispatcher2 = [[STArrivalDispatcher alloc] initWithCapacity:0];
+    NSMutableArray<NSString *> *received1 = [[NSMutableArray alloc] init];
+    NSMutableArray<NSString *> *received2 = [[NSMutableArray alloc] init];
+    NSMutableArray<NSString *> *expected = [[NSMutableArray alloc] init];
+    XCTestExpectation *done1 = [self expectationWithDescription:@"dispatcher 1"];
+    XCTestExpectation *done2 = [self expectationWithDescription:@"dispatcher 2"];
+    NSUInteger count = 100;
+    NSString *sn;
+    for (NSUInteger index = 0; index < count; ++index) {
+        sn = [NSString stringWithFormat:@"%lu", index];
+        [expected addObject:sn];
+        XCTAssertTrue([dispatcher1 dispatchArrival:[[STTestArrival alloc] initWithSN:sn page:0]
+                                           handler:^(id<STArrival> ship) {
+            // not locked, the handlers of one dispatcher never run at the same time
+            [received1 addObject:(NSString *)[ship sn]];
+            if ([received1 count] == count) {
+                [done1 fulfill];
+            }
+        }]);
+        XCTAssertTrue([dispatcher2 dispatchArrival:[[STTestArrival alloc] initWithSN:sn page:0]
+                                           handler:^(id<STArrival> ship) {
+            [received2 addObject:(NSString *)[ship sn]];
+            if ([received2 count] == count) {
+                [done2 fulfill];
+            }
+        }]);
+    }
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    XCTAssertEqualObjects(received1, expected);
+    XCTAssertEqualObjects(received2, expected);
+    XCTAssertEqual([dispatcher1 delivered], count);
+    XCTAssertEqual([dispatcher1 dropped], 0);
+    XCTAssertEqual([dispatcher1 depth], 0);
+}
+
+- (void)testFull {
+    STArrivalDispatcher *dispatcher = [[STArrivalDispatcher alloc] initWithCapacity:2];
+    dispatch_semaphore_t started = dispatch_semaphore_create(0);
+    dispatch_semaphore_t blocker = dispatch_semaphore_create(0);
+    NSMutableArray<NSString *> *received = [[NSMutableArray alloc] init];
+    XCTestExpectation *done = [self expectationWithDescription:@"delivered"];
+    void (^handler)(id<STArrival>) = ^(id<STArrival> ship) {
+        NSString *sn = (NSString *)[ship sn];
+        [received addObject:sn];
+        if ([sn isEqualToString:@"1"]) {
+            // slow handler
+            dispatch_semaphore_signal(started);
+            dispatch_semaphore_wait(blocker, DISPATCH_TIME_FOREVER);
+        } else if ([sn isEqualToString:@"3"]) {
+            [done fulfill];
+        }
+    };
+    XCTAssertTrue([dispatcher dispatchArrival:[[STTestArrival alloc] initWithSN:@"1" page:0] handler:handler]);
+    dispatch_semaphore_wait(started, DISPATCH_TIME_FOREVER);
+    // the first one is being handled, not waiting
+    XCTAssertFalse([dispatcher isFull]);
+    XCTAssertTrue([dispatcher dispatchArrival:[[STTestArrival alloc] initWithSN:@"2" page:0] handler:handler]);
+    XCTAssertTrue([dispatcher dispatchArrival:[[STTestArrival alloc] initWithSN:@"3" page:0] handler:handler]);
+    XCTAssertTrue([dispatcher isFull]);
+    XCTAssertEqual([dispatcher depth], 2);
+    XCTAssertFalse([dispatcher dispatchArrival:[[STTestArrival alloc] initWithSN:@"4" page:0] handler:handler]);
+    XCTAssertEqual([dispatcher dropped], 1);
+    
+    dispatch_semaphore_signal(blocker);
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    NSArray *expected = @[@"1", @"2", @"3"];
+    XCTAssertEqualObjects(received, expected);
+    XCTAssertFalse([dispatcher isFull]);
+    XCTAssertEqual([dispatcher delivered], 3);
+    XCTAssertEqual([dispatcher peakDepth], 2);
+    
+    [dispatcher resetStatistics];
+    XCTAssertEqual([dispatcher delivered], 0);
+    XCTAssertEqual([dispatcher dropped], 0);
+}
+
+@end
@@ -0,0 +1,66 @@
+//
+//  STClockTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+@interface STClockTests : XCTestCase
+
+@end
+
+@implementation STClockTests
+
+- (void)testCoarseClock {
+    STCoarseClock *clock = [[STCoarseClock alloc] init];
+    // shifted to the system time
+    NSTimeInterval system = [[NSDate date] timeIntervalSince1970];
+    XCTAssertEqualWithAccuracy([clock now], system, 1.0);
+    // cached until next tick
+    NSTimeInterval now = [clock now];
+    XCTAssertEqual([clock now], now);
+    NSTimeInterval last = now;
+    for (NSUInteger i = 0; i < 1000; ++i) {
+        NSTimeInterval time = [clock tick];
+        XCTAssertGreaterThanOrEqual(time, last);
+        XCTAssertEqual([clock now], time);
+        last = time;
+    }
+}
+
+- (void)testCoarseClockThreads {
+    STCoarseClock *clock = [[STCoarseClock alloc] init];
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    __block BOOL back = NO;
+    dispatch_apply(4, queue, ^(size_t index) {
+        NSTimeInterval last = 0;
+        for (NSUInteger i = 0; i < 10000; ++i) {
+            // one thread ticks, the others read
+            NSTimeInterval time = index == 0 ? [clock tick] : [clock now];
+            if (time < last) {
+                back = YES;
+            }
+            last = time;
+        }
+    });
+    XCTAssertFalse(back);
+}
+
+- (void)testVirtualClock {
+    STVirtualClock *clock = [[STVirtualClock alloc] initWithTime:100];
+    XCTAssertEqual([clock now], 100);
+    XCTAssertEqual([clock tick], 100);
+    [clock advance:2.5];
+    XCTAssertEqual([clock now], 102.5);
+    XCTAssertEqual([clock tick], 102.5);
+    [clock setTime:50];
+    XCTAssertEqual([clock now], 50);
+    STVirtualClock *zero = [[STVirtualClock alloc] init];
+    XCTAssertEqual([zero now], 0);
+}
+
+@end
@@ -0,0 +1,156 @@
+//
+//  STCoalescerTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline NSData *utf8(NSString *text) {
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@interface STCoalescerTests : XCTestCase
+
+@end
+
+@implementation STCoalescerTests
+
+- (void)testPackAndSplit {
+    STCoalescer *sender = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    STCoalescer *receiver = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    XCTAssertTrue([sender canAppendLength:5]);
+    [sender appendData:utf8(@"hello") priority:0 time:1.0];
+    XCTAssertTrue([sender canAppendLength:5]);
+    [sender appendData:utf8(@"world") priority:0 time:1.0];
+    [sender appendData:[NSData data] priority:0 time:1.0];
+    XCTAssertEqual([sender length], 2 + 5 + 2 + 5 + 2);
+    NSData *packet = [sender packet];
+    XCTAssertEqual([packet length], 16);
+    [sender sentLength:[packet length]];
+    XCTAssertEqual([sender length], 0);
+    XCTAssertNil([sender packet]);
+    
+    NSArray<NSData *> *payloads = [receiver splitData:packet];
+    XCTAssertEqual([payloads count], 3);
+    XCTAssertEqualObjects(payloads[0], utf8(@"hello"));
+    XCTAssertEqualObjects(payloads[1], utf8(@"world"));
+    XCTAssertEqual([payloads[2] length], 0);
+}
+
+- (void)testJoinAcrossReads {
+    STCoalescer *sender = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    STCoalescer *receiver = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    [sender appendData:utf8(@"hello") priority:0 time:1.0];
+    [sender appendData:utf8(@"world") priority:0 time:1.0];
+    NSData *packet = [sender packet];
+    // deliver the stream byte by byte
+    NSMutableArray<NSData *> *payloads = [[NSMutableArray alloc] init];
+    const UInt8 *bytes = [packet bytes];
+    for (NSUInteger index = 0; index < [packet length]; ++index) {
+        [payloads addObjectsFromArray:[receiver splitData:[NSData dataWithBytes:(bytes + index) length:1]]];
+        if (index < 6) {
+            XCTAssertEqual([payloads count], 0);
+        }
+    }
+    NSArray *expected = @[utf8(@"hello"), utf8(@"world")];
+    XCTAssertEqualObjects(payloads, expected);
+    XCTAssertEqual([receiver droppedLength], 0);
+}
+
+- (void)testLargePayload {
+    STCoalescer *sender = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    STCoalescer *receiver = [[STCoalescer alloc] init];
+    NSMutableData *big = [NSMutableData dataWithLength:70000];
+    ((UInt8 *)[big mutableBytes])[69999] = 0x7F;
+    // a large fragment can go alone
+    XCTAssertTrue([sender canAppendLength:[big length]]);
+    [sender appendData:big priority:0 time:1.0];
+    XCTAssertFalse([sender canAppendLength:1]);
+    XCTAssertTrue([sender isReadyWithTime:1.0]);
+    NSData *packet = [sender packet];
+    XCTAssertEqual([packet length], 6 + 70000);
+    // split into two reads
+    NSData *part1 = [packet subdataWithRange:NSMakeRange(0, 4)];
+    NSData *part2 = [packet subdataWithRange:NSMakeRange(4, [packet length] - 4)];
+    XCTAssertEqual([[receiver splitData:part1] count], 0);
+    NSArray<NSData *> *payloads = [receiver splitData:part2];
+    XCTAssertEqual([payloads count], 1);
+    XCTAssertEqualObjects([payloads firstObject], big);
+}
+
+- (void)testFlushConditions {
+    STCoalescer *coalescer = [[STCoalescer alloc] initWithMaxLength:20 delay:0.5];
+    XCTAssertFalse([coalescer isReadyWithTime:1.0]);
+    XCTAssertEqual([coalescer flushTime], 0);
+    [coalescer appendData:[NSMutableData dataWithLength:8] priority:0 time:1.0];
+    XCTAssertEqualWithAccuracy([coalescer flushTime], 1.5, 0.0001);
+    // delay
+    XCTAssertFalse([coalescer isReadyWithTime:1.2]);
+    XCTAssertTrue([coalescer isReadyWithTime:1.5]);
+    // full
+    XCTAssertTrue([coalescer canAppendLength:8]);
+    [coalescer appendData:[NSMutableData dataWithLength:8] priority:0 time:1.2];
+    XCTAssertFalse([coalescer canAppendLength:1]);
+    XCTAssertTrue([coalescer isReadyWithTime:1.2]);
+    
+    // partially written
+    NSData *packet = [coalescer packet];
+    XCTAssertEqual([packet length], 20);
+    XCTAssertEqual([coalescer flushTime], 0);
+    [coalescer sentLength:15];
+    XCTAssertFalse([coalescer canAppendLength:1]);
+    XCTAssertTrue([coalescer isReadyWithTime:1.2]);
+    XCTAssertEqual([[coalescer packet] length], 5);
+    XCTAssertEqual([coalescer length], 5);
+    [coalescer sentLength:5];
+    XCTAssertFalse([coalescer isReadyWithTime:2.0]);
+    
+    // urgent
+    [coalescer appendData:utf8(@"ping") priority:STDeparturePriorityUrgent time:3.0];
+    XCTAssertTrue([coalescer isReadyWithTime:3.0]);
+    XCTAssertEqualWithAccuracy([coalescer flushTime], 3.0, 0.0001);
+}
+
+- (void)testMaxFrameLength {
+    STCoalescer *receiver = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    receiver.maxFrameLength = 10;
+    // a partial frame is kept, waiting for more data
+    const UInt8 partial[] = {0x00, 0x05, 'h', 'e'};
+    XCTAssertEqual([[receiver splitData:[NSData dataWithBytes:partial length:4]] count], 0);
+    // then a corrupted header after the frame
+    const UInt8 rest[] = {'l', 'l', 'o', 0x7F, 0xFF, 'x', 'y'};
+    NSArray<NSData *> *payloads = [receiver splitData:[NSData dataWithBytes:rest length:7]];
+    XCTAssertEqual([payloads count], 1);
+    XCTAssertEqualObjects([payloads firstObject], utf8(@"hello"));
+    XCTAssertEqual([receiver droppedLength], 4);
+    // the buffer was dropped, next frame starts clean
+    const UInt8 next[] = {0x00, 0x02, 'h', 'i'};
+    payloads = [receiver splitData:[NSData dataWithBytes:next length:4]];
+    XCTAssertEqual([payloads count], 1);
+    XCTAssertEqualObjects([payloads firstObject], utf8(@"hi"));
+}
+
+- (void)testDatagramBoundaries {
+    STCoalescer *receiver = [[STCoalescer alloc] initWithMaxLength:100 delay:0.01];
+    receiver.datagram = YES;
+    // truncated packet
+    const UInt8 packet1[] = {0x00, 0x02, 'h', 'i', 0x00, 0x05, 'w', 'o'};
+    NSArray<NSData *> *payloads = [receiver splitData:[NSData dataWithBytes:packet1 length:8]];
+    XCTAssertEqual([payloads count], 1);
+    XCTAssertEqualObjects([payloads firstObject], utf8(@"hi"));
+    XCTAssertEqual([receiver droppedLength], 4);
+    // the rest of payload in the next packet must not be joined
+    const UInt8 packet2[] = {'r', 'l', 'd'};
+    payloads = [receiver splitData:[NSData dataWithBytes:packet2 length:3]];
+    XCTAssertEqual([payloads count], 0);
+    XCTAssertEqual([receiver droppedLength], 7);
+    const UInt8 packet3[] = {0x00, 0x02, 'h', 'i'};
+    payloads = [receiver splitData:[NSData dataWithBytes:packet3 length:4]];
+    XCTAssertEqual([payloads count], 1);
+}
+
+@end
@@ -0,0 +1,104 @@
+//
+//  STDepartureHallTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+// arrival carrying no SN (e.g.: a broken package)
+@interface STTestAnonymousArrival : STArrival
+
+@end
+
+@implementation STTestAnonymousArrival
+
+// Override
+- (id<STShipID>)sn {
+    // SN not found
+    return nil;
+}
+
+@end
+
+@interface STDepartureHallTests : XCTestCase
+
+@property(nonatomic, strong) STDepartureHall *hall;
+
+@end
+
+@implementation STDepartureHallTests
+
+- (void)setUp {
+    self.hall = [[STDepartureHall alloc] init];
+}
+
+// private
+- (STTestDeparture *)launchSN:(NSString *)sn pages:(NSUInteger)count {
+    NSMutableArray<NSData *> *fragments = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [fragments addObject:[[NSString stringWithFormat:@"%@:%lu", sn, i]
+                              dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:sn
+                                                      fragments:fragments
+                                                       priority:STDeparturePriorityNormal
+                                                      important:YES];
+    XCTAssertTrue([_hall addDeparture:ship time:1]);
+    // sent, waiting for responses
+    XCTAssertEqual([_hall nextDepartureWithTime:1], ship);
+    return ship;
+}
+
+// private
+- (STTestArrival *)responseForSN:(NSString *)sn page:(NSInteger)page {
+    STTestArrival *ship = [[STTestArrival alloc] initWithSN:sn page:page];
+    ship.response = YES;
+    return ship;
+}
+
+- (void)testBatchedResponses {
+    STTestDeparture *a = [self launchSN:@"A" pages:2];
+    STTestDeparture *b = [self launchSN:@"B" pages:1];
+    STTestDeparture *c = [self launchSN:@"C" pages:1];
+    NSArray *responses = @[
+        [self responseForSN:@"A" page:0],
+        [self responseForSN:@"C" page:0],
+        [self responseForSN:@"A" page:1],
+    ];
+    NSArray<id<STDeparture>> *finished = [_hall checkResponsesInArrivals:responses time:2];
+    NSArray *expected = @[c, a];
+    XCTAssertEqualObjects(finished, expected);
+    // responded again, nothing more
+    finished = [_hall checkResponsesInArrivals:responses time:3];
+    XCTAssertEqual([finished count], 0);
+    finished = [_hall checkResponsesInArrivals:@[[self responseForSN:@"B" page:0]] time:3];
+    XCTAssertEqualObjects(finished, @[b]);
+}
+
+- (void)testCumulativeAcks {
+    STTestDeparture *a = [self launchSN:@"A" pages:3];
+    STTestDeparture *b = [self launchSN:@"B" pages:2];
+    [self launchSN:@"C" pages:1];
+    // one response acknowledges A & B
+    STTestArrival *ack = [self responseForSN:@"ACK" page:-1];
+    ack.respondedShipIDs = @[@"A", @"B", @"Z"];
+    NSArray<id<STDeparture>> *finished = [_hall checkResponsesInArrivals:@[ack] time:2];
+    NSArray *expected = @[a, b];
+    XCTAssertEqualObjects(finished, expected);
+    XCTAssertEqual([_hall.quota ships], 1);
+}
+
+- (void)testResponseWithoutSN {
+    STTestDeparture *a = [self launchSN:@"A" pages:1];
+    STTestAnonymousArrival *broken = [[STTestAnonymousArrival alloc] initWithTime:2];
+    NSArray *responses = @[broken, [self responseForSN:@"A" page:0]];
+    // skipped, not thrown
+    NSArray<id<STDeparture>> *finished = [_hall checkResponsesInArrivals:responses time:2];
+    XCTAssertEqualObjects(finished, @[a]);
+}
+
+@end
@@ -0,0 +1,206 @@
+//
+//  STDepartureQuotaTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+@interface STDepartureQuotaTests : XCTestCase <STDepartureQuotaDelegate, STDepartureHallDelegate>
+
+@property(nonatomic, strong) NSMutableArray<NSNumber *> *changes;  // writable flags
+@property(nonatomic, strong) NSMutableArray<id<STDeparture>> *dropped;
+
+@end
+
+@implementation STDepartureQuotaTests
+
+- (void)setUp {
+    self.changes = [[NSMutableArray alloc] init];
+    self.dropped = [[NSMutableArray alloc] init];
+}
+
+- (void)quota:(STDepartureQuota *)quota changedWritable:(BOOL)writable {
+    @synchronized (_changes) {
+        [_changes addObject:@(writable)];
+    }
+}
+
+- (void)departureHall:(STDepartureHall *)hall droppedDeparture:(id<STDeparture>)ship {
+    [_dropped addObject:ship];
+}
+
+- (void)departureHall:(STDepartureHall *)hall expiredDeparture:(id<STDeparture>)ship {
+}
+
+- (void)testLimits {
+    STDepartureQuota *quota = [[STDepartureQuota alloc] initWithMaxShips:2 maxBytes:1000];
+    XCTAssertTrue([quota canAcquireShips:1 bytes:5000]);  // empty hall
+    [quota acquireShips:1 bytes:600];
+    XCTAssertFalse([quota canAcquireShips:1 bytes:500]);
+    XCTAssertTrue([quota canAcquireShips:1 bytes:400]);
+    [quota acquireShips:1 bytes:400];
+    XCTAssertFalse([quota canAcquireShips:1 bytes:0]);
+    [quota releaseShips:2 bytes:1000];
+    XCTAssertEqual([quota ships], 0);
+    XCTAssertEqual([quota bytes], 0);
+}
+
+- (void)testWatermarks {
+    STDepartureQuota *quota = [[STDepartureQuota alloc] initWithMaxShips:10 maxBytes:0];
+    quota.highWatermark = 0.8;
+    quota.lowWatermark = 0.5;
+    quota.delegate = self;
+    
+    [quota acquireShips:7 bytes:0];
+    XCTAssertTrue([quota isWritable]);
+    [quota acquireShips:1 bytes:0];
+    XCTAssertFalse([quota isWritable]);
+    // still full between the watermarks
+    [quota releaseShips:2 bytes:0];
+    XCTAssertFalse([quota isWritable]);
+    [quota acquireShips:1 bytes:0];
+    [quota releaseShips:2 bytes:0];
+    XCTAssertEqual([quota ships], 5);
+    XCTAssertTrue([quota isWritable]);
+    
+    NSArray *expected = @[@NO, @YES];
+    XCTAssertEqualObjects(_changes, expected);
+}
+
+- (void)testParent {
+    STDepartureQuota *gate = [[STDepartureQuota alloc] initWithMaxShips:3 maxBytes:0];
+    STDepartureQuota *docker1 = [[STDepartureQuota alloc] initWithMaxShips:2 maxBytes:0];
+    STDepartureQuota *docker2 = [[STDepartureQuota alloc] initWithMaxShips:2 maxBytes:0];
+    [docker1 acquireShips:2 bytes:0];
+    // usages moved to the new parent
+    docker1.parent = gate;
+    docker2.parent = gate;
+    XCTAssertEqual([gate ships], 2);
+    [docker2 acquireShips:1 bytes:0];
+    XCTAssertEqual([gate ships], 3);
+    // docker 2 has room but the gate is full
+    XCTAssertFalse([docker2 canAcquireShips:1 bytes:0]);
+    [docker1 releaseShips:1 bytes:0];
+    XCTAssertTrue([docker2 canAcquireShips:1 bytes:0]);
+    docker1.parent = nil;
+    XCTAssertEqual([gate ships], 1);
+}
+
+- (void)testTryAcquire {
+    STDepartureQuota *gate = [[STDepartureQuota alloc] initWithMaxShips:3 maxBytes:0];
+    STDepartureQuota *docker = [[STDepartureQuota alloc] initWithMaxShips:2 maxBytes:1000];
+    docker.parent = gate;
+    XCTAssertTrue([docker tryAcquireShips:1 bytes:600]);
+    XCTAssertFalse([docker tryAcquireShips:1 bytes:500]);
+    XCTAssertEqual([docker ships], 1);
+    XCTAssertEqual([gate ships], 1);
+    [gate acquireShips:2 bytes:0];
+    // refused by the parent, nothing taken from the child
+    XCTAssertFalse([docker tryAcquireShips:1 bytes:100]);
+    XCTAssertEqual([docker ships], 1);
+    XCTAssertEqual([docker bytes], 600);
+    XCTAssertEqual([gate ships], 3);
+}
+
+- (void)testConcurrentAcquire {
+    STDepartureQuota *gate = [[STDepartureQuota alloc] initWithMaxShips:100 maxBytes:0];
+    gate.delegate = self;
+    NSMutableArray<STDepartureQuota *> *dockers = [[NSMutableArray alloc] init];
+    for (NSUInteger i = 0; i < 8; ++i) {
+        STDepartureQuota *docker = [[STDepartureQuota alloc] initWithMaxShips:50 maxBytes:0];
+        docker.parent = gate;
+        [dockers addObject:docker];
+    }
+    __block NSUInteger acquired = 0;
+    dispatch_apply(8, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t t) {
+        NSUInteger count = 0;
+        for (NSUInteger i = 0; i < 1000; ++i) {
+            if ([dockers[t] tryAcquireShips:1 bytes:0]) {
+                ++count;
+            }
+        }
+        @synchronized (dockers) {
+            acquired += count;
+        }
+    });
+    // never overshoot
+    XCTAssertEqual(acquired, 100);
+    XCTAssertEqual([gate ships], 100);
+    // the high watermark was reached by one of the threads, notified once
+    XCTAssertFalse([gate isWritable]);
+    NSArray *expected = @[@NO];
+    XCTAssertEqualObjects(_changes, expected);
+}
+
+- (void)testHeldUpdates {
+    STDepartureQuota *gate = [[STDepartureQuota alloc] initWithMaxShips:4 maxBytes:0];
+    STDepartureQuota *docker = [[STDepartureQuota alloc] initWithMaxShips:2 maxBytes:0];
+    docker.parent = gate;
+    gate.delegate = self;
+    [gate acquireShips:2 bytes:0];
+    [docker beginUpdates];
+    [docker acquireShips:2 bytes:0];
+    // the parent is held too
+    XCTAssertEqual([_changes count], 0);
+    XCTAssertTrue([gate isWritable]);
+    [docker releaseShips:1 bytes:0];
+    [docker acquireShips:1 bytes:0];
+    [docker endUpdates];
+    XCTAssertFalse([gate isWritable]);
+    NSArray *expected = @[@NO];
+    XCTAssertEqualObjects(_changes, expected);
+    // changed and changed back while held, nothing to notify
+    [gate beginUpdates];
+    [docker releaseShips:2 bytes:0];
+    [docker acquireShips:2 bytes:0];
+    [gate endUpdates];
+    XCTAssertEqualObjects(_changes, expected);
+}
+
+// private
+- (STDepartureHall *)hallWithMaxShips:(NSUInteger)count policy:(STQuotaPolicy)policy {
+    STDepartureHall *hall = [[STDepartureHall alloc] init];
+    hall.quota = [[STDepartureQuota alloc] initWithMaxShips:count maxBytes:0];
+    hall.policy = policy;
+    hall.delegate = self;
+    return hall;
+}
+
+- (void)testRejectPolicy {
+    STDepartureHall *hall = [self hallWithMaxShips:2 policy:STQuotaPolicyReject];
+    XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:@"1" size:10 priority:0] time:1]);
+    XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:@"2" size:10 priority:0] time:2]);
+    XCTAssertFalse([hall addDeparture:[STTestDeparture departureWithSN:@"3" size:10 priority:-1] time:3]);
+    XCTAssertEqual([_dropped count], 0);
+}
+
+- (void)testDropLowestPriority {
+    STDepartureHall *hall = [self hallWithMaxShips:2 policy:STQuotaPolicyDropLowestPriority];
+    STTestDeparture *normal = [STTestDeparture departureWithSN:@"1" size:10 priority:0];
+    STTestDeparture *slower = [STTestDeparture departureWithSN:@"2" size:10 priority:1];
+    XCTAssertTrue([hall addDeparture:normal time:1]);
+    XCTAssertTrue([hall addDeparture:slower time:2]);
+    // same priority as the lowest one, refused
+    XCTAssertFalse([hall addDeparture:[STTestDeparture departureWithSN:@"3" size:10 priority:1] time:3]);
+    XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:@"4" size:10 priority:0] time:4]);
+    XCTAssertEqual([_dropped count], 1);
+    XCTAssertEqual([_dropped firstObject], slower);
+    XCTAssertEqual([hall.quota ships], 2);
+}
+
+- (void)testDropOldest {
+    STDepartureHall *hall = [self hallWithMaxShips:2 policy:STQuotaPolicyDropOldest];
+    STTestDeparture *first = [STTestDeparture departureWithSN:@"1" size:10 priority:-1];
+    XCTAssertTrue([hall addDeparture:first time:1]);
+    XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:@"2" size:10 priority:0] time:2]);
+    XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:@"3" size:10 priority:1] time:3]);
+    XCTAssertEqual([_dropped count], 1);
+    XCTAssertEqual([_dropped firstObject], first);
+    XCTAssertEqual([hall.quota ships], 2);
+}
+
+@end
@@ -0,0 +1,224 @@
+//
+//  STDepartureSchedulerTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+@interface STDepartureSchedulerTests : XCTestCase <STDepartureHallDelegate>
+
+@property(nonatomic, strong) NSMutableArray<id<STDeparture>> *expired;
+
+@end
+
+@implementation STDepartureSchedulerTests
+
+- (void)setUp {
+    self.expired = [[NSMutableArray alloc] init];
+}
+
+- (void)departureHall:(STDepartureHall *)hall droppedDeparture:(id<STDeparture>)ship {
+}
+
+- (void)departureHall:(STDepartureHall *)hall expiredDeparture:(id<STDeparture>)ship {
+    [_expired addObject:ship];
+}
+
+// private
+- (STTestDeparture *)enqueue:(id<STDepartureScheduler>)scheduler
+                          sn:(NSString *)sn
+                        size:(NSUInteger)size
+                    priority:(NSInteger)prior
+                        time:(NSTimeInterval)now {
+    STTestDeparture *ship = [STTestDeparture departureWithSN:sn size:size priority:prior];
+    [scheduler enqueueDeparture:ship size:size time:now];
+    return ship;
+}
+
+// private
+- (STTestDeparture *)enqueue:(id<STDepartureScheduler>)scheduler
+                          sn:(NSString *)sn
+                    priority:(NSInteger)prior
+                    deadline:(NSTimeInterval)deadline {
+    STTestDeparture *ship = [STTestDeparture departureWithSN:sn size:10 priority:prior];
+    ship.deadline = deadline;
+    [scheduler enqueueDeparture:ship size:10 time:1];
+    return ship;
+}
+
+// private
+- (NSString *)drain:(id<STDepartureScheduler>)scheduler time:(NSTimeInterval)now {
+    NSMutableArray<NSString *> *order = [[NSMutableArray alloc] init];
+    id<STDeparture> ship;
+    while ((ship = [scheduler dequeueDepartureWithTime:now])) {
+        [order addObject:(NSString *)[ship sn]];
+    }
+    return [order componentsJoinedByString:@","];
+}
+
+- (void)testDequeueBeforePriority {
+    STDeficitRoundRobinScheduler *scheduler = [[STDeficitRoundRobinScheduler alloc] initWithQuantum:100];
+    [self enqueue:scheduler sn:@"S" size:10 priority:1 time:1];
+    [self enqueue:scheduler sn:@"N" size:10 priority:0 time:2];
+    [self enqueue:scheduler sn:@"U" size:10 priority:-1 time:3];
+    // nothing higher than the urgent class
+    XCTAssertNil([scheduler dequeueDepartureBeforePriority:-1 time:4]);
+    // the highest class goes first, out of the round robin turn
+    XCTAssertEqualObjects([[scheduler dequeueDepartureBeforePriority:1 time:4] sn], @"U");
+    XCTAssertEqualObjects([[scheduler dequeueDepartureBeforePriority:1 time:4] sn], @"N");
+    XCTAssertNil([scheduler dequeueDepartureBeforePriority:1 time:4]);
+    XCTAssertEqual([scheduler count], 1);
+    XCTAssertEqualObjects([self drain:scheduler time:5], @"S");
+}
+
+- (void)testStrictPriority {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    [self enqueue:scheduler sn:@"A" size:10 priority:1 time:1];
+    [self enqueue:scheduler sn:@"B" size:10 priority:0 time:2];
+    [self enqueue:scheduler sn:@"C" size:10 priority:1 time:3];
+    [self enqueue:scheduler sn:@"D" size:10 priority:-1 time:4];
+    [self enqueue:scheduler sn:@"E" size:10 priority:0 time:5];
+    XCTAssertEqual([scheduler count], 5);
+    XCTAssertEqualObjects([self drain:scheduler time:10], @"D,B,E,A,C");
+    XCTAssertEqual([scheduler count], 0);
+    XCTAssertNil([scheduler dequeueDepartureWithTime:10]);
+}
+
+- (void)testRemoveAndVictims {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    STTestDeparture *a = [self enqueue:scheduler sn:@"A" size:10 priority:0 time:1];
+    STTestDeparture *b = [self enqueue:scheduler sn:@"B" size:10 priority:1 time:2];
+    STTestDeparture *c = [self enqueue:scheduler sn:@"C" size:10 priority:1 time:3];
+    XCTAssertEqual([scheduler oldestDeparture], a);
+    XCTAssertEqual([scheduler lowestDeparture], c);
+    XCTAssertTrue([scheduler removeDeparture:a]);
+    XCTAssertFalse([scheduler removeDeparture:a]);
+    XCTAssertEqual([scheduler oldestDeparture], b);
+    XCTAssertEqualObjects([self drain:scheduler time:10], @"B,C");
+}
+
+- (void)testStatistics {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    [self enqueue:scheduler sn:@"A" size:100 priority:0 time:1];
+    [self enqueue:scheduler sn:@"B" size:200 priority:0 time:2];
+    [self enqueue:scheduler sn:@"C" size:300 priority:1 time:3];
+    [scheduler dequeueDepartureWithTime:5];
+    [scheduler dequeueDepartureWithTime:6];
+    NSArray<STDepartureStatistics *> *stats = [scheduler statistics];
+    XCTAssertEqual([stats count], 2);
+    STDepartureStatistics *normal = [stats firstObject];
+    XCTAssertEqual([normal priority], 0);
+    XCTAssertEqual([normal enqueued], 2);
+    XCTAssertEqual([normal dequeued], 2);
+    XCTAssertEqual([normal bytes], 300);
+    XCTAssertEqual([normal maxDepth], 2);
+    XCTAssertEqual([normal depth], 0);
+    XCTAssertEqualWithAccuracy([normal maxWait], 4, 0.001);
+    XCTAssertEqualWithAccuracy([normal averageWait], 4, 0.001);
+    STDepartureStatistics *slower = [stats lastObject];
+    XCTAssertEqual([slower depth], 1);
+    XCTAssertEqual([slower dequeued], 0);
+    
+    [scheduler resetStatistics];
+    normal = [[scheduler statistics] firstObject];
+    XCTAssertEqual([normal enqueued], 0);
+    XCTAssertEqual([normal dequeued], 0);
+    slower = [[scheduler statistics] lastObject];
+    XCTAssertEqual([slower depth], 1);
+}
+
+- (void)testDeficitRoundRobinShares {
+    // normal : slower = 2 : 1
+    STDeficitRoundRobinScheduler *scheduler = [[STDeficitRoundRobinScheduler alloc] initWithQuantum:100];
+    for (NSUInteger index = 0; index < 6; ++index) {
+        [self enqueue:scheduler sn:@"N" size:100 priority:STDeparturePriorityNormal time:1];
+        [self enqueue:scheduler sn:@"S" size:100 priority:STDeparturePrioritySlower time:1];
+    }
+    XCTAssertEqualObjects([self drain:scheduler time:10], @"N,N,S,N,N,S,N,N,S,S,S,S");
+}
+
+- (void)testDeficitRoundRobinNoStarvation {
+    STDeficitRoundRobinScheduler *scheduler = [[STDeficitRoundRobinScheduler alloc] initWithQuantum:100];
+    [scheduler setWeight:1 forPriority:STDeparturePriorityUrgent];
+    XCTAssertEqual([scheduler weightForPriority:STDeparturePriorityUrgent], 1);
+    XCTAssertEqual([scheduler weightForPriority:7], 1);  // default weight
+    // a big ship in the slower class collects credit round by round
+    [self enqueue:scheduler sn:@"B" size:250 priority:STDeparturePrioritySlower time:1];
+    for (NSUInteger index = 0; index < 5; ++index) {
+        [self enqueue:scheduler sn:@"U" size:100 priority:STDeparturePriorityUrgent time:1];
+    }
+    XCTAssertEqualObjects([self drain:scheduler time:10], @"U,U,U,B,U,U");
+}
+
+- (void)testDeficitRoundRobinIdleClassKeepsNoCredit {
+    STDeficitRoundRobinScheduler *scheduler = [[STDeficitRoundRobinScheduler alloc] initWithQuantum:100];
+    [self enqueue:scheduler sn:@"S" size:10 priority:STDeparturePrioritySlower time:1];
+    XCTAssertEqualObjects([self drain:scheduler time:2], @"S");
+    // the class emptied with 90 bytes credit left, it should not be kept
+    [self enqueue:scheduler sn:@"S" size:100 priority:STDeparturePrioritySlower time:3];
+    [self enqueue:scheduler sn:@"S" size:100 priority:STDeparturePrioritySlower time:3];
+    [self enqueue:scheduler sn:@"N" size:100 priority:STDeparturePriorityNormal time:3];
+    [self enqueue:scheduler sn:@"N" size:100 priority:STDeparturePriorityNormal time:3];
+    [self enqueue:scheduler sn:@"N" size:100 priority:STDeparturePriorityNormal time:3];
+    XCTAssertEqualObjects([self drain:scheduler time:4], @"S,N,N,S,N");
+}
+
+- (void)testEarliestDeadlineFirst {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    scheduler.earliestDeadlineFirst = YES;
+    [self enqueue:scheduler sn:@"A" priority:0 deadline:30];
+    [self enqueue:scheduler sn:@"B" priority:0 deadline:10];
+    [self enqueue:scheduler sn:@"C" priority:0 deadline:0];   // never expired
+    [self enqueue:scheduler sn:@"D" priority:0 deadline:20];
+    [self enqueue:scheduler sn:@"E" priority:0 deadline:10];  // same as B
+    [self enqueue:scheduler sn:@"F" priority:0 deadline:0];
+    XCTAssertEqualObjects([self drain:scheduler time:5], @"B,E,D,A,C,F");
+}
+
+- (void)testDeadlineWithinPriority {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    scheduler.earliestDeadlineFirst = YES;
+    [self enqueue:scheduler sn:@"A" priority:1 deadline:1];
+    [self enqueue:scheduler sn:@"B" priority:0 deadline:100];
+    [self enqueue:scheduler sn:@"C" priority:0 deadline:50];
+    XCTAssertEqualObjects([self drain:scheduler time:0.5], @"C,B,A");
+}
+
+- (void)testOldestWithDeadlines {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    scheduler.earliestDeadlineFirst = YES;
+    STTestDeparture *first = [self enqueue:scheduler sn:@"A" priority:0 deadline:30];
+    [self enqueue:scheduler sn:@"B" priority:0 deadline:10];
+    // not the head of its class
+    XCTAssertEqual([scheduler oldestDeparture], first);
+}
+
+- (void)testArrivalOrderWithoutEDF {
+    STPriorityScheduler *scheduler = [[STPriorityScheduler alloc] init];
+    [self enqueue:scheduler sn:@"A" priority:0 deadline:30];
+    [self enqueue:scheduler sn:@"B" priority:0 deadline:10];
+    XCTAssertEqualObjects([self drain:scheduler time:5], @"A,B");
+}
+
+- (void)testHallDropsExpired {
+    STDepartureHall *hall = [[STDepartureHall alloc] init];
+    hall.delegate = self;
+    STTestDeparture *late = [STTestDeparture departureWithSN:@"A" size:10 priority:0];
+    late.deadline = 10;
+    STTestDeparture *fine = [STTestDeparture departureWithSN:@"B" size:10 priority:0];
+    // useless already
+    XCTAssertFalse([hall addDeparture:late time:10]);
+    XCTAssertTrue([hall addDeparture:late time:5]);
+    XCTAssertTrue([hall addDeparture:fine time:6]);
+    XCTAssertEqual([hall.quota ships], 2);
+    XCTAssertEqual([hall nextDepartureWithTime:12], fine);
+    XCTAssertEqual([_expired count], 1);
+    XCTAssertEqual([_expired firstObject], late);
+    XCTAssertEqual([hall.quota ships], 1);
+}
+
+@end
@@ -0,0 +1,283 @@
+//
+//  STDockerTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestDocker.h"
+
+static inline NSArray<NSData *> *test_fragments(NSString *sn, NSUInteger count) {
+    NSMutableArray<NSData *> *array = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        NSString *text = [NSString stringWithFormat:@"%@:%lu", sn, i];
+        [array addObject:[text dataUsingEncoding:NSUTF8StringEncoding]];
+    }
+    return array;
+}
+
+static inline NSArray<NSString *> *test_writes(STTestConnection *conn) {
+    NSMutableArray<NSString *> *array = [[NSMutableArray alloc] init];
+    for (NSData *data in [conn writes]) {
+        [array addObject:[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding]];
+    }
+    return array;
+}
+
+// pool for arrivals, suspended to keep them waiting
+static dispatch_queue_t s_blocked_pool = nil;
+
+// docker holding one waiting arrival only
+@interface STBlockedDocker : STTestDocker
+
+@end
+
+@implementation STBlockedDocker
+
+// Override
+- (STArrivalDispatcher *)createDispatcher {
+    return [[STArrivalDispatcher alloc] initWithCapacity:1 queue:s_blocked_pool];
+}
+
+@end
+
+// departure returning its live fragments
+@interface STLiveDeparture : STTestDeparture
+
+@property(nonatomic, strong) NSMutableArray<NSData *> *liveFragments;
+
+@end
+
+@implementation STLiveDeparture
+
+// Override
+- (NSArray<NSData *> *)fragments {
+    return _liveFragments;
+}
+
+@end
+
+// docker packing fragments, and pacing important ones
+@interface STCoalescingDocker : STTestDocker
+
+@end
+
+@implementation STCoalescingDocker
+
+// Override
+- (STPacer *)createPacer {
+    return [STPacer pacerWithRate:0 window:(ST_MSS * 10)];
+}
+
+// Override
+- (STCoalescer *)createCoalescer {
+    return [[STCoalescer alloc] init];
+}
+
+@end
+
+// delegate counting sending errors
+@interface STTestDockerDelegate : NSObject <STDockerDelegate>
+
+@property(nonatomic, readonly) NSMutableArray<id<STDeparture>> *sendingErrors;
+
+@end
+
+@implementation STTestDockerDelegate
+
+- (instancetype)init {
+    if (self = [super init]) {
+        _sendingErrors = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+- (void)docker:(id<STDocker>)worker receivedShip:(id<STArrival>)arrival {
+}
+
+- (void)docker:(id<STDocker>)worker sentShip:(id<STDeparture>)departure {
+}
+
+- (void)docker:(id<STDocker>)worker failedToSendShip:(id<STDeparture>)departure error:(NIOError *)error {
+}
+
+- (void)docker:(id<STDocker>)worker sendingShip:(id<STDeparture>)departure error:(NIOError *)error {
+    [_sendingErrors addObject:departure];
+}
+
+- (void)docker:(id<STDocker>)worker changedStatus:(STDockerStatus)previous toStatus:(STDockerStatus)current {
+}
+
+@end
+
+@interface STDockerTests : XCTestCase
+
+@property(nonatomic, strong) STTestDocker *docker;
+
+@end
+
+@implementation STDockerTests
+
+- (void)setUp {
+    id<NIOSocketAddress> remote = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9527];
+    STTestConnection *conn = [[STTestConnection alloc] initWithRemoteAddress:remote];
+    self.docker = [[STTestDocker alloc] initWithTestConnection:conn];
+}
+
+// private
+- (void)sendSN:(NSString *)sn fragments:(NSUInteger)count priority:(NSInteger)prior {
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:sn
+                                                      fragments:test_fragments(sn, count)
+                                                       priority:prior
+                                                      important:NO];
+    XCTAssertTrue([_docker sendShip:ship]);
+}
+
+// private
+- (NSUInteger)processAll {
+    NSUInteger turns = 0;
+    while ([_docker process]) {
+        ++turns;
+    }
+    return turns;
+}
+
+- (void)testInterleaving {
+    [self sendSN:@"A" fragments:3 priority:STDeparturePriorityNormal];
+    [self sendSN:@"B" fragments:3 priority:STDeparturePriorityNormal];
+    [self processAll];
+    // the same priority takes turns
+    NSArray *expected = @[@"A:0", @"A:1", @"B:0", @"A:2", @"B:1", @"B:2"];
+    XCTAssertEqualObjects(test_writes(_docker.testConnection), expected);
+}
+
+- (void)testOneFlight {
+    _docker.maxFlights = 1;
+    [self sendSN:@"A" fragments:3 priority:STDeparturePriorityNormal];
+    [self sendSN:@"B" fragments:3 priority:STDeparturePriorityNormal];
+    [self processAll];
+    NSArray *expected = @[@"A:0", @"A:1", @"A:2", @"B:0", @"B:1", @"B:2"];
+    XCTAssertEqualObjects(test_writes(_docker.testConnection), expected);
+}
+
+- (void)testPreemption {
+    STTestConnection *conn = _docker.testConnection;
+    for (NSUInteger i = 1; i <= 4; ++i) {
+        [self sendSN:[NSString stringWithFormat:@"L%lu", i] fragments:5 priority:STDeparturePrioritySlower];
+    }
+    // fill all flights
+    for (NSUInteger i = 0; i < 4; ++i) {
+        XCTAssertTrue([_docker process]);
+    }
+    XCTAssertEqual([[conn writes] count], 4);
+    // the urgent one goes out on the next turn
+    [self sendSN:@"U" fragments:2 priority:STDeparturePriorityNormal];
+    XCTAssertTrue([_docker process]);
+    XCTAssertEqualObjects([test_writes(conn) lastObject], @"U:0");
+    XCTAssertTrue([_docker process]);
+    XCTAssertEqualObjects([test_writes(conn) lastObject], @"U:1");
+    // the parked one resumes, nothing lost or duplicated
+    [self processAll];
+    NSArray<NSString *> *writes = test_writes(conn);
+    XCTAssertEqual([writes count], 4 * 5 + 2);
+    XCTAssertEqual([[NSSet setWithArray:writes] count], [writes count]);
+}
+
+- (void)testPartialNotPreempted {
+    STTestConnection *conn = _docker.testConnection;
+    _docker.maxFlights = 1;
+    [self sendSN:@"LOW" fragments:2 priority:STDeparturePrioritySlower];
+    conn.maxWrite = 3;
+    XCTAssertFalse([_docker process]);  // "LOW:0" partially written
+    [self sendSN:@"U" fragments:1 priority:STDeparturePriorityUrgent];
+    conn.maxWrite = 0;
+    XCTAssertTrue([_docker process]);
+    // the rest of the fragment first, it must not be interleaved
+    NSArray *expected = @[@"LOW", @":0"];
+    XCTAssertEqualObjects(test_writes(conn), expected);
+    [self processAll];
+    expected = @[@"LOW", @":0", @"U:0", @"LOW:1"];
+    XCTAssertEqualObjects(test_writes(conn), expected);
+}
+
+- (void)testDispatcherFull {
+    s_blocked_pool = dispatch_queue_create("test.blocked", DISPATCH_QUEUE_SERIAL);
+    dispatch_suspend(s_blocked_pool);
+    STBlockedDocker *docker = [[STBlockedDocker alloc] initWithTestConnection:_docker.testConnection];
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:@"X"
+                                                      fragments:test_fragments(@"X", 1)
+                                                       priority:STDeparturePriorityNormal
+                                                      important:YES];
+    XCTAssertTrue([docker sendShip:ship]);
+    while ([docker process]) {}
+    // sent, waiting for response
+    XCTAssertEqual([[docker quota] ships], 1);
+    [docker processReceivedData:[STTestDocker packageWithType:'D' sn:@"1"]];
+    [docker processReceivedData:[STTestDocker packageWithType:'D' sn:@"2"]];
+    [docker processReceivedData:[STTestDocker packageWithType:'A' sn:@"X"]];
+    STArrivalDispatcher *dispatcher = [docker dispatcher];
+    XCTAssertEqual([dispatcher depth], 1);
+    XCTAssertEqual([dispatcher dropped], 1);
+    // response checked though the queue is full
+    XCTAssertEqual([[docker quota] ships], 0);
+    dispatch_resume(s_blocked_pool);
+}
+
+- (void)testCoalescerWriteError {
+    STTestConnection *conn = _docker.testConnection;
+    STCoalescingDocker *docker = [[STCoalescingDocker alloc] initWithTestConnection:conn];
+    STTestDockerDelegate *delegate = [[STTestDockerDelegate alloc] init];
+    docker.delegate = delegate;
+    conn.broken = YES;
+    // urgent, each packet is written immediately
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:@"X"
+                                                      fragments:test_fragments(@"X", 2)
+                                                       priority:STDeparturePriorityUrgent
+                                                      important:YES];
+    XCTAssertTrue([docker sendShip:ship]);
+    while ([docker process]) {}
+    // one error for each packet, then dropped
+    XCTAssertEqual([[delegate sendingErrors] count], 2);
+    XCTAssertEqual([[delegate sendingErrors] firstObject], ship);
+    XCTAssertEqual([[docker coalescer] length], 0);
+    // bytes charged when packing are given back
+    XCTAssertEqual([[[docker pacer] congestionWindow] inflight], 0);
+    XCTAssertEqual([[conn writes] count], 0);
+}
+
+- (void)testShortWrites {
+    STTestConnection *conn = _docker.testConnection;
+    conn.maxWrite = 2;
+    NSData *data = [@"ABCDEFG" dataUsingEncoding:NSUTF8StringEncoding];
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:@"X"
+                                                      fragments:@[data]
+                                                       priority:STDeparturePriorityNormal
+                                                      important:NO];
+    XCTAssertTrue([_docker sendShip:ship]);
+    // resumed from the cursor, a short write stops the turn
+    for (NSUInteger i = 0; i < 4; ++i) {
+        [_docker process];
+    }
+    NSArray *expected = @[@"AB", @"CD", @"EF", @"G"];
+    XCTAssertEqualObjects(test_writes(conn), expected);
+    XCTAssertEqual([self processAll], 0);
+}
+
+- (void)testFragmentsChanged {
+    STLiveDeparture *ship = [[STLiveDeparture alloc] initWithSN:@"X"
+                                                      fragments:@[]
+                                                       priority:STDeparturePriorityNormal
+                                                      important:NO];
+    ship.liveFragments = [test_fragments(@"X", 3) mutableCopy];
+    XCTAssertTrue([_docker sendShip:ship]);
+    XCTAssertTrue([_docker process]);
+    // the departure shrinks while being sent
+    [ship.liveFragments removeAllObjects];
+    [self processAll];
+    NSArray *expected = @[@"X:0", @"X:1", @"X:2"];
+    XCTAssertEqualObjects(test_writes(_docker.testConnection), expected);
+}
+
+@end
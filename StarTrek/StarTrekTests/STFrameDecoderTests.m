@@ -0,0 +1,239 @@
+//
+//  STFrameDecoderTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline NSData *utf8(NSString *text) {
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+@interface STFrameDecoderTests : XCTestCase
+
+@end
+
+@implementation STFrameDecoderTests
+
+// private
+- (NSArray<NSData *> *)decode:(id<STFrameDecoder>)decoder data:(NSData *)data chunk:(NSUInteger)size {
+    NSMutableArray<NSData *> *frames = [[NSMutableArray alloc] init];
+    NSUInteger total = [data length];
+    NSUInteger len;
+    for (NSUInteger pos = 0; pos < total; pos += len) {
+        len = MIN(size, total - pos);
+        [frames addObjectsFromArray:[decoder decodeData:[data subdataWithRange:NSMakeRange(pos, len)]]];
+    }
+    return frames;
+}
+
+#pragma mark Length Field
+
+- (void)testLengthFieldFrames {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:2
+                                                                                 maxFrameLength:0];
+    const UInt8 bytes[] = {0x00, 0x02, 'h', 'i', 0x00, 0x00, 0x00, 0x03, 'y', 'o', 'u', 0x00};
+    NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+    // all frames in one read
+    NSArray<NSData *> *frames = [decoder decodeData:data];
+    NSArray *expected = @[utf8(@"hi"), [NSData data], utf8(@"you")];
+    XCTAssertEqualObjects(frames, expected);
+    XCTAssertEqual([decoder bufferedLength], 1);
+    [decoder reset];
+    XCTAssertEqual([decoder bufferedLength], 0);
+    // split across reads
+    for (NSUInteger size = 1; size < sizeof(bytes); ++size) {
+        frames = [self decode:decoder data:data chunk:size];
+        XCTAssertEqualObjects(frames, expected, @"chunk size: %lu", size);
+        [decoder reset];
+    }
+}
+
+- (void)testLengthFieldHeader {
+    // 1 byte type + 2 bytes length counting the whole frame
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:2
+                                                                                 maxFrameLength:0];
+    decoder.lengthOffset = 1;
+    decoder.lengthAdjustment = -3;
+    const UInt8 bytes[] = {0x01, 0x00, 0x06, 'a', 'b', 'c'};
+    NSData *data = [NSData dataWithBytes:bytes length:sizeof(bytes)];
+    XCTAssertEqualObjects([decoder decodeData:data], @[utf8(@"abc")]);
+    decoder.stripsHeader = NO;
+    XCTAssertEqualObjects([decoder decodeData:data], @[data]);
+}
+
+- (void)testLengthFieldTooLarge {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:2
+                                                                                 maxFrameLength:10];
+    NSMutableData *data = [[NSMutableData alloc] init];
+    const UInt8 large[] = {0x00, 0x0F};
+    [data appendBytes:large length:2];
+    [data appendData:[NSMutableData dataWithLength:15]];
+    const UInt8 next[] = {0x00, 0x02, 'h', 'i'};
+    [data appendBytes:next length:4];
+    // the rest of the large frame arrives in the next read
+    NSArray<NSData *> *frames = [decoder decodeData:[data subdataWithRange:NSMakeRange(0, 7)]];
+    XCTAssertEqual([frames count], 0);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    frames = [decoder decodeData:[data subdataWithRange:NSMakeRange(7, [data length] - 7)]];
+    XCTAssertEqualObjects(frames, @[utf8(@"hi")]);
+    XCTAssertEqual([decoder droppedFrames], 1);
+    XCTAssertFalse([decoder isCorrupted]);
+}
+
+- (void)testLengthFieldCorrupted {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:1
+                                                                                 maxFrameLength:0];
+    decoder.lengthAdjustment = -4;
+    const UInt8 bytes[] = {0x02, 'h', 'i', 0x06, 'a', 'b'};
+    NSArray<NSData *> *frames = [decoder decodeData:[NSData dataWithBytes:bytes length:sizeof(bytes)]];
+    XCTAssertEqual([frames count], 0);
+    XCTAssertTrue([decoder isCorrupted]);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    [decoder reset];
+    XCTAssertFalse([decoder isCorrupted]);
+    XCTAssertEqual([decoder droppedFrames], 1);
+}
+
+- (void)testLengthFieldDefaultMax {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] init];
+    XCTAssertEqual([decoder maxFrameLength], 16 * 1024 * 1024);
+    // hostile header, nothing buffered for it
+    const UInt8 bytes[] = {0x7F, 0xFF, 0xFF, 0xFF, 'a', 'b'};
+    NSArray<NSData *> *frames = [decoder decodeData:[NSData dataWithBytes:bytes length:sizeof(bytes)]];
+    XCTAssertEqual([frames count], 0);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    XCTAssertEqual([decoder droppedFrames], 1);
+}
+
+- (void)testLengthFieldOverflow {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:8
+                                                                                 maxFrameLength:0];
+    const UInt8 huge[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0, 'a'};
+    NSArray<NSData *> *frames = [decoder decodeData:[NSData dataWithBytes:huge length:sizeof(huge)]];
+    XCTAssertEqual([frames count], 0);
+    XCTAssertTrue([decoder isCorrupted]);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    // length + adjustment
+    [decoder reset];
+    decoder.lengthAdjustment = 16;
+    const UInt8 large[] = {0x7F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF8, 'a'};
+    frames = [decoder decodeData:[NSData dataWithBytes:large length:sizeof(large)]];
+    XCTAssertEqual([frames count], 0);
+    XCTAssertTrue([decoder isCorrupted]);
+}
+
+- (void)testCorruptedDropsData {
+    STLengthFieldFrameDecoder *decoder = [[STLengthFieldFrameDecoder alloc] initWithFieldLength:1
+                                                                                 maxFrameLength:0];
+    decoder.lengthAdjustment = -4;
+    const UInt8 bytes[] = {0x02, 'h', 'i'};
+    [decoder decodeData:[NSData dataWithBytes:bytes length:sizeof(bytes)]];
+    XCTAssertTrue([decoder isCorrupted]);
+    // a valid frame after that is dropped too
+    const UInt8 valid[] = {0x06, 'h', 'i'};
+    NSData *data = [NSData dataWithBytes:valid length:sizeof(valid)];
+    XCTAssertEqual([[decoder decodeData:data] count], 0);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    // until reset
+    [decoder reset];
+    XCTAssertEqualObjects([decoder decodeData:data], @[utf8(@"hi")]);
+}
+
+#pragma mark Delimiter
+
+- (void)testDelimiterFrames {
+    const UInt8 crlf[] = {'\r', '\n'};
+    STDelimiterFrameDecoder *decoder;
+    decoder = [[STDelimiterFrameDecoder alloc] initWithDelimiter:[NSData dataWithBytes:crlf length:2]
+                                                  maxFrameLength:0];
+    NSData *data = utf8(@"line1\r\nline2\r\n\r\nline3\r\nli");
+    NSArray *expected = @[utf8(@"line1"), utf8(@"line2"), [NSData data], utf8(@"line3")];
+    XCTAssertEqualObjects([decoder decodeData:data], expected);
+    XCTAssertEqual([decoder bufferedLength], 2);
+    // delimiter split across reads
+    XCTAssertEqual([[decoder decodeData:utf8(@"ne4\r")] count], 0);
+    XCTAssertEqualObjects([decoder decodeData:utf8(@"\n")], @[utf8(@"line4")]);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    
+    decoder.stripsDelimiter = NO;
+    XCTAssertEqualObjects([decoder decodeData:utf8(@"ok\r\n")], @[utf8(@"ok\r\n")]);
+}
+
+- (void)testDelimiterTooLarge {
+    STDelimiterFrameDecoder *decoder = [[STDelimiterFrameDecoder alloc] initWithMaxFrameLength:4];
+    // delimiter found
+    XCTAssertEqualObjects([decoder decodeData:utf8(@"toolong\nok\n")], @[utf8(@"ok")]);
+    XCTAssertEqual([decoder droppedFrames], 1);
+    // delimiter not arrived yet, dropped until the next one
+    XCTAssertEqual([[decoder decodeData:utf8(@"abcdefgh")] count], 0);
+    XCTAssertEqual([decoder bufferedLength], 0);
+    XCTAssertEqual([[decoder decodeData:utf8(@"ijklmn")] count], 0);
+    XCTAssertEqualObjects([decoder decodeData:utf8(@"op\nfine\n")], @[utf8(@"fine")]);
+    XCTAssertEqual([decoder droppedFrames], 2);
+}
+
+- (void)testDelimiterPositions {
+    // delimiter at every offset around the 16/32 bytes blocks
+    NSArray<NSString *> *delimiters = @[@"\n", @"\r\n", @"\r\n\r", @"\r\n\r\n"];
+    STDelimiterFrameDecoder *decoder;
+    NSMutableData *data;
+    NSData *delimiter;
+    NSArray<NSData *> *frames;
+    for (NSString *text in delimiters) {
+        delimiter = utf8(text);
+        for (NSUInteger pos = 0; pos < 100; ++pos) {
+            data = [NSMutableData dataWithLength:pos];
+            memset([data mutableBytes], 'x', pos);
+            [data appendData:delimiter];
+            [data appendData:utf8(@"tail")];
+            decoder = [[STDelimiterFrameDecoder alloc] initWithDelimiter:delimiter maxFrameLength:0];
+            frames = [decoder decodeData:data];
+            XCTAssertEqual([frames count], 1, @"delimiter: %@, pos: %lu", text, pos);
+            XCTAssertEqual([[frames firstObject] length], pos, @"delimiter: %@, pos: %lu", text, pos);
+            XCTAssertEqual([decoder bufferedLength], 4);
+        }
+    }
+}
+
+- (void)testDelimiterNearMisses {
+    // first and last bytes of the delimiter match, but not the middle ones
+    NSData *delimiter = utf8(@"\r\n\r\n");
+    NSMutableData *data = [[NSMutableData alloc] init];
+    for (NSUInteger index = 0; index < 50; ++index) {
+        [data appendData:utf8(@"\rxx\n")];
+    }
+    NSUInteger pos = [data length];
+    [data appendData:delimiter];
+    STDelimiterFrameDecoder *decoder = [[STDelimiterFrameDecoder alloc] initWithDelimiter:delimiter
+                                                                           maxFrameLength:0];
+    NSArray<NSData *> *frames = [decoder decodeData:data];
+    XCTAssertEqual([frames count], 1);
+    XCTAssertEqual([[frames firstObject] length], pos);
+}
+
+- (void)testDelimiterResumeAcrossReads {
+    NSMutableData *line = [NSMutableData dataWithLength:5000];
+    memset([line mutableBytes], 'x', 5000);
+    NSMutableData *data = [line mutableCopy];
+    [data appendData:utf8(@"\r\nshort\r\n")];
+    [data appendData:line];
+    [data appendData:utf8(@"\r\n")];
+    NSArray *expected = @[line, utf8(@"short"), line];
+    const UInt8 crlf[] = {'\r', '\n'};
+    STDelimiterFrameDecoder *decoder;
+    decoder = [[STDelimiterFrameDecoder alloc] initWithDelimiter:[NSData dataWithBytes:crlf length:2]
+                                                  maxFrameLength:0];
+    for (NSUInteger size = 1; size < 40; ++size) {
+        XCTAssertEqualObjects([self decode:decoder data:data chunk:size], expected, @"chunk size: %lu", size);
+        XCTAssertEqual([decoder bufferedLength], 0);
+    }
+    XCTAssertEqualObjects([self decode:decoder data:data chunk:4999], expected);
+    XCTAssertEqualObjects([self decode:decoder data:data chunk:5001], expected);
+}
+
+@end
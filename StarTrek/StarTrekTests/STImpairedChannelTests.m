@@ -0,0 +1,114 @@
+//
+//  STImpairedChannelTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+@interface STImpairedChannelTests : XCTestCase
+
+@end
+
+@implementation STImpairedChannelTests
+
+- (void)testFixedSeed {
+    id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    id<NIOSocketAddress> remote = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9395];
+    NSArray<STLoopbackChannel *> *channels;
+    channels = [STLoopbackChannel channelsWithLocalAddress:local
+                                             remoteAddress:remote
+                                                bufferSize:4096
+                                                  datagram:YES];
+    STLoopbackChannel *peer = [channels lastObject];
+    STImpairment *imp = [STImpairment impairmentWithLoss:0.1 delay:0.05 jitter:0];
+    imp.duplicateRate = 0.15;
+    imp.reorderRate = 0.2;
+    imp.reorderDelay = 0.01;
+    STVirtualClock *clock = [[STVirtualClock alloc] initWithTime:100];
+    STImpairedChannel *channel = [[STImpairedChannel alloc] initWithChannel:[channels firstObject]
+                                                                 impairment:imp
+                                                                       seed:7];
+    channel.clock = clock;
+    // one packet every 4 ms, a reordered one (10 ms more) is overtaken by the next two
+    NIOException *error = nil;
+    for (NSUInteger i = 0; i < 20; ++i) {
+        [clock setTime:100 + i * 0.004];
+        Byte b = (Byte)i;
+        NIOByteBuffer *src = [NIOByteBuffer bufferWithData:[NSData dataWithBytes:&b length:1]];
+        XCTAssertEqual([peer writeWithBuffer:src throws:&error], 1);
+        // pulled at its arrival time
+        [channel available];
+    }
+    XCTAssertNil(error);
+    XCTAssertEqual(channel.received, 20);
+    XCTAssertEqual(channel.dropped, 2);
+    XCTAssertEqual(channel.duplicated, 5);
+    XCTAssertEqual(channel.reordered, 4);
+    XCTAssertEqual(channel.delivered, 0);
+    // deliver all
+    [clock setTime:101];
+    NSMutableArray<NSNumber *> *order = [[NSMutableArray alloc] init];
+    NIOByteBuffer *dst = [NIOByteBuffer bufferWithCapacity:16];
+    while (YES) {
+        [dst clear];
+        if ([channel readWithBuffer:dst throws:&error] <= 0) {
+            break;
+        }
+        [dst flip];
+        XCTAssertEqual([dst remaining], 1);
+        [order addObject:@([dst getByte])];
+    }
+    XCTAssertNil(error);
+    NSArray *expected = @[@0, @0, @1, @2, @3, @4, @2, @5, @6, @6, @8, @9,
+                          @9, @7, @12, @10, @11, @15, @16, @17, @17, @18, @19];
+    XCTAssertEqualObjects(order, expected);
+    XCTAssertEqual(channel.delivered, 23);
+    XCTAssertEqual(channel.nextDueTime, 0);
+}
+
+- (void)testSameSeedSameResult {
+    NSMutableArray *results = [[NSMutableArray alloc] init];
+    for (NSUInteger round = 0; round < 2; ++round) {
+        id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+        id<NIOSocketAddress> remote = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9395];
+        NSArray<STLoopbackChannel *> *channels;
+        channels = [STLoopbackChannel channelsWithLocalAddress:local
+                                                 remoteAddress:remote
+                                                    bufferSize:65536
+                                                      datagram:YES];
+        STImpairment *imp = [STImpairment impairmentWithLoss:0.3 delay:0.02 jitter:0.01];
+        imp.duplicateRate = 0.2;
+        imp.reorderRate = 0.2;
+        STVirtualClock *clock = [[STVirtualClock alloc] initWithTime:100];
+        STImpairedChannel *channel = [[STImpairedChannel alloc] initWithChannel:[channels firstObject]
+                                                                     impairment:imp
+                                                                           seed:12345];
+        channel.clock = clock;
+        for (NSUInteger i = 0; i < 100; ++i) {
+            Byte b = (Byte)i;
+            NIOByteBuffer *src = [NIOByteBuffer bufferWithData:[NSData dataWithBytes:&b length:1]];
+            [[channels lastObject] writeWithBuffer:src throws:nil];
+            [channel available];
+        }
+        [clock setTime:101];
+        NSMutableData *received = [[NSMutableData alloc] init];
+        NIOByteBuffer *dst = [NIOByteBuffer bufferWithCapacity:16];
+        while (YES) {
+            [dst clear];
+            if ([channel readWithBuffer:dst throws:nil] <= 0) {
+                break;
+            }
+            [dst flip];
+            Byte b = [dst getByte];
+            [received appendBytes:&b length:1];
+        }
+        [results addObject:@[@(channel.dropped), @(channel.duplicated), @(channel.reordered), received]];
+    }
+    XCTAssertEqualObjects([results firstObject], [results lastObject]);
+}
+
+@end
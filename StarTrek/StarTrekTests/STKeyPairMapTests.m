@@ -0,0 +1,322 @@
+//
+//  STKeyPairMapTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline id<NIOSocketAddress> address(NSString *host, UInt16 port) {
+    return [NIOInetSocketAddress addressWithHost:host port:port];
+}
+
+/**
+ *  Key with given hash, for building collisions
+ */
+@interface STTestKey : NSObject
+
+@property(nonatomic, readonly) NSUInteger number;
+
+- (instancetype)initWithNumber:(NSUInteger)number hash:(NSUInteger)hash;
+
+@end
+
+@implementation STTestKey {
+    
+    NSUInteger _hash;
+}
+
+- (instancetype)initWithNumber:(NSUInteger)number hash:(NSUInteger)hash {
+    if (self = [super init]) {
+        _number = number;
+        _hash = hash;
+    }
+    return self;
+}
+
+- (NSUInteger)hash {
+    return _hash;
+}
+
+- (BOOL)isEqual:(id)object {
+    if (![object isKindOfClass:[STTestKey class]]) {
+        return NO;
+    }
+    return [(STTestKey *)object number] == _number;
+}
+
+@end
+
+@interface STKeyPairMapTests : XCTestCase
+
+@end
+
+@implementation STKeyPairMapTests
+
+// private
+- (void)checkLookups:(STKeyPairMap<id<NIOSocketAddress>, NSString *> *)map {
+    id<NIOSocketAddress> remote1 = address(@"10.0.0.1", 1001);
+    id<NIOSocketAddress> remote2 = address(@"10.0.0.2", 1002);
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    [map setObject:@"a" forRemote:remote1 local:local];
+    [map setObject:@"b" forRemote:remote2 local:nil];
+    [map setObject:@"c" forRemote:nil local:local];
+    // mapping: (remote, local) => value
+    XCTAssertEqualObjects([map objectForRemote:remote1 local:local], @"a");
+    XCTAssertEqualObjects([map objectForRemote:address(@"10.0.0.1", 1001) local:address(@"0.0.0.0", 9394)], @"a");
+    // mapping: (remote, null) => value
+    XCTAssertEqualObjects([map objectForRemote:remote2 local:nil], @"b");
+    XCTAssertEqualObjects([map objectForRemote:remote2 local:local], @"b");
+    // mapping: (local, null) => value
+    XCTAssertEqualObjects([map objectForRemote:nil local:local], @"c");
+    // any value connected to remote
+    XCTAssertEqualObjects([map objectForRemote:remote1 local:nil], @"a");
+    XCTAssertNil([map objectForRemote:remote1 local:address(@"0.0.0.0", 9395)]);
+    XCTAssertNil([map objectForRemote:address(@"10.0.0.3", 1003) local:nil]);
+    
+    // replace
+    [map setObject:@"A" forRemote:remote1 local:local];
+    XCTAssertEqualObjects([map objectForRemote:remote1 local:local], @"A");
+    XCTAssertEqualObjects([map objectForRemote:remote1 local:nil], @"A");
+    NSSet *expected = [NSSet setWithObjects:@"A", @"b", @"c", nil];
+    XCTAssertEqualObjects([map allValues], expected);
+    
+    // remove
+    XCTAssertEqualObjects([map removeObject:nil forRemote:remote1 local:local], @"A");
+    XCTAssertNil([map objectForRemote:remote1 local:local]);
+    XCTAssertNil([map objectForRemote:remote1 local:nil]);
+    XCTAssertEqualObjects([map removeObject:nil forRemote:remote2 local:nil], @"b");
+    XCTAssertNil([map objectForRemote:remote2 local:local]);
+    XCTAssertEqualObjects([map objectForRemote:nil local:local], @"c");
+    XCTAssertEqualObjects([map allValues], [NSSet setWithObject:@"c"]);
+}
+
+#pragma mark Concurrent Map
+
+- (void)testConcurrentLookups {
+    [self checkLookups:[[STConcurrentAddressPairMap alloc] initWithStripes:4]];
+    [self checkLookups:[[STConcurrentAddressPairMap alloc] initWithStripes:1]];
+}
+
+- (void)testConcurrentWriters {
+    STConcurrentAddressPairMap<NSString *> *map = [[STConcurrentAddressPairMap alloc] init];
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    size_t threads = 8;
+    UInt16 count = 500;
+    dispatch_queue_t queue = dispatch_get_global_queue(QOS_CLASS_DEFAULT, 0);
+    dispatch_apply(threads, queue, ^(size_t t) {
+        NSString *value;
+        id<NIOSocketAddress> remote;
+        for (UInt16 i = 0; i < count; ++i) {
+            value = [NSString stringWithFormat:@"%zu-%u", t, i];
+            remote = address(@"10.0.0.1", (UInt16)(t * count + i + 1));
+            [map setObject:value forRemote:remote local:local];
+            XCTAssertEqualObjects([map objectForRemote:remote local:local], value);
+            // readers take snapshots while writing
+            XCTAssertGreaterThan([[map allValues] count], 0);
+        }
+    });
+    XCTAssertEqual([[map allValues] count], threads * count);
+    
+    // remove the even ones
+    dispatch_apply(threads, queue, ^(size_t t) {
+        for (UInt16 i = 0; i < count; i += 2) {
+            [map removeObject:nil forRemote:address(@"10.0.0.1", (UInt16)(t * count + i + 1)) local:local];
+        }
+    });
+    XCTAssertEqual([[map allValues] count], threads * count / 2);
+    XCTAssertEqual([[map valuesArray] count], threads * count / 2);
+    NSString *value;
+    for (size_t t = 0; t < threads; ++t) {
+        for (UInt16 i = 0; i < count; ++i) {
+            value = [map objectForRemote:address(@"10.0.0.1", (UInt16)(t * count + i + 1)) local:local];
+            if (i % 2 == 0) {
+                XCTAssertNil(value);
+            } else {
+                XCTAssertEqualObjects(value, ([NSString stringWithFormat:@"%zu-%u", t, i]));
+            }
+        }
+    }
+}
+
+- (void)testConcurrentCount {
+    STConcurrentAddressPairMap<NSString *> *map = [[STConcurrentAddressPairMap alloc] initWithStripes:4];
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    for (UInt16 port = 1; port <= 100; ++port) {
+        [map setObject:@"v" forRemote:address(@"10.0.0.1", port) local:local];
+    }
+    XCTAssertEqual([map count], 100);
+    [map removeObject:nil forRemote:address(@"10.0.0.1", 1) local:local];
+    XCTAssertEqual([map count], 99);
+}
+
+#pragma mark Flat Map
+
+- (void)testFlatLookups {
+    [self checkLookups:[STAddressPairMap map]];
+    [self checkLookups:[[STFlatKeyPairMap alloc] initWithDefaultValue:STAnyAddress()]];
+}
+
+- (void)testFlatResize {
+    STFlatKeyPairMap<STTestKey *, NSNumber *> *map;
+    map = [[STFlatKeyPairMap alloc] initWithDefaultValue:[[STTestKey alloc] initWithNumber:0 hash:0]];
+    STTestKey *local = [[STTestKey alloc] initWithNumber:1 hash:1];
+    NSUInteger count = 5000;
+    NSMutableArray<STTestKey *> *keys = [[NSMutableArray alloc] initWithCapacity:count];
+    for (NSUInteger i = 0; i < count; ++i) {
+        [keys addObject:[[STTestKey alloc] initWithNumber:(i + 100) hash:(i * 7919)]];
+        [map setObject:@(i) forRemote:keys[i] local:local];
+    }
+    XCTAssertEqual([map count], count);
+    // remove the odd ones in another order
+    for (NSUInteger i = 1; i < count; i += 2) {
+        NSUInteger j = (i * 2654435761U) % count | 1;
+        [map removeObject:nil forRemote:keys[j] local:local];
+    }
+    for (NSUInteger i = 1; i < count; i += 2) {
+        [map removeObject:nil forRemote:keys[i] local:local];
+    }
+    XCTAssertEqual([map count], count / 2);
+    for (NSUInteger i = 0; i < count; ++i) {
+        if (i % 2 == 0) {
+            XCTAssertEqualObjects([map objectForRemote:keys[i] local:local], @(i));
+        } else {
+            XCTAssertNil([map objectForRemote:keys[i] local:local]);
+        }
+    }
+}
+
+- (void)testFlatCollisions {
+    // compared with a dictionary, keys are crowded in few hash values,
+    // so the clusters wrap around the table and are shifted back on removing
+    STTestKey *any = [[STTestKey alloc] initWithNumber:0 hash:0];
+    STFlatKeyPairMap<STTestKey *, NSNumber *> *map = [[STFlatKeyPairMap alloc] initWithDefaultValue:any];
+    NSMutableDictionary<NSNumber *, NSNumber *> *model = [[NSMutableDictionary alloc] init];
+    NSMutableArray<STTestKey *> *keys = [[NSMutableArray alloc] init];
+    for (NSUInteger i = 1; i <= 40; ++i) {
+        [keys addObject:[[STTestKey alloc] initWithNumber:i hash:(i % 4)]];
+    }
+    UInt32 seed = 20231018;
+    STTestKey *key;
+    NSNumber *value;
+    for (NSUInteger step = 0; step < 3000; ++step) {
+        seed = seed * 1103515245 + 12345;
+        key = keys[(seed >> 16) % [keys count]];
+        if ((seed >> 8) & 1) {
+            value = @(step);
+            [map setObject:value forRemote:key local:nil];
+            [model setObject:value forKey:@(key.number)];
+        } else {
+            value = [model objectForKey:@(key.number)];
+            XCTAssertEqualObjects([map removeObject:nil forRemote:key local:nil], value);
+            [model removeObjectForKey:@(key.number)];
+        }
+        XCTAssertEqual([map count], [model count]);
+        for (key in keys) {
+            XCTAssertEqualObjects([map objectForRemote:key local:any], [model objectForKey:@(key.number)],
+                                  @"step: %lu, key: %lu", step, key.number);
+        }
+    }
+}
+
+- (void)testFlatReleases {
+    __weak id weakValue = nil;
+    __weak id weakKey = nil;
+    STAddressPairMap *map = [[STAddressPairMap alloc] init];
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    @autoreleasepool {
+        NSObject *value = [[NSObject alloc] init];
+        id<NIOSocketAddress> remote = [[NIOInetSocketAddress alloc] initWithHost:@"10.0.0.1" port:1001];
+        weakValue = value;
+        weakKey = remote;
+        [map setObject:value forRemote:remote local:local];
+    }
+    // retained by the map
+    XCTAssertNotNil(weakValue);
+    XCTAssertNotNil(weakKey);
+    @autoreleasepool {
+        [map removeObject:nil forRemote:address(@"10.0.0.1", 1001) local:local];
+    }
+    XCTAssertNil(weakValue);
+    XCTAssertNil(weakKey);
+    // released with the map
+    @autoreleasepool {
+        NSObject *value = [[NSObject alloc] init];
+        weakValue = value;
+        [map setObject:value forRemote:address(@"10.0.0.2", 1002) local:local];
+        map = nil;
+    }
+    XCTAssertNil(weakValue);
+}
+
+#pragma mark Snapshots
+
+// private
+- (void)checkSnapshots:(STKeyPairMap<id<NIOSocketAddress>, NSString *> *)map arrays:(BOOL)cached {
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    [map setObject:@"a" forRemote:address(@"10.0.0.1", 1001) local:local];
+    [map setObject:@"b" forRemote:address(@"10.0.0.2", 1002) local:local];
+    NSSet *values = [map allValues];
+    NSArray *array = [map valuesArray];
+    // unchanged, same snapshot
+    XCTAssertTrue([map allValues] == values);
+    if (cached) {
+        XCTAssertTrue([map valuesArray] == array);
+    }
+    XCTAssertEqual([array count], 2);
+    
+    [map setObject:@"c" forRemote:address(@"10.0.0.3", 1003) local:local];
+    NSSet *newValues = [map allValues];
+    XCTAssertFalse(newValues == values);
+    XCTAssertEqual([newValues count], 3);
+    XCTAssertFalse([map valuesArray] == array);
+    XCTAssertEqual([[map valuesArray] count], 3);
+    // the old snapshot is immutable
+    XCTAssertEqual([values count], 2);
+    XCTAssertEqual([array count], 2);
+    
+    [map removeObject:nil forRemote:address(@"10.0.0.1", 1001) local:local];
+    XCTAssertEqualObjects([map allValues], ([NSSet setWithObjects:@"b", @"c", nil]));
+    XCTAssertEqual([newValues count], 3);
+}
+
+- (void)testFlatSnapshots {
+    STAddressPairMap<NSString *> *map = [STAddressPairMap map];
+    [self checkSnapshots:map arrays:YES];
+    
+    NSUInteger version = [map version];
+    id<NIOSocketAddress> remote = address(@"10.0.0.2", 1002);
+    id<NIOSocketAddress> local = address(@"0.0.0.0", 9394);
+    NSString *value = [map objectForRemote:remote local:local];
+    NSSet *values = [map allValues];
+    // same value, nothing changed
+    [map setObject:value forRemote:remote local:local];
+    XCTAssertEqual([map version], version);
+    XCTAssertTrue([map allValues] == values);
+    // not found, nothing changed
+    [map removeObject:nil forRemote:address(@"10.0.0.9", 1009) local:local];
+    XCTAssertEqual([map version], version);
+    // changed
+    [map setObject:@"B" forRemote:remote local:local];
+    XCTAssertEqual([map version], version + 1);
+    [map removeObject:nil forRemote:remote local:local];
+    XCTAssertEqual([map version], version + 2);
+}
+
+- (void)testConcurrentSnapshots {
+    STConcurrentAddressPairMap<NSString *> *map = [[STConcurrentAddressPairMap alloc] initWithStripes:4];
+    [self checkSnapshots:map arrays:YES];
+    NSUInteger version = [map version];
+    [map setObject:@"d" forRemote:address(@"10.0.0.4", 1004) local:nil];
+    XCTAssertGreaterThan([map version], version);
+}
+
+- (void)testHashSnapshots {
+    // values array is built from the set snapshot each time
+    [self checkSnapshots:[STHashKeyPairMap mapWithDefaultValue:STAnyAddress()] arrays:NO];
+}
+
+@end
@@ -0,0 +1,138 @@
+//
+//  STPacerTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+@interface STPacerTests : XCTestCase
+
+@end
+
+@implementation STPacerTests
+
+- (void)testTokenBucketRefill {
+    STTokenBucket *bucket = [[STTokenBucket alloc] initWithRate:1000 capacity:1000];
+    XCTAssertTrue([bucket consumeLength:1000 time:100.0]);
+    XCTAssertFalse([bucket consumeLength:1 time:100.0]);
+    // half a second later
+    XCTAssertFalse([bucket consumeLength:600 time:100.5]);
+    XCTAssertTrue([bucket consumeLength:500 time:100.5]);
+    // never refilled over the capacity
+    XCTAssertTrue([bucket hasTokensForLength:1000 time:200.0]);
+    XCTAssertEqualWithAccuracy([bucket tokens], 1000, 0.001);
+}
+
+- (void)testTokenBucketDebt {
+    STTokenBucket *bucket = [[STTokenBucket alloc] initWithRate:1000 capacity:1000];
+    // a package larger than the bucket goes when the bucket is full
+    XCTAssertTrue([bucket hasTokensForLength:3000 time:100.0]);
+    [bucket takeTokensForLength:3000 time:100.0];
+    XCTAssertEqualWithAccuracy([bucket tokens], -2000, 0.001);
+    // and the debt must be paid before next one
+    XCTAssertFalse([bucket hasTokensForLength:1 time:101.0]);
+    XCTAssertTrue([bucket hasTokensForLength:1 time:102.5]);
+}
+
+- (void)testUnlimitedBucket {
+    STTokenBucket *bucket = [[STTokenBucket alloc] initWithRate:0 capacity:0];
+    XCTAssertTrue([bucket consumeLength:1000000 time:100.0]);
+    XCTAssertTrue([bucket consumeLength:1000000 time:100.0]);
+}
+
+- (void)testCongestionWindow {
+    STCongestionWindow *cwnd = [[STCongestionWindow alloc] initWithWindow:400 segmentSize:100];
+    XCTAssertEqual([cwnd window], 400);
+    // one package always goes when nothing in flight
+    XCTAssertTrue([cwnd canSendLength:1000]);
+    [cwnd sentLength:300];
+    XCTAssertTrue([cwnd canSendLength:100]);
+    XCTAssertFalse([cwnd canSendLength:101]);
+    // slow start: window grows by the acked length
+    [cwnd ackedLength:300];
+    XCTAssertEqual([cwnd inflight], 0);
+    XCTAssertEqual([cwnd window], 700);
+    // on loss: window shrinks to the half
+    [cwnd sentLength:700];
+    [cwnd lostLength:700];
+    XCTAssertEqual([cwnd inflight], 0);
+    XCTAssertEqual([cwnd window], 350);
+    XCTAssertEqual([cwnd threshold], 350);
+    // congestion avoidance: one segment per window acked
+    [cwnd sentLength:350];
+    [cwnd ackedLength:350];
+    XCTAssertEqual([cwnd window], 450);
+}
+
+- (void)testWindowReleasedPerFragment {
+    NSData *page0 = [NSMutableData dataWithLength:300];
+    NSData *page1 = [NSMutableData dataWithLength:300];
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:@"1"
+                                                      fragments:@[page0, page1]
+                                                       priority:0
+                                                      important:YES];
+    STCongestionWindow *cwnd = [[STCongestionWindow alloc] initWithWindow:400 segmentSize:100];
+    STPacer *pacer = [[STPacer alloc] initWithTokenBucket:nil congestionWindow:cwnd];
+    NSTimeInterval now = 100.0;
+    
+    [pacer startDeparture:ship time:now];
+    XCTAssertTrue([pacer allowsLength:300 departure:ship time:now]);
+    [pacer sentLength:300 fragment:page0 departure:ship time:now];
+    // window full
+    XCTAssertFalse([pacer allowsLength:300 departure:ship time:now]);
+    
+    // page 0 responded
+    STTestArrival *ack = [[STTestArrival alloc] initWithSN:@"1" page:0];
+    XCTAssertFalse([ship checkResponseWithinArrivalShip:ack]);
+    [pacer checkResponsesInArrivals:@[ack]];
+    XCTAssertEqual([cwnd inflight], 0);
+    XCTAssertEqual([cwnd window], 700);
+    
+    XCTAssertTrue([pacer allowsLength:300 departure:ship time:now]);
+    [pacer sentLength:300 fragment:page1 departure:ship time:now];
+    XCTAssertEqual([cwnd inflight], 300);
+    // same response again releases nothing more
+    [pacer checkResponsesInArrivals:@[ack]];
+    XCTAssertEqual([cwnd inflight], 300);
+    
+    [pacer finishDeparture:ship];
+    XCTAssertEqual([cwnd inflight], 0);
+}
+
+- (void)testLostOnResend {
+    STTestDeparture *ship = [STTestDeparture departureWithSN:@"1" size:300 priority:0];
+    STCongestionWindow *cwnd = [[STCongestionWindow alloc] initWithWindow:1000 segmentSize:100];
+    STPacer *pacer = [[STPacer alloc] initWithTokenBucket:nil congestionWindow:cwnd];
+    NSData *fra = [[ship fragments] firstObject];
+    
+    [pacer startDeparture:ship time:100.0];
+    [pacer sentLength:300 fragment:fra departure:ship time:100.0];
+    XCTAssertEqual([cwnd inflight], 300);
+    // taken again for timeout
+    [pacer startDeparture:ship time:200.0];
+    XCTAssertEqual([cwnd inflight], 0);
+    XCTAssertEqual([cwnd window], 500);
+}
+
+- (void)testDisposableNotCounted {
+    NSData *fra = [NSMutableData dataWithLength:300];
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:@"1"
+                                                      fragments:@[fra]
+                                                       priority:0
+                                                      important:NO];
+    STTokenBucket *bucket = [[STTokenBucket alloc] initWithRate:1000 capacity:1000];
+    STCongestionWindow *cwnd = [[STCongestionWindow alloc] initWithWindow:400 segmentSize:100];
+    STPacer *pacer = [[STPacer alloc] initWithTokenBucket:bucket congestionWindow:cwnd];
+    
+    XCTAssertTrue([pacer allowsLength:300 departure:ship time:100.0]);
+    [pacer sentLength:300 fragment:fra departure:ship time:100.0];
+    XCTAssertEqual([cwnd inflight], 0);
+    // tokens are taken for disposable ships too
+    XCTAssertEqualWithAccuracy([bucket tokens], 700, 0.001);
+}
+
+@end
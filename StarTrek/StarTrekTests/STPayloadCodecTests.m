@@ -0,0 +1,176 @@
+//
+//  STPayloadCodecTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+// pseudo random bytes, same for each run
+static inline NSData *random_data(NSUInteger length, UInt32 seed) {
+    NSMutableData *data = [NSMutableData dataWithLength:length];
+    UInt8 *bytes = [data mutableBytes];
+    for (NSUInteger i = 0; i < length; ++i) {
+        seed = seed * 1103515245 + 12345;
+        bytes[i] = (seed >> 16) & 0xFF;
+    }
+    return data;
+}
+
+// text with many repeats
+static inline NSData *text_data(NSUInteger length) {
+    NSMutableString *text = [[NSMutableString alloc] init];
+    NSUInteger index = 0;
+    while ([text length] < length) {
+        [text appendFormat:@"{\"sn\":%lu,\"type\":\"text\",\"content\":\"Hello world!\"}\n", index++];
+    }
+    return [[text dataUsingEncoding:NSUTF8StringEncoding] subdataWithRange:NSMakeRange(0, length)];
+}
+
+/**
+ *  Stage for checking the chain order
+ */
+@interface STTestXorCodec : NSObject <STPayloadCodec>
+
+@end
+
+@implementation STTestXorCodec
+
+- (NSString *)name {
+    return @"xor";
+}
+
+- (BOOL)encodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst {
+    NSUInteger length = [src remaining];
+    const UInt8 *bytes = [src readableBytes];
+    NSUInteger start = dst.length;
+    [dst setLength:(start + length)];
+    UInt8 *out = (UInt8 *)dst.mutableBytes + start;
+    for (NSUInteger i = 0; i < length; ++i) {
+        out[i] = bytes[i] ^ 0x5A;
+    }
+    return YES;
+}
+
+- (BOOL)decodeBuffer:(NIOByteBuffer *)src output:(NSMutableData *)dst {
+    return [self encodeBuffer:src output:dst];
+}
+
+@end
+
+@interface STPayloadCodecTests : XCTestCase
+
+@end
+
+@implementation STPayloadCodecTests
+
+// private
+- (void)checkRoundTrip:(NSData *)data chain:(STCodecChain *)chain {
+    NSData *encoded = [chain encodeData:data];
+    XCTAssertNotNil(encoded);
+    NSData *decoded = [chain decodeData:encoded];
+    XCTAssertEqualObjects(decoded, data, @"length: %lu", [data length]);
+}
+
+- (void)testRoundTrip {
+    STCodecChain *chain = [[STCodecChain alloc] initWithCodecs:@[[[STLZCodec alloc] init]]];
+    [self checkRoundTrip:[NSData data] chain:chain];
+    // around the threshold
+    for (NSUInteger length = 1; length < 200; ++length) {
+        [self checkRoundTrip:text_data(length) chain:chain];
+        [self checkRoundTrip:random_data(length, (UInt32)length) chain:chain];
+    }
+    // long runs of one byte (overlapped matches)
+    NSMutableData *zeros = [NSMutableData dataWithLength:100000];
+    [self checkRoundTrip:zeros chain:chain];
+    // large payloads
+    [self checkRoundTrip:text_data(1024 * 1024) chain:chain];
+    [self checkRoundTrip:random_data(100000, 7) chain:chain];
+    // mixed
+    NSMutableData *mixed = [[NSMutableData alloc] init];
+    for (UInt32 seed = 0; seed < 20; ++seed) {
+        [mixed appendData:random_data(997, seed)];
+        [mixed appendData:text_data(1500 + seed)];
+        [mixed appendData:random_data(997, seed)];
+    }
+    [self checkRoundTrip:mixed chain:chain];
+}
+
+- (void)testCompression {
+    STCodecChain *chain = [[STCodecChain alloc] initWithCodecs:@[[[STLZCodec alloc] init]]];
+    NSData *text = text_data(10000);
+    NSData *encoded = [chain encodeData:text];
+    XCTAssertLessThan([encoded length], [text length] / 3);
+    XCTAssertEqual(((const UInt8 *)[encoded bytes])[0], 1);
+    // not compressible, stored raw
+    NSData *noise = random_data(10000, 1);
+    encoded = [chain encodeData:noise];
+    XCTAssertEqual([encoded length], [noise length] + 1);
+    XCTAssertEqual(((const UInt8 *)[encoded bytes])[0], 0);
+    // too short
+    encoded = [chain encodeData:text_data(63)];
+    XCTAssertEqual([encoded length], 64);
+}
+
+- (void)testCorrupted {
+    STLZCodec *lz = [[STLZCodec alloc] init];
+    STCodecChain *chain = [[STCodecChain alloc] initWithCodecs:@[lz]];
+    NSData *encoded = [chain encodeData:text_data(10000)];
+    // truncated
+    NSData *truncated = [encoded subdataWithRange:NSMakeRange(0, [encoded length] - 10)];
+    XCTAssertNil([chain decodeData:truncated]);
+    // wrong length
+    NSMutableData *tampered = [encoded mutableCopy];
+    ((UInt8 *)[tampered mutableBytes])[4] ^= 0x01;
+    XCTAssertNil([chain decodeData:tampered]);
+    // unknown method
+    const UInt8 unknown[] = {0x09, 0x00};
+    XCTAssertNil([chain decodeData:[NSData dataWithBytes:unknown length:2]]);
+    XCTAssertNil([chain decodeData:[NSData data]]);
+    // too large
+    lz.maxLength = 1000;
+    XCTAssertNil([chain decodeData:encoded]);
+    XCTAssertEqual([[[chain statistics] firstObject] errors], 5);
+}
+
+- (void)testChain {
+    STCodecChain *chain = [[STCodecChain alloc] initWithCodecs:@[[[STLZCodec alloc] init],
+                                                                 [[STTestXorCodec alloc] init]]];
+    STCodecChain *lz = [[STCodecChain alloc] initWithCodecs:@[[[STLZCodec alloc] init]]];
+    NSData *text = text_data(10000);
+    NSData *compressed = [lz encodeData:text];
+    NSData *encoded = [chain encodeData:text];
+    XCTAssertEqual([encoded length], [compressed length]);
+    // xor applied after lz
+    XCTAssertEqual(((const UInt8 *)[encoded bytes])[0], 1 ^ 0x5A);
+    XCTAssertEqualObjects([chain decodeData:encoded], text);
+    
+    NSArray<STCodecStatistics *> *stats = [chain statistics];
+    XCTAssertEqual([stats count], 2);
+    XCTAssertEqualObjects([stats[0] name], @"lz");
+    XCTAssertEqualObjects([stats[1] name], @"xor");
+    XCTAssertEqual([stats[0] encodeCount], 1);
+    XCTAssertEqual([stats[0] encodeBytesIn], [text length]);
+    XCTAssertEqual([stats[0] encodeBytesOut], [compressed length]);
+    XCTAssertEqual([stats[1] encodeBytesIn], [compressed length]);
+    XCTAssertEqual([stats[1] decodeCount], 1);
+    XCTAssertEqual([stats[0] decodeBytesOut], [text length]);
+    
+    [chain resetStatistics];
+    stats = [chain statistics];
+    XCTAssertEqual([stats[0] encodeCount], 0);
+    XCTAssertEqual([stats[1] decodeCount], 0);
+    XCTAssertEqualObjects([stats[1] name], @"xor");
+}
+
+- (void)testEmptyChain {
+    STCodecChain *chain = [[STCodecChain alloc] initWithCodecs:@[]];
+    NSData *text = text_data(100);
+    XCTAssertEqualObjects([chain encodeData:text], text);
+    XCTAssertEqualObjects([chain decodeData:text], text);
+}
+
+@end
@@ -0,0 +1,80 @@
+//
+//  STPurgeTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import "STTestShips.h"
+
+@interface STPurgeTests : XCTestCase
+
+@end
+
+@implementation STPurgeTests
+
+- (void)testBudgetLimit {
+    STPurgeBudget *budget = [STPurgeBudget budgetWithLimit:3 duration:0];
+    XCTAssertTrue([budget consume]);
+    XCTAssertTrue([budget consume]);
+    XCTAssertTrue([budget consume]);
+    XCTAssertFalse([budget consume]);
+    XCTAssertTrue([budget isExhausted]);
+}
+
+- (void)testBudgetDuration {
+    STVirtualClock *clock = [[STVirtualClock alloc] initWithTime:100];
+    STPurgeBudget *budget = [STPurgeBudget budgetWithLimit:1000 duration:1 clock:clock];
+    for (NSUInteger i = 0; i < 15; ++i) {
+        XCTAssertTrue([budget consume], @"entry: %lu", i);
+    }
+    [clock advance:2];
+    // the clock is checked every 16 entries
+    XCTAssertFalse([budget consume]);
+    XCTAssertTrue([budget isExhausted]);
+    XCTAssertEqual([budget remaining], 0);
+}
+
+- (void)testExpiryQueue {
+    STExpiryQueue<NSNumber *> *queue = [[STExpiryQueue alloc] init];
+    for (NSUInteger i = 0; i < 100; ++i) {
+        [queue addObject:@(i) time:i];
+    }
+    NSNumber *obj;
+    NSTimeInterval time;
+    for (NSUInteger i = 0; i < 70; ++i) {
+        XCTAssertTrue([queue popObject:&obj time:&time before:70]);
+        XCTAssertEqualObjects(obj, @(i));
+        XCTAssertEqual(time, i);
+    }
+    XCTAssertFalse([queue popObject:&obj time:&time before:70]);
+    XCTAssertEqual([queue count], 30);
+    // appended after compacting
+    [queue addObject:@(100) time:100];
+    for (NSUInteger i = 70; i <= 100; ++i) {
+        XCTAssertTrue([queue popObject:&obj time:NULL before:INFINITY]);
+        XCTAssertEqualObjects(obj, @(i));
+    }
+    XCTAssertEqual([queue count], 0);
+    XCTAssertFalse([queue popObject:&obj time:NULL before:INFINITY]);
+}
+
+- (void)testSweepResumption {
+    STDepartureHall *hall = [[STDepartureHall alloc] init];
+    for (NSUInteger i = 0; i < 10; ++i) {
+        NSString *sn = [NSString stringWithFormat:@"S%lu", i];
+        XCTAssertTrue([hall addDeparture:[STTestDeparture departureWithSN:sn size:8 priority:0] time:1]);
+        XCTAssertNotNil([hall nextDepartureWithTime:1]);
+    }
+    // 10 ships waiting for responses, swept in 3 calls
+    XCTAssertFalse([hall purgeWithTime:1 budget:[STPurgeBudget budgetWithLimit:4 duration:0]]);
+    XCTAssertFalse([hall purgeWithTime:1 budget:[STPurgeBudget budgetWithLimit:4 duration:0]]);
+    XCTAssertTrue([hall purgeWithTime:1 budget:[STPurgeBudget budgetWithLimit:4 duration:0]]);
+    // a new round
+    XCTAssertFalse([hall purgeWithTime:1 budget:[STPurgeBudget budgetWithLimit:9 duration:0]]);
+    XCTAssertTrue([hall purgeWithTime:1 budget:[STPurgeBudget budgetWithLimit:2 duration:0]]);
+}
+
+@end
@@ -0,0 +1,125 @@
+//
+//  STReadySetTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+@interface STReadySetTests : XCTestCase
+
+@end
+
+@implementation STReadySetTests
+
+- (void)testReadyNow {
+    STReadySet<NSString *> *set = [[STReadySet alloc] init];
+    [set addObject:@"a"];
+    [set addObject:@"b"];
+    [set addObject:@"a"];
+    NSSet *expected = [NSSet setWithObjects:@"a", @"b", nil];
+    NSArray *popped = [set popObjectsWithTime:1];
+    XCTAssertEqual([popped count], 2);
+    XCTAssertEqualObjects([NSSet setWithArray:popped], expected);
+    XCTAssertEqual([[set popObjectsWithTime:2] count], 0);
+}
+
+- (void)testIdentity {
+    STReadySet<NSString *> *set = [[STReadySet alloc] init];
+    NSString *a1 = [NSMutableString stringWithString:@"a"];
+    NSString *a2 = [NSMutableString stringWithString:@"a"];
+    NSString *b1 = [NSMutableString stringWithString:@"b"];
+    NSString *b2 = [NSMutableString stringWithString:@"b"];
+    [set addObject:a1];
+    [set addObject:a2];
+    [set addObject:a1];
+    [set addObject:b1 time:5];
+    [set addObject:b2 time:5];
+    // equal objects are different ones
+    NSArray *popped = [set popObjectsWithTime:5];
+    XCTAssertEqual([popped count], 4);
+    XCTAssertTrue([popped indexOfObjectIdenticalTo:a2] != NSNotFound);
+    XCTAssertTrue([popped indexOfObjectIdenticalTo:b2] != NSNotFound);
+}
+
+- (void)testTimers {
+    NSObject *a = [[NSObject alloc] init];
+    NSObject *b = [[NSObject alloc] init];
+    NSObject *c = [[NSObject alloc] init];
+    STReadySet *set = [[STReadySet alloc] init];
+    [set addObject:a time:10];
+    [set addObject:b time:5];
+    [set addObject:c time:20];
+    XCTAssertEqual([[set popObjectsWithTime:4] count], 0);
+    XCTAssertEqualObjects([set popObjectsWithTime:5], @[b]);
+    XCTAssertEqualObjects([set popObjectsWithTime:15], @[a]);
+    XCTAssertEqualObjects([set popObjectsWithTime:25], @[c]);
+    XCTAssertEqual([[set popObjectsWithTime:100] count], 0);
+}
+
+- (void)testHeapOrder {
+    NSMutableArray<NSObject *> *objects = [[NSMutableArray alloc] init];
+    STReadySet *set = [[STReadySet alloc] init];
+    NSUInteger count = 200;
+    for (NSUInteger i = 0; i < count; ++i) {
+        [objects addObject:[[NSObject alloc] init]];
+        // shuffled times: 0, 1, ... count - 1
+        [set addObject:objects[i] time:((i * 37) % count)];
+    }
+    NSArray *popped;
+    for (NSUInteger t = 0; t < count; ++t) {
+        popped = [set popObjectsWithTime:t];
+        XCTAssertEqual([popped count], 1, @"time: %lu", t);
+        // i * 37 % count == t
+        NSUInteger i = (t * 173) % count;
+        XCTAssertTrue([popped containsObject:objects[i]], @"time: %lu", t);
+    }
+}
+
+- (void)testEarliestTimeOnly {
+    NSObject *a = [[NSObject alloc] init];
+    STReadySet *set = [[STReadySet alloc] init];
+    // later time ignored
+    [set addObject:a time:10];
+    [set addObject:a time:20];
+    XCTAssertEqual([[set popObjectsWithTime:10] count], 1);
+    XCTAssertEqual([[set popObjectsWithTime:30] count], 0);
+    // earlier time replaces
+    [set addObject:a time:50];
+    [set addObject:a time:40];
+    XCTAssertEqual([[set popObjectsWithTime:40] count], 1);
+    XCTAssertEqual([[set popObjectsWithTime:50] count], 0);
+    // stale timer should not take the new time
+    [set addObject:a time:70];
+    [set addObject:a time:60];
+    XCTAssertEqual([[set popObjectsWithTime:60] count], 1);
+    [set addObject:a time:80];
+    XCTAssertEqual([[set popObjectsWithTime:75] count], 0);
+    XCTAssertEqual([[set popObjectsWithTime:80] count], 1);
+}
+
+- (void)testUnmanaged {
+    STReadySet *set = [[STReadySet alloc] init];
+    NSObject *a = [[NSObject alloc] init];
+    [set addUnmanagedObject:a];
+    // every turn
+    XCTAssertEqualObjects([set popObjectsWithTime:1], @[a]);
+    XCTAssertEqualObjects([set popObjectsWithTime:2], @[a]);
+}
+
+- (void)testWeakTargets {
+    STReadySet *set = [[STReadySet alloc] init];
+    @autoreleasepool {
+        NSObject *a = [[NSObject alloc] init];
+        NSObject *b = [[NSObject alloc] init];
+        [set addObject:a time:10];
+        [set addUnmanagedObject:b];
+    }
+    // released, never popped
+    XCTAssertEqual([[set popObjectsWithTime:20] count], 0);
+}
+
+@end
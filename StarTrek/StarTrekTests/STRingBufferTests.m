@@ -0,0 +1,230 @@
+//
+//  STRingBufferTests.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <XCTest/XCTest.h>
+
+#import <StarTrek/StarTrek.h>
+
+static inline UInt8 pattern(NSUInteger index) {
+    return (UInt8)((index * 7 + 3) & 0xFF);
+}
+
+@interface STRingBufferTests : XCTestCase
+
+@end
+
+@implementation STRingBufferTests
+
+- (void)testCapacity {
+    XCTAssertEqual([[[STRingBuffer alloc] initWithCapacity:10] capacity], 64);
+    XCTAssertEqual([[[STRingBuffer alloc] initWithCapacity:64] capacity], 64);
+    XCTAssertEqual([[[STRingBuffer alloc] initWithCapacity:100] capacity], 128);
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertEqual(ring.maxPacketLength, 60);
+    XCTAssertEqual(ring.available, 0);
+    XCTAssertEqual(ring.space, 64);
+}
+
+- (void)testStreamFull {
+    UInt8 data[100];
+    UInt8 buffer[100];
+    for (NSUInteger i = 0; i < sizeof(data); ++i) {
+        data[i] = pattern(i);
+    }
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertEqual([ring writeBytes:data length:100], 64);
+    XCTAssertEqual(ring.space, 0);
+    XCTAssertEqual([ring writeBytes:data length:1], 0);
+    XCTAssertEqual([ring readBytes:buffer length:100], 64);
+    XCTAssertEqual(memcmp(buffer, data, 64), 0);
+    XCTAssertEqual([ring readBytes:buffer length:100], 0);
+    XCTAssertEqual(ring.space, 64);
+}
+
+- (void)testStreamWrapAround {
+    // chunk sizes prime to the capacity, so every offset gets crossed
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    UInt8 chunk[64];
+    NSUInteger written = 0;
+    NSUInteger read = 0;
+    NSUInteger total = 64 * 50;
+    NSUInteger sizes[] = {7, 13, 29, 41};
+    NSUInteger round = 0;
+    NSInteger count;
+    NSUInteger got, i;
+    while (read < total) {
+        NSUInteger len = MIN(sizes[round % 4], total - written);
+        for (i = 0; i < len; ++i) {
+            chunk[i] = pattern(written + i);
+        }
+        count = [ring writeBytes:chunk length:len];
+        XCTAssertGreaterThanOrEqual(count, 0);
+        written += count;
+        got = [ring readBytes:chunk length:sizes[(round + 1) % 4]];
+        for (i = 0; i < got; ++i) {
+            XCTAssertEqual(chunk[i], pattern(read + i), @"offset: %lu", read + i);
+        }
+        read += got;
+        XCTAssertEqual(ring.available, written - read);
+        XCTAssertEqual(ring.space, 64 - (written - read));
+        ++round;
+    }
+    XCTAssertEqual(written, total);
+}
+
+- (void)testPacketBoundaries {
+    UInt8 data[60];
+    UInt8 buffer[60];
+    for (NSUInteger i = 0; i < sizeof(data); ++i) {
+        data[i] = pattern(i);
+    }
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertEqual([ring nextPacketLength], 0);
+    XCTAssertEqual([ring popPacket:buffer length:60], -1);
+    // too long
+    XCTAssertFalse([ring pushPacket:data length:61]);
+    XCTAssertTrue([ring pushPacket:data length:60]);
+    XCTAssertEqual(ring.space, 0);
+    XCTAssertFalse([ring pushPacket:data length:0]);
+    XCTAssertEqual([ring nextPacketLength], 60);
+    XCTAssertEqual([ring popPacket:buffer length:60], 60);
+    XCTAssertEqual(memcmp(buffer, data, 60), 0);
+    // empty packet
+    XCTAssertTrue([ring pushPacket:data length:0]);
+    XCTAssertTrue([ring pushPacket:data length:3]);
+    XCTAssertEqual([ring popPacket:buffer length:60], 0);
+    XCTAssertEqual([ring popPacket:buffer length:60], 3);
+    XCTAssertEqual([ring popPacket:buffer length:60], -1);
+}
+
+- (void)testPacketTruncated {
+    UInt8 data[20];
+    UInt8 buffer[20];
+    for (NSUInteger i = 0; i < sizeof(data); ++i) {
+        data[i] = pattern(i);
+    }
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertTrue([ring pushPacket:data length:10]);
+    XCTAssertTrue([ring pushPacket:(data + 10) length:10]);
+    // the rest of the first packet is dropped
+    XCTAssertEqual([ring popPacket:buffer length:4], 4);
+    XCTAssertEqual(memcmp(buffer, data, 4), 0);
+    XCTAssertEqual([ring popPacket:buffer length:20], 10);
+    XCTAssertEqual(memcmp(buffer, data + 10, 10), 0);
+    XCTAssertEqual(ring.available, 0);
+}
+
+- (void)testPacketWrapAround {
+    UInt8 data[60];
+    UInt8 buffer[60];
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    NSUInteger offset = 0;  // write position in the ring
+    NSUInteger len, i;
+    for (NSUInteger n = 0; n < 500; ++n) {
+        // vary the length so the header and the body both get split
+        len = (n * 13) % 58 + 1;
+        for (i = 0; i < len; ++i) {
+            data[i] = pattern(n + i);
+        }
+        XCTAssertTrue([ring pushPacket:data length:len], @"packet: %lu", n);
+        XCTAssertEqual([ring nextPacketLength], len, @"packet: %lu, offset: %lu", n, offset);
+        XCTAssertEqual([ring popPacket:buffer length:sizeof(buffer)], len);
+        XCTAssertEqual(memcmp(buffer, data, len), 0, @"packet: %lu, offset: %lu", n, offset);
+        offset = (offset + 4 + len) % 64;
+    }
+}
+
+- (void)testHeaderSplit {
+    UInt8 data[58];
+    UInt8 buffer[58];
+    for (NSUInteger i = 0; i < sizeof(data); ++i) {
+        data[i] = pattern(i);
+    }
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    // 4 + 58 = 62, the next header takes bytes 62, 63, 0, 1
+    XCTAssertTrue([ring pushPacket:data length:58]);
+    XCTAssertEqual([ring popPacket:buffer length:58], 58);
+    XCTAssertTrue([ring pushPacket:data length:58]);
+    XCTAssertEqual([ring nextPacketLength], 58);
+    XCTAssertEqual([ring popPacket:buffer length:58], 58);
+    XCTAssertEqual(memcmp(buffer, data, 58), 0);
+}
+
+- (void)testClosed {
+    UInt8 data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    UInt8 buffer[8];
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertEqual([ring writeBytes:data length:8], 8);
+    [ring close];
+    XCTAssertTrue([ring isClosed]);
+    XCTAssertEqual([ring writeBytes:data length:8], -1);
+    XCTAssertFalse([ring pushPacket:data length:4]);
+    // written data still readable
+    XCTAssertEqual([ring readBytes:buffer length:8], 8);
+    XCTAssertEqual(memcmp(buffer, data, 8), 0);
+}
+
+- (void)testSignal {
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    XCTAssertTrue([ring signal]);
+    XCTAssertFalse([ring signal]);
+    [ring clearSignal];
+    XCTAssertTrue([ring signal]);
+}
+
+- (void)testProducerConsumer {
+    STRingBuffer *ring = [[STRingBuffer alloc] initWithCapacity:64];
+    NSUInteger total = 1 << 20;
+    dispatch_semaphore_t done = dispatch_semaphore_create(0);
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        UInt8 chunk[37];
+        NSUInteger written = 0;
+        NSUInteger len, i;
+        NSInteger count;
+        while (written < total) {
+            len = MIN(sizeof(chunk), total - written);
+            for (i = 0; i < len; ++i) {
+                chunk[i] = pattern(written + i);
+            }
+            count = 0;
+            while ((NSUInteger)count < len) {
+                // write the rest of the chunk when there is space
+                NSInteger n = [ring writeBytes:(chunk + count) length:(len - count)];
+                if (n <= 0) {
+                    sched_yield();
+                    continue;
+                }
+                count += n;
+            }
+            written += len;
+        }
+        dispatch_semaphore_signal(done);
+    });
+    UInt8 buffer[23];
+    NSUInteger read = 0;
+    NSUInteger errors = 0;
+    NSUInteger got, i;
+    while (read < total) {
+        got = [ring readBytes:buffer length:sizeof(buffer)];
+        if (got == 0) {
+            sched_yield();
+            continue;
+        }
+        for (i = 0; i < got; ++i) {
+            if (buffer[i] != pattern(read + i)) {
+                ++errors;
+            }
+        }
+        read += got;
+    }
+    dispatch_semaphore_wait(done, DISPATCH_TIME_FOREVER);
+    XCTAssertEqual(read, total);
+    XCTAssertEqual(errors, 0);
+    XCTAssertEqual(ring.available, 0);
+}
+
+@end
@@ -0,0 +1,45 @@
+//
+//  STTestDocker.h
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STTestShips.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Connection keeping written data in memory
+ */
+@interface STTestConnection : STConnection
+
+// copies of written data, one item per write
+@property(nonatomic, readonly) NSMutableArray<NSData *> *writes;
+
+// bytes accepted by one write, 0 means unlimited
+@property(nonatomic, assign) NSUInteger maxWrite;
+
+// writes fail with -1
+@property(nonatomic, assign, getter=isBroken) BOOL broken;
+
+- (instancetype)initWithRemoteAddress:(id<NIOSocketAddress>)remote;
+
+@end
+
+/**
+ *  Docker for test packages:
+ *      'A' + SN - response for the departure with SN,
+ *      'D' + SN - data package (complete)
+ */
+@interface STTestDocker : STDocker
+
+@property(nonatomic, readonly) STTestConnection *testConnection;
+
+- (instancetype)initWithTestConnection:(STTestConnection *)conn;
+
++ (NSData *)packageWithType:(char)type sn:(NSString *)sn;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,98 @@
+//
+//  STTestDocker.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STTestDocker.h"
+
+@implementation STTestConnection
+
+- (instancetype)initWithRemoteAddress:(id<NIOSocketAddress>)remote {
+    id<NIOSocketAddress> local = [NIOInetSocketAddress addressWithHost:@"127.0.0.1" port:9394];
+    if (self = [self initWithChannel:nil remoteAddress:remote localAddress:local]) {
+        _writes = [[NSMutableArray alloc] init];
+        _maxWrite = 0;
+        _broken = NO;
+    }
+    return self;
+}
+
+// Override
+- (BOOL)isOpen {
+    return YES;
+}
+
+// Override
+- (BOOL)isAlive {
+    return YES;
+}
+
+// Override
+- (NSInteger)sendData:(NSData *)data offset:(NSUInteger)offset {
+    if (_broken) {
+        return -1;
+    }
+    NSUInteger len = [data length] - offset;
+    if (_maxWrite > 0 && len > _maxWrite) {
+        len = _maxWrite;
+    }
+    [_writes addObject:[data subdataWithRange:NSMakeRange(offset, len)]];
+    return len;
+}
+
+@end
+
+@implementation STTestDocker
+
+- (instancetype)initWithTestConnection:(STTestConnection *)conn {
+    if (self = [self initWithConnection:conn]) {
+        _testConnection = conn;  // the docker keeps its connection weakly
+    }
+    return self;
+}
+
++ (NSData *)packageWithType:(char)type sn:(NSString *)sn {
+    NSMutableData *data = [[NSMutableData alloc] initWithBytes:&type length:1];
+    [data appendData:[sn dataUsingEncoding:NSUTF8StringEncoding]];
+    return data;
+}
+
+// Override
+- (id<STArrival>)arrivalWithData:(NSData *)data {
+    if ([data length] < 2) {
+        return nil;
+    }
+    const char *bytes = [data bytes];
+    NSData *body = [data subdataWithRange:NSMakeRange(1, [data length] - 1)];
+    NSString *sn = [[NSString alloc] initWithData:body encoding:NSUTF8StringEncoding];
+    STTestArrival *ship = [[STTestArrival alloc] initWithSN:sn page:-1];
+    ship.response = bytes[0] == 'A';
+    return ship;
+}
+
+// Override
+- (id<STArrival>)checkArrival:(id<STArrival>)income {
+    if ([(STTestArrival *)income isResponse]) {
+        [self checkResponseInArrival:income];
+        return nil;
+    }
+    // each data package is complete
+    return income;
+}
+
+// Override
+- (void)heartbeat {
+}
+
+// Override
+- (BOOL)sendData:(NSData *)payload {
+    STTestDeparture *ship = [[STTestDeparture alloc] initWithSN:[[NSUUID UUID] UUIDString]
+                                                      fragments:@[payload]
+                                                       priority:STDeparturePriorityNormal
+                                                      important:NO];
+    return [self sendShip:ship];
+}
+
+@end
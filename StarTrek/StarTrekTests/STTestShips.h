@@ -0,0 +1,44 @@
+//
+//  STTestShips.h
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import <StarTrek/StarTrek.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Departure carrying fragments in pages,
+ *  a page is removed when responded by an arrival with same SN
+ */
+@interface STTestDeparture : STDeparture
+
+- (instancetype)initWithSN:(NSString *)sn
+                 fragments:(NSArray<NSData *> *)fragments
+                  priority:(NSInteger)prior
+                 important:(BOOL)important;
+
++ (instancetype)departureWithSN:(NSString *)sn size:(NSUInteger)size priority:(NSInteger)prior;
+
+@end
+
+/**
+ *  Arrival responding one page of the departure with same SN,
+ *  or all pages of departures in 'respondedShipIDs'
+ */
+@interface STTestArrival : STArrival
+
+@property(nonatomic, readonly) NSInteger page;  // -1 for all pages
+
+// response for a departure, not a data package
+@property(nonatomic, assign, getter=isResponse) BOOL response;
+
+@property(nonatomic, strong, nullable) NSArray<id<STShipID>> *respondedShipIDs;
+
+- (instancetype)initWithSN:(NSString *)sn page:(NSInteger)page;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,105 @@
+//
+//  STTestShips.m
+//  StarTrekTests
+//
+//  Created by Albert Moky on 2026/10/18.
+//
+
+#import "STTestShips.h"
+
+@interface STTestDeparture () {
+    
+    NSString *_sn;
+    BOOL _important;
+    NSMutableArray<NSData *> *_pages;  // remaining fragments
+    NSArray<NSData *> *_all;           // all fragments
+}
+
+@end
+
+@implementation STTestDeparture
+
+- (instancetype)initWithSN:(NSString *)sn
+                 fragments:(NSArray<NSData *> *)fragments
+                  priority:(NSInteger)prior
+                 important:(BOOL)important {
+    if (self = [super initWithPriority:prior maxTries:3]) {
+        _sn = [sn copy];
+        _important = important;
+        _all = [fragments copy];
+        _pages = [fragments mutableCopy];
+    }
+    return self;
+}
+
++ (instancetype)departureWithSN:(NSString *)sn size:(NSUInteger)size priority:(NSInteger)prior {
+    NSData *data = [NSMutableData dataWithLength:size];
+    return [[self alloc] initWithSN:sn fragments:@[data] priority:prior important:YES];
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (BOOL)isImportant {
+    return _important;
+}
+
+// Override
+- (NSArray<NSData *> *)fragments {
+    return [_pages copy];
+}
+
+// Override
+- (BOOL)checkResponseWithinArrivalShip:(id<STArrival>)response {
+    if (![response isKindOfClass:[STTestArrival class]]) {
+        return NO;
+    }
+    STTestArrival *ack = (STTestArrival *)response;
+    BOOL matched = [_sn isEqual:[ack sn]];
+    if (!matched) {
+        matched = [ack.respondedShipIDs containsObject:_sn];
+        if (!matched) {
+            return NO;
+        }
+        [_pages removeAllObjects];
+    } else if (ack.page < 0) {
+        [_pages removeAllObjects];
+    } else if (ack.page < [_all count]) {
+        [_pages removeObjectIdenticalTo:[_all objectAtIndex:ack.page]];
+    }
+    return [_pages count] == 0;
+}
+
+@end
+
+@interface STTestArrival () {
+    
+    NSString *_sn;
+}
+
+@end
+
+@implementation STTestArrival
+
+- (instancetype)initWithSN:(NSString *)sn page:(NSInteger)page {
+    if (self = [super initWithTime:[[NSDate date] timeIntervalSince1970]]) {
+        _sn = [sn copy];
+        _page = page;
+    }
+    return self;
+}
+
+// Override
+- (id<STShipID>)sn {
+    return _sn;
+}
+
+// Override
+- (nullable id<STArrival>)assembleArrivalShip:(id<STArrival>)income {
+    return income;
+}
+
+@end